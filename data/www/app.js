@@ -139,20 +139,21 @@ const legendCtx     = legendCanvas.getContext('2d');
 
 let currentResolution = 24;
 
-function renderHeatmap(pixels8x8, scaleMin, scaleMax, hotspotX, hotspotY) {
+function renderHeatmap(pixels, scaleMin, scaleMax, hotspotX, hotspotY) {
   const res = currentResolution;
+  const resY = Math.round(res * gridH / gridW);
   const interpFn = INTERP_FN[document.getElementById('ctrl-interp').value] || interpBilinear;
-  const grid = interpFn(pixels8x8, 8, 8, res, res);
+  const grid = interpFn(pixels, gridW, gridH, res, resY);
 
   heatmapCanvas.width  = res;
-  heatmapCanvas.height = res;
+  heatmapCanvas.height = resY;
 
-  const imgData = heatmapCtx.createImageData(res, res);
+  const imgData = heatmapCtx.createImageData(res, resY);
   const d = imgData.data;
   const range = scaleMax - scaleMin;
   const invRange = range > 0.01 ? 1.0 / range : 1.0;
 
-  for (let i = 0; i < res * res; i++) {
+  for (let i = 0; i < res * resY; i++) {
     const norm = Math.max(0, Math.min(1, (grid[i] - scaleMin) * invRange));
     const idx = Math.round(norm * 255);
     const c = IRONBOW[idx];
@@ -166,7 +167,7 @@ function renderHeatmap(pixels8x8, scaleMin, scaleMax, hotspotX, hotspotY) {
 
   // Hotspot marker
   if (document.getElementById('ctrl-hotspot').checked) {
-    const sx = res / 8;
+    const sx = res / gridW;
     const cx = (hotspotX + 0.5) * sx;
     const cy = (hotspotY + 0.5) * sx;
     const r  = sx * 0.4;
@@ -254,8 +255,18 @@ function wsConnect() {
     banner.textContent = 'Connected';
     banner.className = 'banner connected';
     clearTimeout(reconnectTimer);
-    // Load current config from server
+    // Ask for the compact v2 stream (int16 quantization)
+    v2Reset();
+    wireFormat = FORMAT_V1;
+    ws.send(new Uint8Array([MSG_HELLO, FORMAT_V2, QUANT_I16]));
+    // Dashboards can subscribe to less, e.g. ?channel=stats&every=10;
+    // alarm events are pushed on every channel
+    const sub = subscription();
+    ws.send(new Uint8Array([MSG_SUBSCRIBE, sub.channel, sub.every, SUB_EVENTS]));
+    // Load current config and alarm state from server
     loadConfig();
+    loadAlarms();
+    pingStart();
   };
 
   ws.onmessage = function(evt) {
@@ -264,6 +275,8 @@ function wsConnect() {
   };
 
   ws.onclose = function() {
+    ctrlInFlight = {};
+    pingStop();
     banner.textContent = 'Disconnected';
     banner.className = 'banner disconnected';
     scheduleReconnect();
@@ -292,14 +305,145 @@ function scheduleReconnect() {
 // 18      4     tmean          (float32)
 // 22      1     hotspot_x      (uint8)
 // 23      1     hotspot_y      (uint8)
-// 24      256   pixels[64]     (float32 x 64)
-// Total: 280 bytes
+// 24      4*N   pixels[N]      (float32 x N, N = grid.w * grid.h)
+// Total: 280 bytes for the 8x8 AMG8833
 
-const PAYLOAD_SIZE = 280;
+// Sensor grid, reported by GET /api/config as grid.w / grid.h
+let gridW = 8, gridH = 8, gridPixels = 64;
+
+function setGrid(w, h) {
+  if (!w || !h || (w === gridW && h === gridH)) return;
+  gridW = w; gridH = h; gridPixels = w * h;
+  v2Q = new Int32Array(gridPixels);
+  v2Reset();
+}
+
+function payloadSize() { return 24 + 4 * gridPixels; }
+
+// Client -> device message types / wire formats (see ws_protocol.h)
+const MSG_HELLO      = 0x01;
+const MSG_SUBSCRIBE  = 0x02;
+const FORMAT_V1      = 1;
+const FORMAT_V2      = 2;
+const PKT_STATS      = 3;
+const PKT_BATCH      = 4;
+const QUANT_I16      = 0;
+const QUANT_I8       = 1;
+const CHANNEL_FRAMES = 0;
+const CHANNEL_STATS  = 1;
+const CHANNEL_BATCH  = 2;
+const CHANNEL_EVENTS = 3;
+const PKT_EVENT      = 5;
+const SUB_EVENTS     = 0x01;
+const MSG_SET_PARAM  = 0x03;
+const MSG_GET_STATUS = 0x04;
+const PKT_ACK        = 6;
+const PKT_STATUS     = 7;
+const ACK_CLAMPED    = 1;
+const MSG_PING       = 0x05;
+const MSG_ECHO       = 0x06;
+const PKT_PONG       = 8;
+
+// WS_PARAM_* (ws_protocol.h)
+const PARAM = {
+  normal_fps: 0, idle_fps: 1, idle_timeout_sec: 2, temporal_enabled: 3, alpha: 4,
+  filter_mode: 5, adaptive_threshold: 6, calibration_offset: 7,
+};
+
+function subscription() {
+  const params = new URLSearchParams(window.location.search);
+  const every = parseInt(params.get('every') || '1', 10);
+  const channels = { stats: CHANNEL_STATS, batch: CHANNEL_BATCH, events: CHANNEL_EVENTS };
+  return {
+    channel: channels[params.get('channel')] || CHANNEL_FRAMES,
+    every: Math.min(Math.max(isNaN(every) ? 1 : every, 1), 255),
+  };
+}
+
+// What the device is sending this socket: v1 until it handles our hello,
+// after which the v2 stream opens with a keyframe
+let wireFormat = FORMAT_V1;
 
 function parseFrame(buf) {
-  if (buf.byteLength !== PAYLOAD_SIZE) return;
+  // Only a v1 stream is told apart by length (v1 frames are exactly
+  // payloadSize() bytes); once v2 starts every message goes by byte 0
+  if (wireFormat === FORMAT_V1 && buf.byteLength === payloadSize()) parseFrameV1(buf);
+  else if (new DataView(buf).getUint8(0) === PKT_STATS) parseStats(buf);
+  else if (new DataView(buf).getUint8(0) === PKT_BATCH) parseBatch(buf);
+  else if (new DataView(buf).getUint8(0) === PKT_EVENT) parseEvent(buf);
+  else if (new DataView(buf).getUint8(0) === PKT_ACK) parseAck(buf);
+  else if (new DataView(buf).getUint8(0) === PKT_STATUS) parseStatus(buf);
+  else if (new DataView(buf).getUint8(0) === PKT_PONG) parsePong(buf);
+  else parseFrameV2(buf);
+}
 
+// Stats-only packet (17 bytes): 0 type, 1 flags, 2 seq (u16),
+// 4 timestamp_ms (u32), 8 fps, 9 tmin, 11 tmax, 13 tmean (int16 centi-degrees),
+// 15 hotspot_x, 16 hotspot_y; followed by the ROI trailer if ROIs are set
+const STATS_PACKET_SIZE = 17;
+
+function parseStats(buf) {
+  if (buf.byteLength < STATS_PACKET_SIZE) return;
+  const dv = new DataView(buf);
+  showStats(dv.getUint8(8), dv.getUint8(1),
+            dv.getInt16(9, true) / 100, dv.getInt16(11, true) / 100,
+            dv.getInt16(13, true) / 100, dv.getUint8(15), dv.getUint8(16));
+  showRois(parseRois(dv, STATS_PACKET_SIZE));
+}
+
+// ROI trailer: [u8 count] then count x 12 bytes:
+// 0 tmin, 2 tmax, 4 tmean (int16 centi-degrees), 6 pixels, 7 above (u8),
+// 8 cx, 10 cy (u16, pixel units * 256)
+const V2_EXT_ROI = 0x01;
+const ROI_SIZE   = 12;
+
+let roiNames = [];
+
+function parseRois(dv, off) {
+  if (off >= dv.byteLength) return [];
+  const count = dv.getUint8(off);
+  if (dv.byteLength < off + 1 + count * ROI_SIZE) return [];
+  const rois = [];
+  for (let r = 0, p = off + 1; r < count; r++, p += ROI_SIZE) {
+    rois.push({
+      tmin:   dv.getInt16(p, true) / 100,
+      tmax:   dv.getInt16(p + 2, true) / 100,
+      tmean:  dv.getInt16(p + 4, true) / 100,
+      pixels: dv.getUint8(p + 6),
+      above:  dv.getUint8(p + 7),
+      cx:     dv.getUint16(p + 8, true) / 256,
+      cy:     dv.getUint16(p + 10, true) / 256,
+    });
+  }
+  return rois;
+}
+
+function showRois(rois) {
+  const card = document.getElementById('roi-card');
+  card.style.display = rois.length ? '' : 'none';
+  if (!rois.length) return;
+  const list = document.getElementById('roi-list');
+  list.textContent = '';
+  rois.forEach(function(r, i) {
+    if (!r.pixels) return;    // empty slot; indices still match roiNames
+    const el = document.createElement('div');
+    el.className = 'stat';
+    const label = document.createElement('span');
+    label.className = 'stat-label';
+    label.textContent = roiNames[i] || ('ROI ' + i);
+    const value = document.createElement('span');
+    value.className = 'stat-value';
+    value.textContent = r.tmax.toFixed(1) + '\u00b0C';
+    value.title = 'min ' + r.tmin.toFixed(1) + ' / mean ' + r.tmean.toFixed(1) +
+                  ', ' + r.above + '/' + r.pixels + ' px above threshold' +
+                  ', centroid (' + r.cx.toFixed(2) + ',' + r.cy.toFixed(2) + ')';
+    el.appendChild(label);
+    el.appendChild(value);
+    list.appendChild(el);
+  });
+}
+
+function parseFrameV1(buf) {
   const dv = new DataView(buf);
   let off = 0;
 
@@ -313,13 +457,161 @@ function parseFrame(buf) {
   const hotX      = dv.getUint8(off);           off += 1;
   const hotY      = dv.getUint8(off);           off += 1;
 
-  const pixels = new Float32Array(64);
-  for (let i = 0; i < 64; i++) {
+  const pixels = new Float32Array(gridPixels);
+  for (let i = 0; i < gridPixels; i++) {
     pixels[i] = dv.getFloat32(off, true);
     off += 4;
   }
 
-  const temporalOn = !!(flags & 0x01);
+  showFrame(fps, flags, tmin, tmax, tmean, hotX, hotY, pixels);
+}
+
+// Alarm event (16 bytes): 0 type, 1 kind (1 raise / 0 clear), 2 rule,
+// 3 active rules (bit mask), 4 id (u16), 6 timestamp_ms (u32),
+// 10 value, 12 threshold (int16 centi-degrees or centi-°C/s), 14 x, 15 y
+const EVENT_PACKET_SIZE = 16;
+
+let alarmNames = [];
+
+function parseEvent(buf) {
+  if (buf.byteLength < EVENT_PACKET_SIZE) return;
+  const dv = new DataView(buf);
+  const rule = dv.getUint8(2);
+  const name = alarmNames[rule] || ('alarm ' + rule);
+  if (dv.getUint8(1) === 1) {
+    showAlarm(dv.getUint8(3), name + ' ' + (dv.getInt16(10, true) / 100).toFixed(1) +
+              ' at (' + dv.getUint8(14) + ',' + dv.getUint8(15) + ')');
+  } else {
+    showAlarm(dv.getUint8(3), null);
+  }
+}
+
+// Keeps the latest raise as the banner text while any rule is raised
+function showAlarm(activeMask, text) {
+  const banner = document.getElementById('alarm-banner');
+  if (text) banner.textContent = 'ALARM: ' + text;
+  if (!activeMask) banner.textContent = '';
+  else if (!banner.textContent) banner.textContent = 'ALARM';
+  banner.style.display = activeMask ? '' : 'none';
+}
+
+function loadAlarms() {
+  fetch('/api/alarms')
+    .then(function(r) { return r.json(); })
+    .then(function(st) {
+      alarmNames = st.rules.map(function(r) { return r.name; });
+      const raised = st.rules.filter(function(r) { return r.active; });
+      showAlarm(st.active, raised.length ? raised.map(function(r) { return r.name; }).join(', ') : null);
+    })
+    .catch(function(err) { console.error('Alarm load failed:', err); });
+}
+
+// Batch (8-byte header + count x (16 + 2N)-byte records, oldest first):
+// header 0 type, 1 count, 2 first_seq (u16), 4 sent_ms (u32)
+// record 0 timestamp_ms (u32), 4 seq (u16), 6 fps, 7 flags,
+// 8 tmin, 10 tmax, 12 tmean (int16 centi-degrees), 14 hotspot_x, 15 hotspot_y,
+// 16 pixels[N] (int16 centi-degrees)
+const BATCH_HEADER_SIZE = 8;
+function parseBatch(buf) {
+  const dv = new DataView(buf);
+  const count = dv.getUint8(1);
+  const recordSize = 16 + 2 * gridPixels;
+  if (count === 0 || buf.byteLength < BATCH_HEADER_SIZE + count * recordSize) return;
+
+  // Live view only needs the newest record
+  const off = BATCH_HEADER_SIZE + (count - 1) * recordSize;
+  const pixels = new Float32Array(gridPixels);
+  for (let i = 0; i < gridPixels; i++) {
+    pixels[i] = dv.getInt16(off + 16 + i * 2, true) / 100;
+  }
+  showFrame(dv.getUint8(off + 6), dv.getUint8(off + 7),
+            dv.getInt16(off + 8, true) / 100, dv.getInt16(off + 10, true) / 100,
+            dv.getInt16(off + 12, true) / 100, dv.getUint8(off + 14), dv.getUint8(off + 15),
+            pixels);
+}
+
+// v2 layout (packed, little-endian): 25-byte header
+// 0 version, 1 kind (0 key / 1 delta), 2 quant (0 int16 / 1 int8), 3 ext,
+// 4 seq (u16), 6 timestamp_ms (u32), 10 fps, 11 flags,
+// 12 calibration_offset, 14 tmin, 16 tmax, 18 tmean (int16 centi-degrees),
+// 20 hotspot_x, 21 hotspot_y, 22 base (int16 centi-degrees), 24 step (u8)
+// then N pixels: keyframe = raw uint16/uint8 q, delta = zigzag varints,
+// then the ROI trailer if ext & V2_EXT_ROI,
+// then the timing trailer if ext & V2_EXT_TIMING.
+// temperature = (base + q * step) / 100
+const V2_HEADER_SIZE = 25;
+
+let v2Q = new Int32Array(gridPixels);
+let v2Seq = -1;
+
+function v2Reset() {
+  v2Seq = -1;
+}
+
+function parseFrameV2(buf) {
+  if (buf.byteLength < V2_HEADER_SIZE) return;
+  const dv = new DataView(buf);
+  const bytes = new Uint8Array(buf);
+  if (dv.getUint8(0) !== FORMAT_V2) return;
+
+  const kind  = dv.getUint8(1);
+  if (kind === 0) wireFormat = FORMAT_V2;
+  const quant = dv.getUint8(2);
+  const ext   = dv.getUint8(3);
+  const seq   = dv.getUint16(4, true);
+  const fps   = dv.getUint8(10);
+  const flags = dv.getUint8(11);
+  const tmin  = dv.getInt16(14, true) / 100;
+  const tmax  = dv.getInt16(16, true) / 100;
+  const tmean = dv.getInt16(18, true) / 100;
+  const hotX  = dv.getUint8(20);
+  const hotY  = dv.getUint8(21);
+  const base  = dv.getInt16(22, true);
+  const step  = dv.getUint8(24);
+
+  let off = V2_HEADER_SIZE;
+  if (kind === 0) {
+    for (let i = 0; i < gridPixels; i++) {
+      if (quant === QUANT_I8) { v2Q[i] = bytes[off]; off += 1; }
+      else { v2Q[i] = dv.getUint16(off, true); off += 2; }
+    }
+  } else {
+    // Delta: only valid directly after the frame we last decoded
+    if (v2Seq < 0 || seq !== ((v2Seq + 1) & 0xFFFF)) { v2Seq = -1; return; }
+    for (let i = 0; i < gridPixels; i++) {
+      let v = 0, shift = 0, b;
+      do {
+        b = bytes[off++];
+        v |= (b & 0x7F) << shift;
+        shift += 7;
+      } while (b & 0x80);
+      v2Q[i] += (v >>> 1) ^ -(v & 1);
+    }
+  }
+  v2Seq = seq;
+
+  const pixels = new Float32Array(gridPixels);
+  for (let i = 0; i < gridPixels; i++) {
+    pixels[i] = (base + v2Q[i] * step) / 100;
+  }
+
+  showFrame(fps, flags, tmin, tmax, tmean, hotX, hotY, pixels);
+  const rois = (ext & V2_EXT_ROI) ? parseRois(dv, off) : [];
+  showRois(rois);
+  if (ext & V2_EXT_ROI) off += 1 + rois.length * ROI_SIZE;
+  if (ext & V2_EXT_TIMING) parseTiming(dv, off);
+}
+
+function showFrame(fps, flags, tmin, tmax, tmean, hotX, hotY, pixels) {
+  showStats(fps, flags, tmin, tmax, tmean, hotX, hotY);
+
+  // Update scale and render
+  updateScale(tmin, tmax);
+  renderHeatmap(pixels, scaleMin, scaleMax, hotX, hotY);
+  renderLegend(scaleMin, scaleMax);
+}
+
+function showStats(fps, flags, tmin, tmax, tmean, hotX, hotY) {
   const idleActive = !!(flags & 0x02);
 
   // Update stats display
@@ -329,31 +621,203 @@ function parseFrame(buf) {
   document.getElementById('stat-hotspot').textContent = '(' + hotX + ',' + hotY + ')';
   document.getElementById('stat-fps').textContent = fps;
   document.getElementById('stat-status').textContent = idleActive ? 'Idle' : 'Active';
+}
 
-  // Update scale and render
-  updateScale(tmin, tmax);
-  renderHeatmap(pixels, scaleMin, scaleMax, hotX, hotY);
-  renderLegend(scaleMin, scaleMax);
+// ── Link telemetry ──────────────────────────────────
+
+// Timing trailer (12 bytes): 0 frame_seq (u32), 4 capture_ms (u32, device
+// clock), 8 process_us, 10 enqueue_us (u16, after capture)
+const V2_EXT_TIMING  = 0x02;
+const TIMING_SIZE    = 12;
+const PING_INTERVAL  = 2000;
+
+// Every PING_INTERVAL the page pings with performance.now(); the device
+// answers with its clock and the page echoes the pong back at once, so the
+// device measures the round trip itself. The page's own estimate of the
+// clock offset (from the smallest round trip seen) turns capture_ms into
+// capture-to-display latency.
+let link = null;
+let pingTimer = null;
+
+function linkReset() {
+  // With ?every=N only every Nth frame_seq is due for this page
+  link = { pingId: 0, rttMin: Infinity, offset: null, nextSeq: -1,
+           every: subscription().every, frames: 0, lost: 0, latency: 0 };
+}
+
+function pingStart() {
+  linkReset();
+  clearInterval(pingTimer);
+  sendPing();
+  pingTimer = setInterval(sendPing, PING_INTERVAL);
+}
+
+function pingStop() {
+  clearInterval(pingTimer);
+  pingTimer = null;
+}
+
+function sendPing() {
+  if (!wsOpen()) return;
+  link.pingId = (link.pingId + 1) & 0xFFFF;
+  const buf = new ArrayBuffer(12);
+  const dv = new DataView(buf);
+  dv.setUint8(0, MSG_PING);
+  dv.setUint16(2, link.pingId, true);
+  dv.setFloat64(4, performance.now(), true);
+  ws.send(buf);
+}
+
+// Pong (28 bytes): 0 type, 2 id (u16), 4 client_ms (float64, ours),
+// 12 device_ms, 16 device_us (u32), 20 offset_ms (i32, device estimate),
+// 24 rtt_us (u32, device measured)
+function parsePong(buf) {
+  if (buf.byteLength < 28 || !link) return;
+  const now = performance.now();
+  const dv = new DataView(buf);
+  const deviceMs = dv.getUint32(12, true);
+
+  // Echo first, so the device's round trip excludes our bookkeeping
+  const out = new ArrayBuffer(32);
+  const o = new DataView(out);
+  o.setUint8(0, MSG_ECHO);
+  o.setUint16(2, dv.getUint16(2, true), true);
+  o.setUint32(4, deviceMs, true);
+  o.setUint32(8, dv.getUint32(16, true), true);
+  o.setFloat64(12, now, true);
+  o.setUint32(20, link.frames >>> 0, true);
+  o.setUint32(24, link.lost >>> 0, true);
+  o.setUint16(28, Math.min(Math.max(Math.round(link.latency), 0), 0xFFFF), true);
+  ws.send(out);
+
+  const rtt = now - dv.getFloat64(4, true);
+  if (rtt <= link.rttMin + 2) {
+    link.rttMin = Math.min(link.rttMin, rtt);
+    link.offset = now - (deviceMs + rtt / 2);
+  }
+  document.getElementById('link-card').style.display = '';
+  document.getElementById('link-rtt').textContent = rtt.toFixed(1) + ' ms';
+  document.getElementById('link-offset').textContent =
+    link.offset === null ? '--' : (link.offset / 1000).toFixed(3) + ' s';
+}
+
+function parseTiming(dv, off) {
+  if (dv.byteLength < off + TIMING_SIZE || !link) return;
+  const seq = dv.getUint32(off, true);
+  if (link.nextSeq >= 0 && seq > link.nextSeq) {
+    link.lost += Math.round((seq - link.nextSeq) / link.every);
+  }
+  link.nextSeq = seq + link.every;
+  link.frames++;
+
+  const processUs = dv.getUint16(off + 8, true);
+  const enqueueUs = dv.getUint16(off + 10, true);
+  if (link.offset !== null) {
+    link.latency = performance.now() - link.offset - dv.getUint32(off + 4, true);
+    document.getElementById('link-latency').textContent = link.latency.toFixed(0) + ' ms';
+  }
+  document.getElementById('link-stages').textContent =
+    (processUs / 1000).toFixed(1) + ' / ' + (Math.max(enqueueUs - processUs, 0) / 1000).toFixed(1) + ' ms';
+  document.getElementById('link-lost').textContent = link.lost;
+}
+
+// ── WebSocket control ───────────────────────────────
+
+// Settings go over the open WebSocket as 8-byte set-param messages
+// (seq u16, value float32) and are acked with the value in effect. While a
+// parameter has a message in flight, newer values only replace the pending
+// one, so a slider drag never queues more than one message per parameter.
+let ctrlSeq = 0;
+let ctrlInFlight = {};   // param -> { seq, pending }
+
+function wsOpen() {
+  return ws && ws.readyState === WebSocket.OPEN;
+}
+
+function ctrlTransmit(param, value) {
+  ctrlSeq = (ctrlSeq + 1) & 0xFFFF;
+  ctrlInFlight[param] = { seq: ctrlSeq, pending: null };
+  const buf = new ArrayBuffer(8);
+  const dv = new DataView(buf);
+  dv.setUint8(0, MSG_SET_PARAM);
+  dv.setUint8(1, param);
+  dv.setUint16(2, ctrlSeq, true);
+  dv.setFloat32(4, value, true);
+  ws.send(buf);
+}
+
+// Falls back to POST /api/config when the WebSocket is down
+function setParam(name, value) {
+  if (!wsOpen()) { const o = {}; o[name] = value; sendConfig(o); return; }
+  const param = PARAM[name];
+  const f = ctrlInFlight[param];
+  if (f) f.pending = +value;
+  else ctrlTransmit(param, +value);
+}
+
+function requestStatus() {
+  ctrlSeq = (ctrlSeq + 1) & 0xFFFF;
+  ws.send(new Uint8Array([MSG_GET_STATUS, 0, ctrlSeq & 0xFF, ctrlSeq >> 8]));
+}
+
+// Ack (9 bytes): 0 type, 1 status, 2 seq (u16), 4 param, 5 value (float32)
+function parseAck(buf) {
+  if (buf.byteLength < 9) return;
+  const dv = new DataView(buf);
+  const param = dv.getUint8(4);
+  const f = ctrlInFlight[param];
+  if (!f || f.seq !== dv.getUint16(2, true)) return;
+  delete ctrlInFlight[param];
+  if (f.pending !== null) ctrlTransmit(param, f.pending);
+  else if (dv.getUint8(1) === ACK_CLAMPED) requestStatus();
+}
+
+// Status (30 bytes): 0 type, 1 flags, 2 seq, 4 config generation (u32),
+// 8 normal_fps, 9 idle_fps, 10 current_fps, 11 clients,
+// 12 idle_timeout_sec (u16), 14 filter_mode, 15 batch_frames,
+// 16 alpha, 20 adaptive_threshold, 24 calibration_offset (float32),
+// 28 batch_max_ms (u16)
+function parseStatus(buf) {
+  if (buf.byteLength < 30) return;
+  const dv = new DataView(buf);
+  showControls({
+    normal_fps:         dv.getUint8(8),
+    idle_timeout_sec:   dv.getUint16(12, true),
+    temporal_enabled:   !!(dv.getUint8(1) & 0x01),
+    filter_mode:        dv.getUint8(14),
+    alpha:              dv.getFloat32(16, true),
+    adaptive_threshold: dv.getFloat32(20, true),
+    calibration_offset: dv.getFloat32(24, true),
+  });
 }
 
 // ── Config API ──────────────────────────────────────
 
+function showControls(cfg) {
+  document.getElementById('ctrl-fps').value         = cfg.normal_fps;
+  document.getElementById('ctrl-idle-timeout').value = cfg.idle_timeout_sec;
+  document.getElementById('ctrl-offset').value       = cfg.calibration_offset;
+  document.getElementById('val-offset').textContent  = cfg.calibration_offset.toFixed(1);
+  document.getElementById('ctrl-temporal').checked   = cfg.temporal_enabled;
+  document.getElementById('ctrl-alpha').value        = cfg.alpha;
+  document.getElementById('val-alpha').textContent   = cfg.alpha.toFixed(2);
+  document.getElementById('ctrl-filter-mode').value  = cfg.filter_mode;
+  document.getElementById('ctrl-threshold').value    = cfg.adaptive_threshold;
+  document.getElementById('val-threshold').textContent = cfg.adaptive_threshold.toFixed(2);
+  toggleAlphaRow();
+}
+
 function loadConfig() {
   fetch('/api/config')
     .then(function(r) { return r.json(); })
     .then(function(cfg) {
-      document.getElementById('ctrl-fps').value         = cfg.normal_fps;
-      document.getElementById('ctrl-idle-timeout').value = cfg.idle_timeout_sec;
-      document.getElementById('ctrl-offset').value       = cfg.calibration_offset;
-      document.getElementById('val-offset').textContent  = cfg.calibration_offset.toFixed(1);
-      document.getElementById('ctrl-temporal').checked   = cfg.temporal_enabled;
-      document.getElementById('ctrl-alpha').value        = cfg.alpha;
-      document.getElementById('val-alpha').textContent   = cfg.alpha.toFixed(2);
+      if (cfg.grid) setGrid(cfg.grid.w, cfg.grid.h);
+      showControls(cfg);
       document.getElementById('ctrl-sta-enabled').checked = cfg.sta_enabled;
+      roiNames = (cfg.rois || []).map(function(r) { return r.name; });
       document.getElementById('ctrl-sta-ssid').value     = cfg.sta_ssid || '';
       document.getElementById('sta-ip').textContent      = cfg.sta_ip || '--';
 
-      toggleAlphaRow();
       toggleStaFields();
     })
     .catch(function(e) {
@@ -400,37 +864,55 @@ document.getElementById('ctrl-smoothing').addEventListener('input', function() {
   document.getElementById('val-smoothing').textContent = parseFloat(this.value).toFixed(2);
 });
 
-// Sensor controls (send to ESP)
+// Sensor controls (send to ESP); sliders apply while they are dragged
 document.getElementById('ctrl-fps').addEventListener('change', function() {
-  sendConfig({ normal_fps: parseInt(this.value) });
+  setParam('normal_fps', parseInt(this.value));
 });
 
 document.getElementById('ctrl-idle-timeout').addEventListener('change', function() {
-  sendConfig({ idle_timeout_sec: parseInt(this.value) });
+  setParam('idle_timeout_sec', parseInt(this.value));
 });
 
 document.getElementById('ctrl-offset').addEventListener('input', function() {
   document.getElementById('val-offset').textContent = parseFloat(this.value).toFixed(1);
+  if (wsOpen()) setParam('calibration_offset', parseFloat(this.value));
 });
 document.getElementById('ctrl-offset').addEventListener('change', function() {
-  sendConfig({ calibration_offset: parseFloat(this.value) });
+  setParam('calibration_offset', parseFloat(this.value));
 });
 
 document.getElementById('ctrl-temporal').addEventListener('change', function() {
-  sendConfig({ temporal_enabled: this.checked });
+  setParam('temporal_enabled', this.checked ? 1 : 0);
   toggleAlphaRow();
 });
 
 function toggleAlphaRow() {
-  document.getElementById('row-alpha').style.display =
-    document.getElementById('ctrl-temporal').checked ? '' : 'none';
+  const on = document.getElementById('ctrl-temporal').checked;
+  const adaptive = document.getElementById('ctrl-filter-mode').value === '1';
+  document.getElementById('row-alpha').style.display       = on ? '' : 'none';
+  document.getElementById('row-filter-mode').style.display = on ? '' : 'none';
+  document.getElementById('row-threshold').style.display   = on && adaptive ? '' : 'none';
 }
 
+document.getElementById('ctrl-filter-mode').addEventListener('change', function() {
+  setParam('filter_mode', parseInt(this.value));
+  toggleAlphaRow();
+});
+
+document.getElementById('ctrl-threshold').addEventListener('input', function() {
+  document.getElementById('val-threshold').textContent = parseFloat(this.value).toFixed(2);
+  if (wsOpen()) setParam('adaptive_threshold', parseFloat(this.value));
+});
+document.getElementById('ctrl-threshold').addEventListener('change', function() {
+  setParam('adaptive_threshold', parseFloat(this.value));
+});
+
 document.getElementById('ctrl-alpha').addEventListener('input', function() {
   document.getElementById('val-alpha').textContent = parseFloat(this.value).toFixed(2);
+  if (wsOpen()) setParam('alpha', parseFloat(this.value));
 });
 document.getElementById('ctrl-alpha').addEventListener('change', function() {
-  sendConfig({ alpha: parseFloat(this.value) });
+  setParam('alpha', parseFloat(this.value));
 });
 
 // WiFi STA
@@ -0,0 +1,37 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Minimal Arduino shim for the native (host) build. Only what the
+// processing modules use: fixed-width ints, string/math, time and Serial.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+static inline uint32_t micros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000ull + ts.tv_nsec / 1000);
+}
+
+static inline uint32_t millis() {
+    return micros() / 1000;
+}
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+struct HostSerial {
+    void begin(unsigned long) {}
+    template <typename... Args>
+    int printf(const char* fmt, Args... args) { return ::printf(fmt, args...); }
+    void print(const char* s)   { fputs(s, stdout); }
+    void println(const char* s) { puts(s); }
+};
+
+inline HostSerial Serial;
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+// Filesystem stand-in for the native build: the subset of the ESP8266
+// LittleFS / File / Dir API the firmware uses, backed by stdio under a
+// host directory ($HOST_FS_ROOT, default /tmp/host_littlefs).
+
+#include <Arduino.h>
+#include <string>
+#include <dirent.h>
+#include <sys/stat.h>
+
+enum SeekMode { SeekSet = SEEK_SET, SeekCur = SEEK_CUR, SeekEnd = SEEK_END };
+
+class File {
+public:
+    File() : f(nullptr) {}
+    explicit File(FILE* fp) : f(fp) {}
+
+    explicit operator bool() const { return f != nullptr; }
+
+    size_t write(const uint8_t* buf, size_t len) { return f ? fwrite(buf, 1, len, f) : 0; }
+    size_t read(uint8_t* buf, size_t len)        { return f ? fread(buf, 1, len, f) : 0; }
+    bool   seek(uint32_t pos, SeekMode mode = SeekSet) { return f && fseek(f, pos, mode) == 0; }
+    size_t position() const { return f ? (size_t)ftell(f) : 0; }
+    void   flush()          { if (f) fflush(f); }
+
+    size_t size() const {
+        if (!f) return 0;
+        long cur = ftell(f);
+        fseek(f, 0, SEEK_END);
+        long end = ftell(f);
+        fseek(f, cur, SEEK_SET);
+        return (size_t)end;
+    }
+
+    void close() {
+        if (f) fclose(f);
+        f = nullptr;
+    }
+
+private:
+    FILE* f;
+};
+
+class Dir {
+public:
+    Dir() : d(nullptr) {}
+    Dir(DIR* dp, const std::string& p) : d(dp), path(p) {}
+
+    bool next() {
+        if (!d) return false;
+        while (struct dirent* e = readdir(d)) {
+            if (e->d_name[0] == '.') continue;
+            name = e->d_name;
+            return true;
+        }
+        closedir(d);
+        d = nullptr;
+        return false;
+    }
+
+    std::string fileName() const { return name; }
+
+    size_t fileSize() const {
+        struct stat st;
+        return stat((path + "/" + name).c_str(), &st) == 0 ? (size_t)st.st_size : 0;
+    }
+
+private:
+    DIR*        d;
+    std::string path;
+    std::string name;
+};
+
+class HostLittleFS {
+public:
+    bool begin() {
+        ::mkdir(root().c_str(), 0755);
+        return true;
+    }
+
+    File open(const char* path, const char* mode) {
+        // Arduino "a" appends but may still read; "w" truncates
+        const char* m = !strcmp(mode, "w") ? "w+b" : !strcmp(mode, "a") ? "a+b" : "rb";
+        return File(fopen(full(path).c_str(), m));
+    }
+
+    bool exists(const char* path) {
+        struct stat st;
+        return stat(full(path).c_str(), &st) == 0;
+    }
+
+    bool remove(const char* path) { return ::remove(full(path).c_str()) == 0; }
+    bool mkdir(const char* path)  { return ::mkdir(full(path).c_str(), 0755) == 0 || exists(path); }
+
+    Dir openDir(const char* path) {
+        std::string p = full(path);
+        return Dir(opendir(p.c_str()), p);
+    }
+
+private:
+    static std::string root() {
+        const char* r = getenv("HOST_FS_ROOT");
+        return r ? r : "/tmp/host_littlefs";
+    }
+    static std::string full(const char* path) { return root() + path; }
+};
+
+inline HostLittleFS LittleFS;
+
+#endif
@@ -0,0 +1,659 @@
+// Host micro-benchmark for the processing pipeline.
+//
+//   pio run -e native && .pio/build/native/program [options] [recording.bin ...]
+//
+// Reports ns/frame and frames/s per stage over synthetic 8x8 sequences and
+// any recorded sequences given on the command line (concatenated 280-byte
+// v1 WebSocket payloads, as captured from /ws).
+//
+//   --write-baseline FILE   store the results
+//   --baseline FILE         exit non-zero if a stage is slower than stored
+//   --tolerance X           allowed slowdown vs. baseline (default 0.25)
+//   --web DIR               output of tools/build_web.py to measure
+//                           (default .pio/webdata if present)
+//
+// The temporal filter modes are compared on step-response latency
+// (synthetic 10 °C step) and steady-state noise (frame-to-frame RMS) on
+// every sequence, and recordings get a report of what a default alarm rule
+// set would raise. The kernels are also instantiated for larger grids
+// (16x12, 32x24 as on the MLX90640, 80x60) in float and int16, and ns/frame
+// and ns/pixel are reported so the cost of a bigger sensor can be read off
+// directly.
+//
+// The recorder runs against the LittleFS stand-in in host/ (a temporary
+// directory) and reports write throughput and seek latency. Config load
+// time, the WebSocket set-param / get-status round trip, UDP publisher
+// throughput and receiver-side loss, snapshot render cost and the bytes a
+// browser fetches on a cold and a warm page load are reported as well.
+//
+// Correctness checks live in test/ (pio test -e native / native_fixed);
+// this program only measures.
+
+// `pio test` links host/ into each suite, which brings its own main()
+#ifndef PIO_UNIT_TESTING
+
+#include <Arduino.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <string>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "fixtures.h"
+#include "pixel_format.h"
+#include "pipeline.h"
+#include "pipeline_kernel.h"
+#include "temporal_filter.h"
+#include "stats.h"
+#include "amg_reader.h"
+#include "ws_codec.h"
+#include "metrics.h"
+#include "nuc.h"
+#include "roi.h"
+#include "recorder.h"
+#include "alarm.h"
+#include "config.h"
+#include "config_store.h"
+#include "web_assets.h"
+#include "snapshot.h"
+#include "ws_control.h"
+#include "udp_publisher.h"
+#include <LittleFS.h>
+
+struct Result {
+    std::string sequence;
+    std::string stage;
+    double      ns_per_frame;
+};
+
+// ── Pipeline stages ─────────────────────────────────
+
+static void bench_sequence(const Sequence& seq, std::vector<Result>& out) {
+    const size_t n = seq.frames();
+
+    std::vector<pixel_t> input(n * GRID_PIXELS);
+    std::vector<pixel_t> work(n * GRID_PIXELS);
+    std::vector<uint8_t> regs(n * 2 * GRID_PIXELS);
+    std::vector<FrameStats> stats(n);
+
+    for (size_t i = 0; i < n * GRID_PIXELS; i++) {
+        int16_t raw = (int16_t)lroundf(seq.celsius[i] * 4.0f);
+        input[i] = pixel_from_raw(raw);
+        regs[i * 2]     = (uint8_t)(raw & 0xFF);
+        regs[i * 2 + 1] = (uint8_t)((raw >> 8) & 0x0F);
+    }
+    auto reset_work = [&]() { memcpy(work.data(), input.data(), n * GRID_PIXELS * sizeof(pixel_t)); };
+
+    SystemConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.temporal_enabled   = true;
+    cfg.alpha              = 0.3f;
+    cfg.calibration_offset = 0.5f;
+
+    const filter_coeff_t k = filter_coeff(cfg.alpha, cfg.filter_mode, cfg.adaptive_threshold);
+
+    auto add = [&](const char* stage, double ns) { out.push_back({ seq.name, stage, ns }); };
+
+    // Sensor: 4 chunked register reads + conversion per frame
+    pixel_t frame_buf[GRID_PIXELS];
+    uint32_t clock_ms = 0;
+    add("sensor_read", time_stage(n,
+        [&]() { amg_reader_init(&mock_bus); },
+        [&](size_t f) {
+            mock_regs = &regs[f * 2 * GRID_PIXELS];
+            clock_ms += AMG_FRAME_PERIOD_MS;
+            for (int c = 0; c < 2 * GRID_PIXELS / AMG_READ_CHUNK; c++) amg_reader_poll(clock_ms);
+            amg_reader_take(frame_buf);
+        }));
+
+    add("calibration", time_stage(n, reset_work,
+        [&](size_t f) { pipeline_calibrate(&work[f * GRID_PIXELS], cfg.calibration_offset); }));
+
+    add("filter", time_stage(n, [&]() { reset_work(); filter_reset(); },
+        [&](size_t f) { filter_apply(&work[f * GRID_PIXELS], k); }));
+
+    add("stats", time_stage(n, []() {},
+        [&](size_t f) { stats_compute(&input[f * GRID_PIXELS], stats[f]); }));
+
+    add("pipeline_total", time_stage(n, []() { filter_reset(); },
+        [&](size_t f) { pipeline_process(&input[f * GRID_PIXELS], &work[f * GRID_PIXELS], stats[f], cfg); }));
+
+    add("pipeline_fused", time_stage(n, []() { filter_reset(); },
+        [&](size_t f) { pipeline_process_fused(&input[f * GRID_PIXELS], &work[f * GRID_PIXELS], stats[f], cfg); }));
+
+    RoiResults rois;
+    configure_test_rois();
+    add("pipeline_fused_roi", time_stage(n, []() { filter_reset(); },
+        [&](size_t f) { pipeline_process_fused(&input[f * GRID_PIXELS], &work[f * GRID_PIXELS], stats[f], cfg, &rois); }));
+    roi_configure(nullptr, 0);
+
+    // Payload assembly on the processed frames
+    for (size_t f = 0; f < n; f++) pipeline_process(&input[f * GRID_PIXELS], &work[f * GRID_PIXELS], stats[f], cfg);
+    auto frame_at = [&](size_t f) {
+        Frame fr;
+        memset(&fr, 0, sizeof(fr));
+        fr.seq    = (uint32_t)f;
+        fr.stats  = stats[f];
+        fr.pixels = &work[f * GRID_PIXELS];
+        return fr;
+    };
+
+    uint8_t buf[sizeof(ws_payload_t)];
+    add("payload_v1", time_stage(n, []() {},
+        [&](size_t f) { ws_v1_encode(frame_at(f), buf); }));
+
+    WsV2Encoder enc;
+    size_t bytes = 0;
+    add("payload_v2_i16", time_stage(n,
+        [&]() { ws_v2_encoder_init(enc, WS_QUANT_I16); bytes = 0; },
+        [&](size_t f) { bytes += ws_v2_encode(enc, frame_at(f), buf); }));
+    printf("  %-20s v2_i16 %.1f bytes/frame\n", seq.name.c_str(), (double)bytes / n);
+
+    add("payload_v2_i8", time_stage(n,
+        [&]() { ws_v2_encoder_init(enc, WS_QUANT_I8); bytes = 0; },
+        [&](size_t f) { bytes += ws_v2_encode(enc, frame_at(f), buf); }));
+    printf("  %-20s v2_i8  %.1f bytes/frame\n", seq.name.c_str(), (double)bytes / n);
+}
+
+// ── Alarm rules ─────────────────────────────────────
+
+// Events a default rule set raises on each sequence, for recordings
+static void report_alarms(const std::vector<Sequence>& sequences) {
+    const AlarmRule rules[] = {
+        make_rule(ALARM_ABS,   ALARM_SOURCE_FRAME, 35.0f, 1.0f, 1000),
+        make_rule(ALARM_DELTA, ALARM_SOURCE_FRAME, 5.0f,  1.0f, 1000),
+        make_rule(ALARM_RATE,  ALARM_SOURCE_FRAME, 1.0f,  0.5f, 1000),
+    };
+    printf("\n%-24s %-8s %8s %8s\n", "sequence", "rule", "raised", "cleared");
+    for (const Sequence& s : sequences) {
+        for (const AlarmRule& r : rules) {
+            std::vector<AlarmEvent> ev = replay_alarm(s.frames(), 100,
+                [&s](size_t f, int i) { return s.celsius[f * GRID_PIXELS + i]; }, r);
+            printf("%-24s %-8s %8d %8d\n", s.name.c_str(), r.name,
+                count_kind(ev, ALARM_EVENT_RAISE), count_kind(ev, ALARM_EVENT_CLEAR));
+        }
+    }
+}
+
+
+// ── Config store ────────────────────────────────────
+
+// Size of one stored record and the boot-time cost of loading it
+static int report_config() {
+    char root[] = "/tmp/bench_littlefs_XXXXXX";
+    if (!mkdtemp(root)) return 1;
+    setenv("HOST_FS_ROOT", root, 1);
+    LittleFS.begin();
+    SystemConfig& cfg = config_get();
+    config_store_erase();
+    config_init();
+    cfg.roi_count   = 1;
+    cfg.alarm_count = 1;
+    cfg.alarms[0]   = make_rule(ALARM_RATE, 0, 1.5f, 0.5f, 2000);
+    if (!config_save()) return 1;
+
+    const int loads = 1000;
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < loads; i++) config_store_load(cfg);
+    double load_us = (now_ns() - t0) / 1e3 / loads;
+    FILE* f = fopen((std::string(root) + CONFIG_SLOT_A).c_str(), "rb");
+    long record_bytes = 0;
+    if (f) { fseek(f, 0, SEEK_END); record_bytes = ftell(f); fclose(f); }
+    printf("\nConfig store: %ld-byte record, load %.2f us\n", record_bytes, load_us);
+
+    config_store_erase();
+    rmdir(root);
+    config_init();
+    config_apply();
+    return 0;
+}
+
+// ── WebSocket control messages ──────────────────────
+
+// Set-param and get-status handled and answered, as one WS_EVT_DATA
+static int report_control() {
+    char root[] = "/tmp/bench_littlefs_XXXXXX";
+    if (!mkdtemp(root)) return 1;
+    setenv("HOST_FS_ROOT", root, 1);
+    LittleFS.begin();
+    config_store_erase();
+    config_init();
+
+    const WsControlLive live = { 5, 1, false };
+    uint8_t reply[WS_CONTROL_REPLY_MAX];
+    uint16_t seq = 0;
+    const int trips = 20000;
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < trips; i++) {
+        ws_set_param_t req = { WS_MSG_SET_PARAM, WS_PARAM_OFFSET, ++seq, (i % 100) * 0.01f };
+        ws_control_handle((const uint8_t*)&req, sizeof(req), 0, live, reply);
+    }
+    double set_ns = (double)(now_ns() - t0) / trips;
+    t0 = now_ns();
+    for (int i = 0; i < trips; i++) {
+        ws_get_status_t req = { WS_MSG_GET_STATUS, 0, ++seq };
+        ws_control_handle((const uint8_t*)&req, sizeof(req), 0, live, reply);
+    }
+    double status_ns = (double)(now_ns() - t0) / trips;
+
+    printf("\nWS control: set-param %.0f ns (%zu + %zu bytes), get-status %.0f ns (%zu + %zu bytes)\n",
+           set_ns, sizeof(ws_set_param_t), sizeof(ws_ack_packet_t),
+           status_ns, sizeof(ws_get_status_t), sizeof(ws_status_packet_t));
+
+    config_poll(1000000);                            // flush the timing loop's save
+    config_store_erase();
+    rmdir(root);
+    config_init();
+    config_apply();
+    return 0;
+}
+
+// ── UDP publisher ───────────────────────────────────
+
+// Device side of one datagram per frame on loopback, for a clean run and
+// for one with 1 in 20 sends refused
+static void report_udp(const Sequence& seq) {
+    const size_t n = seq.frames();
+    std::vector<pixel_t> pixels(n * GRID_PIXELS);
+    for (size_t i = 0; i < n * GRID_PIXELS; i++) pixels[i] = pixel_from_c(seq.celsius[i]);
+    std::vector<FrameStats> stats(n);
+    for (size_t f = 0; f < n; f++) stats_compute(&pixels[f * GRID_PIXELS], stats[f]);
+
+    UdpReceiver rx;
+    uint16_t port;
+    if (!udp_loopback_open(rx, port)) {
+        printf("\nUDP publisher: no loopback socket, not measured\n");
+        return;
+    }
+    const uint8_t loopback[4] = { 127, 0, 0, 1 };
+    udp_publisher_init(&host_udp);
+    udp_publisher_configure(true, loopback, port, 1);
+
+    auto run = [&](uint32_t frames, double& fps) {
+        rx = UdpReceiver{ rx.fd };
+        uint64_t t0 = now_ns();
+        for (uint32_t f = 0; f < frames; f++) {
+            Frame fr;
+            memset(&fr, 0, sizeof(fr));
+            fr.seq          = f;
+            fr.timestamp_ms = f * 100;
+            fr.stats        = stats[f % n];
+            fr.pixels       = &pixels[(f % n) * GRID_PIXELS];
+            udp_publish(fr, f, true);
+            if (f % 64 == 63) rx.drain();
+        }
+        fps = frames * 1e9 / (now_ns() - t0);
+        usleep(20000);
+        rx.drain();
+    };
+    const uint32_t frames = 20000;
+    double fps;
+    run(frames, fps);
+    printf("\nUDP publisher: %zu-byte datagrams, %.0f frames/s on loopback (%.1f MB/s), "
+           "%u received, loss %.2f%%\n", UDP_DATAGRAM_SIZE, fps, fps * UDP_DATAGRAM_SIZE / 1e6,
+           rx.received, 100.0 * rx.lost / (rx.received + rx.lost));
+
+    udp_drop_every = 20;
+    udp_send_calls = 0;
+    run(frames + 1, fps);
+    udp_drop_every = 0;
+    printf("UDP publisher: 1 in 20 sends refused, receiver measured %.2f%% loss\n",
+           100.0 * rx.lost / (rx.received + rx.lost));
+
+    udp_publisher_configure(false, loopback, port, 1);
+    udp_loopback_close(rx);
+}
+
+// ── Static web assets ───────────────────────────────
+
+// Cold vs. warm page loads on the real build output, if there is one
+static int report_web_assets(const char* web_dir) {
+    struct stat st;
+    if (!web_dir && stat(".pio/webdata/www/manifest.txt", &st) == 0) web_dir = ".pio/webdata";
+    if (!web_dir) return 0;
+    setenv("HOST_FS_ROOT", web_dir, 1);
+    if (web_assets_load() == 0) {
+        printf("No %s%s\n", web_dir, WEB_ASSET_MANIFEST);
+        return 1;
+    }
+    uint32_t raw = 0;
+    for (int i = 0; i < web_asset_count(); i++) raw += web_asset_get(i)->raw_size;
+    std::map<std::string, std::string> cache;
+    PageLoad cold = page_load(cache), warm = page_load(cache);
+    printf("\nWeb assets (%s): uncached %u B/load, cold %u B in %d requests, "
+           "warm %u B in %d requests (%d x 304)\n", web_dir, raw, cold.bytes,
+           cold.requests, warm.bytes, warm.requests, warm.not_modified);
+    return 0;
+}
+
+// ── Snapshot images ─────────────────────────────────
+
+// Cost of one render and of sending it, largest size
+static void report_snapshot() {
+    ws_frame_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+    for (int i = 0; i < GRID_PIXELS; i++) rec.pixels[i] = 2000 + (i % GRID_WIDTH) * 100;
+    rec.tmin = 2000;
+    rec.tmax = 2700;
+    snapshot_init();
+
+    SnapshotParams big = { (uint8_t)SNAPSHOT_MAX_SCALE, true, false, 2000, 2700 };
+    SnapshotStream up;
+    const int reps = 2000;
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < reps; i++) {
+        rec.seq++;
+        snapshot_begin(rec, SNAPSHOT_PNG, big, up);
+    }
+    double render_us = (now_ns() - t0) / 1e3 / reps;
+    uint8_t buf[1460];
+    t0 = now_ns();
+    for (int i = 0; i < reps; i++) {
+        for (size_t off = 0, n; (n = snapshot_read(up, off, buf, sizeof(buf))) > 0; off += n) {}
+    }
+    double read_us = (now_ns() - t0) / 1e3 / reps;
+    const int w = GRID_WIDTH * big.scale, h = GRID_HEIGHT * big.scale;
+    printf("\nSnapshot %dx%d PNG (%u B): render + sums %.1f us, streaming %.1f us; "
+           "%dx%d BMP %u B\n", w, h, up.length, render_us, read_us, w, h,
+           (unsigned)(1078 + ((w + 3) & ~3) * h));
+}
+
+// ── Recorder ────────────────────────────────────────
+
+static int bench_recorder(const Sequence& seq) {
+    char root[] = "/tmp/bench_littlefs_XXXXXX";
+    if (!mkdtemp(root)) return 1;
+    setenv("HOST_FS_ROOT", root, 1);
+    LittleFS.begin();
+
+    // Long enough to rotate segments
+    const size_t n = seq.frames(), total = 4000;
+    std::vector<pixel_t> frames(n * GRID_PIXELS);
+    for (size_t i = 0; i < n * GRID_PIXELS; i++) frames[i] = pixel_from_c(seq.celsius[i]);
+
+    recorder_init();
+    recorder_start();
+    Frame fr;
+    memset(&fr, 0, sizeof(fr));
+    uint64_t t0 = now_ns();
+    for (size_t f = 0; f < total; f++) {
+        fr.seq          = (uint32_t)f;
+        fr.timestamp_ms = 1000 + (uint32_t)f * 100;
+        fr.pixels       = &frames[(f % n) * GRID_PIXELS];
+        recorder_push(fr);
+        while (recorder_poll()) {}
+    }
+    recorder_stop();
+    uint64_t dt = now_ns() - t0;
+    const RecorderStats& st = recorder_stats();
+
+    printf("\nrecorder %-20s %zu frames, %u dropped, %.1f bytes/frame, %u segments rotated\n",
+        seq.name.c_str(), total, st.dropped, (double)st.bytes_written / total, st.segments_rotated);
+    printf("recorder %-20s write %.0f ns/frame, %.2f MB/s, max block %u us\n", seq.name.c_str(),
+        (double)dt / total, st.bytes_written / (dt / 1e9) / 1e6, st.max_write_us);
+
+    // Seek latency: locate a random range and read its first block
+    int failures = 0;
+    uint8_t buf[REC_PAGE_SIZE];
+    const int seeks = 500;
+    RecSegmentInfo oldest;
+    uint32_t first_ms = recorder_segment_info(0, oldest) ? oldest.first_ms : 1000;
+    uint64_t seek_total = 0, seek_max = 0;
+    for (int s = 0; s < seeks; s++) {
+        uint32_t from = first_ms + (uint32_t)(rand() % ((1000 + total * 100) - first_ms));
+        uint64_t s0 = now_ns();
+        RecCursor cur;
+        bool ok = recorder_seek(from, from + 1000, cur) && recorder_read(cur, buf, sizeof(buf)) > 0;
+        uint64_t ds = now_ns() - s0;
+        seek_total += ds;
+        if (ds > seek_max) seek_max = ds;
+        if (!ok) failures++;
+    }
+    printf("recorder %-20s seek+first read %.1f us avg, %.1f us max over %d seeks\n",
+        seq.name.c_str(), seek_total / 1e3 / seeks, seek_max / 1e3, seeks);
+
+    // Clean up the temporary filesystem
+    Dir dir = LittleFS.openDir(REC_DIR);
+    while (dir.next()) LittleFS.remove((std::string(REC_DIR "/") + dir.fileName()).c_str());
+    rmdir((std::string(root) + REC_DIR).c_str());
+    rmdir(root);
+    if (failures) printf("recorder: %d seeks found nothing\n", failures);
+    return failures;
+}
+
+// ── Filter quality ──────────────────────────────────
+
+struct FilterVariant {
+    const char* name;
+    bool        enabled;
+    uint8_t     mode;
+    float       alpha;
+    float       threshold;
+};
+
+static const FilterVariant FILTER_VARIANTS[] = {
+    { "off",               false, FILTER_MODE_IIR,      1.0f, 0.0f },
+    { "iir_a0.30",         true,  FILTER_MODE_IIR,      0.3f, 0.0f },
+    { "iir_a0.10",         true,  FILTER_MODE_IIR,      0.1f, 0.0f },
+    { "adaptive_a0.10_t2", true,  FILTER_MODE_ADAPTIVE, 0.1f, 2.0f },
+    { "adaptive_a0.05_t3", true,  FILTER_MODE_ADAPTIVE, 0.05f, 3.0f },
+};
+
+static void run_filter(const Sequence& seq, const FilterVariant& v, std::vector<pixel_t>& out) {
+    const size_t n = seq.frames();
+    SystemConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.temporal_enabled   = v.enabled;
+    cfg.alpha              = v.alpha;
+    cfg.filter_mode        = v.mode;
+    cfg.adaptive_threshold = v.threshold;
+
+    std::vector<pixel_t> input(GRID_PIXELS);
+    FrameStats st;
+    out.resize(n * GRID_PIXELS);
+    filter_reset();
+    for (size_t f = 0; f < n; f++) {
+        for (int i = 0; i < GRID_PIXELS; i++) input[i] = pixel_from_c(seq.celsius[f * GRID_PIXELS + i]);
+        pipeline_process_fused(input.data(), &out[f * GRID_PIXELS], st, cfg);
+    }
+}
+
+// Frames from the step until the mean of the stepped pixels is within 10 %
+// of the final value (1 = settled on the step frame itself)
+static int step_latency(const std::vector<pixel_t>& out, size_t n) {
+    for (size_t f = STEP_FRAME; f < n; f++) {
+        float sum = 0.0f;
+        for (int y = 2; y < 6; y++)
+            for (int x = 2; x < 6; x++) sum += pixel_to_c(out[f * GRID_PIXELS + y * GRID_WIDTH + x]);
+        if (sum / 16.0f - 22.0f >= STEP_C * 0.9f) return (int)(f - STEP_FRAME + 1);
+    }
+    return -1;
+}
+
+// RMS of the frame-to-frame change over all pixels, skipping the first
+// `skip` frames while the filter settles
+static double frame_noise(const std::vector<pixel_t>& out, size_t n, size_t skip) {
+    double acc = 0.0;
+    size_t count = 0;
+    for (size_t f = skip + 1; f < n; f++) {
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            double d = pixel_to_c(out[f * GRID_PIXELS + i]) - pixel_to_c(out[(f - 1) * GRID_PIXELS + i]);
+            acc += d * d;
+            count++;
+        }
+    }
+    return count ? sqrt(acc / count) : 0.0;
+}
+
+static void report_filters(const std::vector<Sequence>& sequences) {
+    const Sequence step = make_step(STEP_FRAME + 40);
+    std::vector<pixel_t> out;
+
+    printf("\n%-20s %14s", "filter", "step_frames");
+    for (const Sequence& s : sequences) printf(" %18.18s", s.name.c_str());
+    printf("\n%-20s %14s", "", "");
+    for (size_t i = 0; i < sequences.size(); i++) printf(" %18s", "noise_rms_C");
+    printf("\n");
+
+    for (const FilterVariant& v : FILTER_VARIANTS) {
+        run_filter(step, v, out);
+        printf("%-20s %14d", v.name, step_latency(out, step.frames()));
+        for (const Sequence& s : sequences) {
+            run_filter(s, v, out);
+            printf(" %18.3f", frame_noise(out, s.frames(), 20));
+        }
+        printf("\n");
+    }
+    filter_reset();
+}
+
+// ── Grid scaling ────────────────────────────────────
+
+// Walk-in scene resampled to grid G: same field of view, more pixels
+template <class G, class P>
+static std::vector<P> make_grid_walk_in(size_t n) {
+    std::vector<P> v;
+    v.reserve(n * G::pixels);
+    for (size_t f = 0; f < n; f++) {
+        float cx = (float)(f % 40) / 40.0f * 10.0f - 1.0f;
+        for (int i = 0; i < G::pixels; i++) {
+            float dx = (G::x_of(i) + 0.5f) * 8.0f / G::width  - 0.5f - cx;
+            float dy = (G::y_of(i) + 0.5f) * 8.0f / G::height - 0.5f - 4.0f;
+            float body = (dx * dx + dy * dy < 6.0f) ? 12.0f : 0.0f;
+            v.push_back(PixelTraits<P>::from_c(22.0f + body + noise()));
+        }
+    }
+    return v;
+}
+
+// Calibration + (optional) filter + statistics for one grid and pixel type
+template <class G, class P>
+static double time_grid(bool temporal) {
+    const size_t n = 40;
+    const std::vector<P> input = make_grid_walk_in<G, P>(n);
+    std::vector<P> work(n * G::pixels);
+    std::vector<FrameStatsT<P>> stats(n);
+    static FilterStateT<G, P> fs;   // one per instantiation
+    const typename FilterMath<P>::Coeff k = FilterMath<P>::coeff(0.3f, FILTER_MODE_IIR, 2.0f);
+    const P off = PixelTraits<P>::from_c(0.5f);
+
+    return time_stage(n, [&]() { fs.primed = false; },
+        [&](size_t f) {
+            pipeline_run_t<G, P>(&input[f * G::pixels], &work[f * G::pixels], stats[f], off, fs, k, temporal);
+        });
+}
+
+template <class G>
+static void report_grid() {
+    char grid[16];
+    snprintf(grid, sizeof(grid), "%dx%d", G::width, G::height);
+    for (int temporal = 0; temporal < 2; temporal++) {
+        double ns_f = time_grid<G, float>(temporal);
+        double ns_i = time_grid<G, int16_t>(temporal);
+        printf("%-8s %-8s %12.1f %10.2f %12.1f %10.2f\n", grid, temporal ? "iir" : "off",
+            ns_f, ns_f / G::pixels, ns_i, ns_i / G::pixels);
+    }
+}
+
+static void report_grids() {
+    printf("\n%-8s %-8s %12s %10s %12s %10s\n", "grid", "filter",
+        "float ns/fr", "ns/px", "int16 ns/fr", "ns/px");
+    report_grid<Amg8833Grid>();
+    report_grid<Grid<16, 12>>();
+    report_grid<Mlx90640Grid>();
+    report_grid<Grid<80, 60>>();
+}
+
+// ── Baseline ────────────────────────────────────────
+
+static bool write_baseline(const char* path, const std::vector<Result>& results) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    for (const Result& r : results) {
+        fprintf(f, "%s %s %.2f\n", r.sequence.c_str(), r.stage.c_str(), r.ns_per_frame);
+    }
+    fclose(f);
+    return true;
+}
+
+static int check_baseline(const char* path, const std::vector<Result>& results, double tol) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        printf("Cannot open baseline %s\n", path);
+        return 1;
+    }
+    char seq[256], stage[64];
+    double base;
+    int failures = 0;
+    while (fscanf(f, "%255s %63s %lf", seq, stage, &base) == 3) {
+        for (const Result& r : results) {
+            if (r.sequence != seq || r.stage != stage) continue;
+            if (r.ns_per_frame > base * (1.0 + tol)) {
+                printf("REGRESSION %s/%s: %.1f ns/frame vs baseline %.1f\n",
+                    seq, stage, r.ns_per_frame, base);
+                failures++;
+            }
+        }
+    }
+    fclose(f);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    const char* baseline_in  = nullptr;
+    const char* baseline_out = nullptr;
+    double      tolerance    = 0.25;
+    const char* web_dir      = nullptr;
+    std::vector<Sequence> sequences;
+
+    sequences.push_back(make_static_scene(200));
+    sequences.push_back(make_walk_in(200));
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--baseline") && i + 1 < argc)            baseline_in  = argv[++i];
+        else if (!strcmp(argv[i], "--write-baseline") && i + 1 < argc) baseline_out = argv[++i];
+        else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc)      tolerance    = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--web") && i + 1 < argc)            web_dir      = argv[++i];
+        else {
+            Sequence s;
+            if (!load_recording(argv[i], s)) {
+                printf("Cannot load recording %s\n", argv[i]);
+                return 1;
+            }
+            sequences.push_back(s);
+        }
+    }
+
+    printf("Pipeline: %s\n", FIXED_POINT_PIPELINE ? "fixed-point (int16 centi-degrees)" : "float");
+    metrics_init();
+    nuc_init();
+
+    report_filters(sequences);
+    report_grids();
+    report_alarms(sequences);
+    for (const Sequence& s : sequences) {
+        if (bench_recorder(s)) return 1;
+    }
+    if (report_config() || report_control()) return 1;
+    report_udp(sequences[1]);
+    report_snapshot();
+    if (report_web_assets(web_dir)) return 1;
+
+    std::vector<Result> results;
+    for (const Sequence& s : sequences) bench_sequence(s, results);
+
+    printf("\n%-24s %-16s %12s %14s\n", "sequence", "stage", "ns/frame", "frames/s");
+    for (const Result& r : results) {
+        printf("%-24s %-16s %12.1f %14.0f\n", r.sequence.c_str(), r.stage.c_str(),
+            r.ns_per_frame, 1e9 / r.ns_per_frame);
+    }
+
+    if (baseline_out && !write_baseline(baseline_out, results)) {
+        printf("Cannot write baseline %s\n", baseline_out);
+        return 1;
+    }
+    if (baseline_in) return check_baseline(baseline_in, results, tolerance);
+    return 0;
+}
+#endif
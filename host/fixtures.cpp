@@ -0,0 +1,266 @@
+#include "fixtures.h"
+
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "amg_reader.h"
+#include "frame.h"
+#include "roi.h"
+#include "stats.h"
+#include "web_assets.h"
+
+// ── Sequences ───────────────────────────────────────
+
+float noise() {
+    return ((rand() % 9) - 4) * 0.25f * 0.5f;
+}
+
+Sequence make_static_scene(size_t n) {
+    Sequence s;
+    s.name = "synthetic_static";
+    for (size_t f = 0; f < n; f++) {
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            s.celsius.push_back(21.0f + (i / GRID_WIDTH) * 0.25f + noise());
+        }
+    }
+    return s;
+}
+
+Sequence make_walk_in(size_t n) {
+    Sequence s;
+    s.name = "synthetic_walk_in";
+    for (size_t f = 0; f < n; f++) {
+        float cx = (float)(f % 40) / 40.0f * 10.0f - 1.0f;
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            float dx = (i % GRID_WIDTH) - cx, dy = (i / GRID_WIDTH) - 4.0f;
+            float body = (dx * dx + dy * dy < 6.0f) ? 12.0f : 0.0f;
+            s.celsius.push_back(22.0f + body + noise());
+        }
+    }
+    return s;
+}
+
+// Background plus noise; the centre 4x4 jumps by STEP_C at STEP_FRAME
+Sequence make_step(size_t n) {
+    Sequence s;
+    s.name = "synthetic_step";
+    for (size_t f = 0; f < n; f++) {
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            int x = i % GRID_WIDTH, y = i / GRID_WIDTH;
+            bool centre = x >= 2 && x < 6 && y >= 2 && y < 6;
+            float step  = (centre && f >= STEP_FRAME) ? STEP_C : 0.0f;
+            s.celsius.push_back(22.0f + step + noise());
+        }
+    }
+    return s;
+}
+
+bool load_recording(const char* path, Sequence& s) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    s.name = path;
+    ws_payload_t p;
+    while (fread(&p, sizeof(p), 1, f) == 1) {
+        for (int i = 0; i < GRID_PIXELS; i++) s.celsius.push_back(p.pixels[i]);
+    }
+    fclose(f);
+    return s.frames() > 0;
+}
+
+// ── Mock I2C bus ────────────────────────────────────
+
+const uint8_t* mock_regs = nullptr;
+
+static size_t mock_read_regs(uint8_t, uint8_t reg, uint8_t* buf, size_t len) {
+    memcpy(buf, mock_regs + (reg - AMG_REG_PIXELS), len);
+    return len;
+}
+
+const I2CBus mock_bus = { mock_read_regs };
+
+// ── ROIs ────────────────────────────────────────────
+
+void configure_test_rois() {
+    RoiConfig r[ROI_MAX];
+    memset(r, 0, sizeof(r));
+    r[0].mask = roi_rect_mask(2, 2, 4, 4);   r[0].threshold = 25.0f;
+    r[1].mask = roi_rect_mask(0, 0, 4, 8);   r[1].threshold = 22.0f;
+    r[2].mask = 0xAA55AA55AA55AA55ULL;       r[2].threshold = 30.0f;
+    r[3].mask = ~0ULL;                       r[3].threshold = 100.0f;
+    roi_configure(r, ROI_MAX);
+}
+
+// ── Alarm replay ────────────────────────────────────
+
+AlarmRule make_rule(uint8_t type, uint8_t source, float threshold,
+                    float hysteresis, uint16_t debounce_ms)
+{
+    AlarmRule r;
+    memset(&r, 0, sizeof(r));
+    snprintf(r.name, sizeof(r.name), "%s", alarm_type_name(type));
+    r.type        = type;
+    r.source      = source;
+    r.enabled     = true;
+    r.threshold   = threshold;
+    r.hysteresis  = hysteresis;
+    r.debounce_ms = debounce_ms;
+    return r;
+}
+
+std::vector<AlarmEvent> replay_alarm(size_t n, uint32_t period_ms,
+                                     const std::function<float(size_t, int)>& celsius,
+                                     const AlarmRule& rule)
+{
+    std::vector<AlarmEvent> events;
+    pixel_t    pixels[GRID_PIXELS];
+    RoiResults rois;
+    Frame      fr;
+    memset(&fr, 0, sizeof(fr));
+    fr.pixels = pixels;
+    fr.rois   = &rois;
+
+    alarm_init();
+    alarm_configure(&rule, 1);
+    for (size_t f = 0; f < n; f++) {
+        for (int i = 0; i < GRID_PIXELS; i++) pixels[i] = pixel_from_c(celsius(f, i));
+        stats_compute(pixels, fr.stats);
+        roi_compute(pixels, rois);
+        fr.seq          = (uint32_t)f;
+        fr.timestamp_ms = 1000 + (uint32_t)(f * period_ms);
+        uint32_t before = alarm_events_end();
+        alarm_evaluate(fr);
+        for (uint32_t id = before; id < alarm_events_end(); id++) events.push_back(*alarm_event_get(id));
+    }
+    alarm_init();
+    return events;
+}
+
+int count_kind(const std::vector<AlarmEvent>& ev, uint8_t kind) {
+    int n = 0;
+    for (const AlarmEvent& e : ev) n += e.kind == kind;
+    return n;
+}
+
+// ── v2 stream decoder ───────────────────────────────
+
+bool v2_decode(V2Decoder& d, const uint8_t* p, size_t len, int16_t* centi, ws_v2_header_t& h) {
+    if (len < sizeof(ws_v2_header_t)) return false;
+    memcpy(&h, p, sizeof(h));
+    const uint8_t* b = p + sizeof(h);
+    if (h.kind == WS_V2_KEYFRAME) {
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            if (h.quant == WS_QUANT_I8) d.q[i] = *b++;
+            else { d.q[i] = (uint16_t)(b[0] | (b[1] << 8)); b += 2; }
+        }
+    } else {
+        if (!d.primed || h.seq != (uint16_t)(d.seq + 1)) return false;
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            uint32_t v = 0;
+            int shift = 0;
+            uint8_t c;
+            do {
+                c = *b++;
+                v |= (uint32_t)(c & 0x7F) << shift;
+                shift += 7;
+            } while (c & 0x80);
+            d.q[i] += (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+        }
+    }
+    d.primed = true;
+    d.seq    = h.seq;
+    for (int i = 0; i < GRID_PIXELS; i++) centi[i] = (int16_t)(h.base + d.q[i] * h.step);
+    return true;
+}
+
+// ── Loopback UDP ────────────────────────────────────
+
+int      udp_tx_fd = -1;
+uint32_t udp_drop_every = 0, udp_send_calls = 0;
+
+static bool host_udp_send(const uint8_t addr[4], uint16_t port, const uint8_t* data, size_t len) {
+    if (udp_drop_every && ++udp_send_calls % udp_drop_every == 0) return false;
+    struct sockaddr_in to;
+    memset(&to, 0, sizeof(to));
+    to.sin_family = AF_INET;
+    to.sin_port   = htons(port);
+    memcpy(&to.sin_addr, addr, 4);
+    return sendto(udp_tx_fd, data, len, 0, (struct sockaddr*)&to, sizeof(to)) == (ssize_t)len;
+}
+
+const UdpSink host_udp = { host_udp_send };
+
+void UdpReceiver::drain() {
+    uint8_t buf[2048];
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+        udp_frame_header_t h;
+        if ((size_t)n < sizeof(h)) { bad++; continue; }
+        memcpy(&h, buf, sizeof(h));
+        if (memcmp(h.magic, UDP_MAGIC, 2) != 0 || h.version != UDP_VERSION ||
+            (size_t)n != sizeof(h) + h.record_size) { bad++; continue; }
+        received++;
+        if (started && h.seq < next_seq) { late++; continue; }
+        if (started) lost += h.seq - next_seq;
+        started  = true;
+        next_seq = h.seq + 1;
+    }
+}
+
+bool udp_loopback_open(UdpReceiver& rx, uint16_t& port) {
+    udp_tx_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    rx.fd     = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in local;
+    socklen_t local_len = sizeof(local);
+    memset(&local, 0, sizeof(local));
+    local.sin_family      = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int rcvbuf = 4 << 20;
+    if (udp_tx_fd < 0 || rx.fd < 0 ||
+        setsockopt(rx.fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) != 0 ||
+        bind(rx.fd, (struct sockaddr*)&local, sizeof(local)) != 0 ||
+        getsockname(rx.fd, (struct sockaddr*)&local, &local_len) != 0) {
+        udp_loopback_close(rx);
+        return false;
+    }
+    port = ntohs(local.sin_port);
+    return true;
+}
+
+void udp_loopback_close(UdpReceiver& rx) {
+    if (udp_tx_fd >= 0) close(udp_tx_fd);
+    if (rx.fd >= 0) close(rx.fd);
+    udp_tx_fd = -1;
+    rx.fd     = -1;
+}
+
+// ── Page load ───────────────────────────────────────
+
+PageLoad page_load(std::map<std::string, std::string>& cached_etags) {
+    PageLoad load = {0, 0, 0};
+    for (int i = 0; i < web_asset_count(); i++) {
+        const WebAsset* a   = web_asset_get(i);
+        std::string     url = std::string("/") + a->name;
+        auto            hit = cached_etags.find(url);
+        if (hit != cached_etags.end() && (a->flags & WEB_ASSET_IMMUTABLE)) continue;
+
+        WebAssetReply r;
+        web_asset_reply(url.c_str(), hit != cached_etags.end() ? hit->second.c_str() : nullptr, r);
+        load.requests++;
+        if (r.status == 304) load.not_modified++;
+        if (r.status == 200) {
+            load.bytes += a->size;
+            cached_etags[url] = a->etag;
+        }
+    }
+    return load;
+}
+
+// ── Stage timer ─────────────────────────────────────
+
+uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
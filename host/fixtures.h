@@ -0,0 +1,128 @@
+#ifndef HOST_FIXTURES_H
+#define HOST_FIXTURES_H
+
+// Shared by the host benchmark and the Unity suites in test/: synthetic
+// 8x8 sequences, a mock I2C bus, the ROI set the kernels are checked with,
+// alarm replay, a minimal v2 stream decoder, a loopback UDP sink and
+// receiver, a browser page load and the stage timer.
+
+#include <Arduino.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "i2c_bus.h"
+#include "ws_protocol.h"
+#include "alarm.h"
+#include "udp_publisher.h"
+
+#define BENCH_MIN_NS  200000000ull   // run each stage for at least 0.2 s
+#define STEP_FRAME    30             // step sequence: frame the step occurs
+#define STEP_C        10.0f          // step sequence: step height
+
+struct Sequence {
+    std::string          name;
+    std::vector<float>   celsius;   // frames * GRID_PIXELS
+    size_t frames() const { return celsius.size() / GRID_PIXELS; }
+};
+
+// ── Sequences ───────────────────────────────────────
+
+float    noise();                      // +-0.5 °C in 0.125 °C steps
+Sequence make_static_scene(size_t n);
+Sequence make_walk_in(size_t n);
+Sequence make_step(size_t n);          // centre 4x4 jumps by STEP_C at STEP_FRAME
+bool     load_recording(const char* path, Sequence& s);   // concatenated v1 payloads
+
+// ── Mock I2C bus serving register bytes ─────────────
+
+extern const uint8_t* mock_regs;       // 128 bytes from AMG_REG_PIXELS
+extern const I2CBus   mock_bus;
+
+// ── ROIs ────────────────────────────────────────────
+
+// Four overlapping ROIs: a centre rectangle, the left half, a
+// checkerboard mask and the full frame with a threshold nothing reaches
+// (exercises the hottest-pixel fallback)
+void configure_test_rois();
+
+// ── Alarm replay ────────────────────────────────────
+
+AlarmRule make_rule(uint8_t type, uint8_t source, float threshold,
+                    float hysteresis, uint16_t debounce_ms);
+
+// Replays n frames (celsius(f, i) per pixel, one every period_ms) through
+// stats, ROIs and a single rule; returns the logged events
+std::vector<AlarmEvent> replay_alarm(size_t n, uint32_t period_ms,
+                                     const std::function<float(size_t, int)>& celsius,
+                                     const AlarmRule& rule);
+int count_kind(const std::vector<AlarmEvent>& ev, uint8_t kind);
+
+// ── v2 stream decoder ───────────────────────────────
+
+// Returns false on a delta that does not follow the previous frame
+struct V2Decoder {
+    bool     primed = false;
+    uint16_t seq = 0;
+    uint16_t q[GRID_PIXELS];
+};
+
+bool v2_decode(V2Decoder& d, const uint8_t* p, size_t len, int16_t* centi, ws_v2_header_t& h);
+
+// ── Loopback UDP ────────────────────────────────────
+
+// Host sink: a POSIX datagram socket on udp_tx_fd; `udp_drop_every` > 0
+// makes every Nth send fail, as a full lwIP queue would
+extern int      udp_tx_fd;
+extern uint32_t udp_drop_every, udp_send_calls;
+extern const UdpSink host_udp;
+
+// What tools/udp_receiver.py does: validate, then count seq gaps
+struct UdpReceiver {
+    int      fd = -1;
+    bool     started = false;
+    uint32_t next_seq = 0, received = 0, lost = 0, late = 0, bad = 0;
+
+    void drain();
+};
+
+// Opens udp_tx_fd and a receiver bound to a free loopback port; false
+// (and nothing left open) if the host has no loopback networking
+bool udp_loopback_open(UdpReceiver& rx, uint16_t& port);
+void udp_loopback_close(UdpReceiver& rx);
+
+// ── Page load ───────────────────────────────────────
+
+struct PageLoad {
+    int      requests;
+    int      not_modified;
+    uint32_t bytes;                     // response bodies
+};
+
+// A browser loading the UI: index.html and every other asset, using its
+// cache the way the headers allow. Hashed files are not requested again;
+// the rest are revalidated with If-None-Match.
+PageLoad page_load(std::map<std::string, std::string>& cached_etags);
+
+// ── Stage timer ─────────────────────────────────────
+
+uint64_t now_ns();
+
+// Times `fn(frame_index)` over the whole sequence until BENCH_MIN_NS has
+// elapsed. `prep` runs untimed before each pass.
+template <typename Prep, typename Fn>
+double time_stage(size_t frames, Prep prep, Fn fn) {
+    uint64_t total = 0;
+    uint64_t count = 0;
+    while (total < BENCH_MIN_NS) {
+        prep();
+        uint64_t t0 = now_ns();
+        for (size_t f = 0; f < frames; f++) fn(f);
+        total += now_ns() - t0;
+        count += frames;
+    }
+    return (double)total / count;
+}
+
+#endif
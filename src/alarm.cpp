@@ -0,0 +1,172 @@
+#include "alarm.h"
+
+static AlarmRule  rules[ALARM_MAX_RULES];
+static AlarmState states[ALARM_MAX_RULES];
+static uint8_t    rule_count = 0;
+
+static AlarmEvent log_ring[ALARM_LOG_SIZE];
+static uint32_t   log_end = 0;
+
+static const char* const TYPE_NAMES[ALARM_TYPE_COUNT] = { "abs", "delta", "rate" };
+
+void alarm_init() {
+    rule_count = 0;
+    log_end    = 0;
+    memset(states, 0, sizeof(states));
+}
+
+void alarm_configure(const AlarmRule* r, uint8_t count) {
+    if (count > ALARM_MAX_RULES) count = ALARM_MAX_RULES;
+    memcpy(rules, r, count * sizeof(AlarmRule));
+    memset(states, 0, sizeof(states));
+    rule_count = count;
+}
+
+// ── Evaluation ──────────────────────────────────────
+
+// tmax and its position for the rule's source; false if the ROI is gone
+static bool source_max(const Frame& frame, uint8_t source, float& tmax, uint8_t& x, uint8_t& y) {
+    if (source == ALARM_SOURCE_FRAME) {
+        tmax = pixel_to_c(frame.stats.tmax);
+        x    = frame.stats.hotspot_x;
+        y    = frame.stats.hotspot_y;
+        return true;
+    }
+    if (!frame.rois || source >= frame.rois->count) return false;
+    const RoiStats& r = frame.rois->roi[source];
+    if (!r.pixels) return false;
+    tmax = pixel_to_c(r.tmax);
+    x    = (uint8_t)((r.cx_q8 + 128) >> 8);
+    y    = (uint8_t)((r.cy_q8 + 128) >> 8);
+    return true;
+}
+
+// First-order smoothing step for a sample `dt_ms` after the previous one
+static inline float smooth(float y, float x, uint32_t dt_ms, uint32_t tau_ms) {
+    return y + (x - y) * ((float)dt_ms / (float)(tau_ms + dt_ms));
+}
+
+static float rule_value(const AlarmRule& r, AlarmState& s, float tmax, uint32_t now) {
+    if (!s.primed) {
+        s.primed    = true;
+        s.baseline  = tmax;
+        s.rate      = 0.0f;
+        s.last_tmax = tmax;
+        s.last_ms   = now;
+    }
+    uint32_t dt = now - s.last_ms;
+
+    if (dt > 0) {
+        s.rate = smooth(s.rate, (tmax - s.last_tmax) * 1000.0f / dt, dt, ALARM_RATE_TAU_MS);
+        // A raised delta alarm must not teach the baseline its own cause
+        if (!s.active) s.baseline = smooth(s.baseline, tmax, dt, ALARM_BASELINE_TAU_MS);
+    }
+    s.last_tmax = tmax;
+    s.last_ms   = now;
+
+    switch (r.type) {
+        case ALARM_DELTA: return tmax - s.baseline;
+        case ALARM_RATE:  return s.rate;
+        default:          return tmax;
+    }
+}
+
+static void log_event(uint8_t rule, uint8_t kind, uint32_t now, float value, uint8_t x, uint8_t y) {
+    AlarmEvent& e  = log_ring[log_end % ALARM_LOG_SIZE];
+    e.id           = log_end++;
+    e.timestamp_ms = now;
+    e.rule         = rule;
+    e.kind         = kind;
+    e.value        = (int16_t)constrain(lroundf(value * 100.0f), INT16_MIN, INT16_MAX);
+    e.x            = x;
+    e.y            = y;
+    Serial.printf("[Alarm] %s %s (%.2f)\n", rules[rule].name,
+        kind == ALARM_EVENT_RAISE ? "raised" : "cleared", value);
+}
+
+int alarm_evaluate(const Frame& frame) {
+    int events = 0;
+    uint32_t now = frame.timestamp_ms;
+
+    for (uint8_t i = 0; i < rule_count; i++) {
+        const AlarmRule& r = rules[i];
+        AlarmState&      s = states[i];
+        if (!r.enabled) continue;
+
+        float   tmax;
+        uint8_t x, y;
+        if (!source_max(frame, r.source, tmax, x, y)) continue;
+        s.value = rule_value(r, s, tmax, now);
+
+        // Hysteresis: the condition to leave a state is past the band
+        bool want = s.active ? s.value >= r.threshold - r.hysteresis
+                             : s.value >= r.threshold;
+        if (want == s.active) {
+            s.changing = false;
+            continue;
+        }
+
+        // Debounce: the new condition must hold for debounce_ms
+        if (!s.changing) {
+            s.changing = true;
+            s.since_ms = now;
+        }
+        if (now - s.since_ms < r.debounce_ms) continue;
+
+        s.active     = want;
+        s.changing   = false;
+        s.changed_ms = now;
+        log_event(i, want ? ALARM_EVENT_RAISE : ALARM_EVENT_CLEAR, now, s.value, x, y);
+        events++;
+    }
+    return events;
+}
+
+// ── Accessors ───────────────────────────────────────
+
+int alarm_rule_count() {
+    return rule_count;
+}
+
+const AlarmRule& alarm_rule(int i) {
+    return rules[i];
+}
+
+const AlarmState& alarm_state(int i) {
+    return states[i];
+}
+
+uint8_t alarm_active_mask() {
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < rule_count; i++) {
+        if (states[i].active) mask |= 1 << i;
+    }
+    return mask;
+}
+
+uint32_t alarm_events_begin() {
+    return log_end > ALARM_LOG_SIZE ? log_end - ALARM_LOG_SIZE : 0;
+}
+
+uint32_t alarm_events_end() {
+    return log_end;
+}
+
+const AlarmEvent* alarm_event_get(uint32_t id) {
+    if (id < alarm_events_begin() || id >= log_end) return nullptr;
+    return &log_ring[id % ALARM_LOG_SIZE];
+}
+
+const char* alarm_type_name(uint8_t type) {
+    return type < ALARM_TYPE_COUNT ? TYPE_NAMES[type] : "abs";
+}
+
+bool alarm_type_from_name(const char* name, uint8_t& type) {
+    for (uint8_t t = 0; t < ALARM_TYPE_COUNT; t++) {
+        if (name && strcmp(name, TYPE_NAMES[t]) == 0) {
+            type = t;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,95 @@
+#ifndef ALARM_H
+#define ALARM_H
+
+#include <Arduino.h>
+#include "frame.h"
+
+// Per-frame alarm rules, evaluated on the processed frame's statistics so
+// clients can watch for overheating without receiving frames at all.
+//
+// Every rule watches the tmax of a source: the whole frame or one ROI.
+//
+//   abs    tmax                        °C
+//   delta  tmax - baseline             °C; baseline is a slow average of
+//                                      tmax, frozen while the rule is raised
+//   rate   smoothed d(tmax)/dt         °C/s
+//
+// A rule raises once its value has been >= threshold for debounce_ms and
+// clears once it has been < threshold - hysteresis for debounce_ms. Each
+// transition is appended to an event log addressed by absolute ids, like
+// the frame history, so a reader can tell what it missed.
+
+#define ALARM_MAX_RULES       8
+#define ALARM_NAME_LEN        16
+#define ALARM_LOG_SIZE        32
+#define ALARM_SOURCE_FRAME    0xFF
+
+#define ALARM_BASELINE_TAU_MS 300000   // delta rules: baseline time constant
+#define ALARM_RATE_TAU_MS     2000     // rate rules: slope smoothing
+
+enum AlarmType : uint8_t {
+    ALARM_ABS,
+    ALARM_DELTA,
+    ALARM_RATE,
+    ALARM_TYPE_COUNT
+};
+
+struct AlarmRule {
+    char     name[ALARM_NAME_LEN];
+    uint8_t  type;            // AlarmType
+    uint8_t  source;          // ROI index or ALARM_SOURCE_FRAME
+    bool     enabled;
+    float    threshold;       // °C (abs, delta) or °C/s (rate)
+    float    hysteresis;      // same unit as threshold
+    uint16_t debounce_ms;
+};
+
+struct AlarmState {
+    bool     active;
+    bool     primed;          // baseline/slope have a first sample
+    bool     changing;        // condition differs from `active`, see since_ms
+    uint32_t since_ms;        // when `changing` started
+    uint32_t changed_ms;      // last raise or clear
+    float    value;           // last evaluated value
+    float    baseline;
+    float    rate;
+    float    last_tmax;
+    uint32_t last_ms;
+};
+
+#define ALARM_EVENT_RAISE  1
+#define ALARM_EVENT_CLEAR  0
+
+struct AlarmEvent {
+    uint32_t id;
+    uint32_t timestamp_ms;
+    uint8_t  rule;
+    uint8_t  kind;            // ALARM_EVENT_*
+    int16_t  value;           // centi-degrees (or centi-°C/s)
+    uint8_t  x;               // where the source's maximum was
+    uint8_t  y;
+};
+
+void  alarm_init();
+
+// Replaces the rule set; all rules start cleared
+void  alarm_configure(const AlarmRule* rules, uint8_t count);
+
+// Evaluates every enabled rule on the frame. Returns the number of events
+// logged.
+int   alarm_evaluate(const Frame& frame);
+
+int               alarm_rule_count();
+const AlarmRule&  alarm_rule(int i);
+const AlarmState& alarm_state(int i);
+uint8_t           alarm_active_mask();   // bit i set if rule i is raised
+
+// Absolute ids: events [alarm_events_begin(), alarm_events_end()) are held
+uint32_t          alarm_events_begin();
+uint32_t          alarm_events_end();
+const AlarmEvent* alarm_event_get(uint32_t id);   // nullptr if evicted
+
+const char* alarm_type_name(uint8_t type);
+bool        alarm_type_from_name(const char* name, uint8_t& type);
+
+#endif
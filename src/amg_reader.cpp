@@ -0,0 +1,105 @@
+#include "amg_reader.h"
+
+enum ReaderState : uint8_t {
+    READER_WAIT,     // waiting for the next frame slot / trigger
+    READER_READING,  // reading chunk `chunk`
+};
+
+static const I2CBus*  bus = nullptr;
+static ReaderState    state = READER_WAIT;
+static uint8_t        chunk = 0;
+static uint32_t       next_start_ms = 0;
+static bool           triggered = false;
+
+static pixel_t        back[Amg8833Grid::pixels];    // frame being assembled
+static pixel_t        front[Amg8833Grid::pixels];   // newest complete fresh frame
+static bool           front_fresh = false;
+static uint32_t       hash = 0;     // FNV-1a over the raw bytes being read
+static uint32_t       prev_hash = 0;
+static AmgReaderStats stats;
+
+void amg_reader_init(const I2CBus* b) {
+    bus = b;
+    state = READER_WAIT;
+    chunk = 0;
+    next_start_ms = 0;
+    front_fresh = false;
+    triggered = false;
+    prev_hash = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+void amg_reader_trigger() {
+    triggered = true;
+}
+
+static void finish_frame(uint32_t now_ms) {
+    if (hash == prev_hash) {
+        // Sensor has not produced a new frame yet — try again shortly
+        stats.duplicates++;
+        next_start_ms = now_ms + AMG_RETRY_MS;
+        return;
+    }
+
+    prev_hash = hash;
+    memcpy(front, back, sizeof(front));
+    front_fresh = true;
+    stats.frames++;
+    stats.last_frame_ms = now_ms;
+    stats.last_frame_us = micros();
+    // Next frame is due one sensor period after this one appeared
+    next_start_ms = now_ms + AMG_FRAME_PERIOD_MS - AMG_RETRY_MS;
+}
+
+bool amg_reader_poll(uint32_t now_ms) {
+    if (!bus) return false;
+
+    if (state == READER_WAIT) {
+        bool due = (int32_t)(now_ms - next_start_ms) >= 0;
+        if (!due && !triggered) return false;
+        if (!due) stats.triggered++;
+        triggered = false;
+        state = READER_READING;
+        chunk = 0;
+        hash  = 2166136261u;
+    }
+
+    uint8_t buf[AMG_READ_CHUNK];
+    uint8_t reg = AMG_REG_PIXELS + chunk * AMG_READ_CHUNK;
+    if (bus->read_regs(AMG_I2C_ADDR, reg, buf, AMG_READ_CHUNK) != AMG_READ_CHUNK) {
+        stats.errors++;
+        state = READER_WAIT;
+        next_start_ms = now_ms + AMG_RETRY_MS;
+        return true;
+    }
+
+    int idx = chunk * (AMG_READ_CHUNK / 2);
+    for (int b = 0; b < AMG_READ_CHUNK; b += 2) {
+        hash = (hash ^ buf[b])     * 16777619u;
+        hash = (hash ^ buf[b + 1]) * 16777619u;
+        // 12-bit two's complement, 0.25 °C per LSB
+        int16_t raw = (int16_t)(((uint16_t)buf[b + 1] << 12) | ((uint16_t)buf[b] << 4)) >> 4;
+        back[idx++] = pixel_from_raw(raw);
+    }
+
+    if (++chunk * AMG_READ_CHUNK >= 128) {
+        state = READER_WAIT;
+        finish_frame(now_ms);
+    }
+    return true;
+}
+
+bool amg_reader_take(pixel_t* pixels64) {
+    if (!front_fresh) return false;
+    memcpy(pixels64, front, sizeof(front));
+    front_fresh = false;
+    return true;
+}
+
+bool amg_reader_available() {
+    return front_fresh;
+}
+
+const AmgReaderStats& amg_reader_stats() {
+    return stats;
+}
@@ -0,0 +1,51 @@
+#ifndef AMG_READER_H
+#define AMG_READER_H
+
+#include <Arduino.h>
+#include "i2c_bus.h"
+#include "pixel_format.h"
+#include "grid.h"
+
+// Non-blocking AMG8833 acquisition. The 128 pixel registers are read in
+// AMG_READ_CHUNK-byte transactions, one per amg_reader_poll() call, so the
+// main loop never blocks for a whole frame.
+//
+// The sensor has no data-ready flag. A frame whose registers are identical
+// to the previous one is counted as a duplicate and re-read shortly after,
+// which phase-locks reads to the sensor's internal 10 FPS clock.
+
+#define AMG_I2C_ADDR          0x69
+#define AMG_REG_PIXELS        0x80
+#define AMG_READ_CHUNK        32      // bytes per I2C transaction
+#define AMG_FRAME_PERIOD_MS   100     // sensor internal frame clock (10 FPS)
+#define AMG_RETRY_MS          10      // re-read delay after a duplicate
+
+static_assert(GRID_PIXELS == Amg8833Grid::pixels, "amg_reader drives an 8x8 AMG8833; other grids need their own driver");
+
+struct AmgReaderStats {
+    uint32_t frames;          // fresh frames completed
+    uint32_t duplicates;      // frames identical to the previous one
+    uint32_t errors;          // I2C transactions that came up short
+    uint32_t last_frame_ms;   // completion time of the newest fresh frame
+    uint32_t last_frame_us;   // same, micros(): capture stamp for latency telemetry
+    uint32_t triggered;       // reads started early by amg_reader_trigger()
+};
+
+void amg_reader_init(const I2CBus* bus);
+
+// Optional external trigger (e.g. the INT pin). Starts a read at the next
+// poll without waiting for the frame clock. Clock-driven reads carry on
+// regardless, so a trigger that never comes costs nothing.
+void amg_reader_trigger();
+
+// Advances the state machine by at most one I2C transaction.
+// Returns true if a transaction was issued.
+bool amg_reader_poll(uint32_t now_ms);
+
+// Copies the newest fresh frame if it has not been taken yet.
+bool amg_reader_take(pixel_t* pixels64);
+bool amg_reader_available();
+
+const AmgReaderStats& amg_reader_stats();
+
+#endif
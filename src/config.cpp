@@ -1,10 +1,15 @@
 #include "config.h"
-#include <LittleFS.h>
-#include <ArduinoJson.h>
+#include "config_store.h"
+#include "temporal_filter.h"
+#include "frame_batch.h"
+#include "udp_publisher.h"
 
 static SystemConfig cfg;
 
-static const char* CONFIG_PATH = "/config.json";
+// Debounced save: see config_request_save()
+static bool     save_pending  = false;
+static uint32_t save_first_ms = 0;
+static uint32_t save_due_ms   = 0;
 
 void config_init() {
     // Set defaults
@@ -13,70 +18,97 @@ void config_init() {
     cfg.idle_timeout_sec  = 10;
     cfg.temporal_enabled  = false;
     cfg.alpha             = 0.3f;
+    cfg.filter_mode       = FILTER_MODE_IIR;
+    cfg.adaptive_threshold = 2.0f;
     cfg.calibration_offset = 0.0f;
+    cfg.batch_frames      = 10;
+    cfg.batch_max_ms      = 5000;
+    cfg.record_enabled    = false;
+    cfg.roi_count         = 0;
+    memset(cfg.rois, 0, sizeof(cfg.rois));
+    cfg.alarm_count       = 0;
+    memset(cfg.alarms, 0, sizeof(cfg.alarms));
     cfg.sta_enabled       = false;
     memset(cfg.sta_ssid, 0, sizeof(cfg.sta_ssid));
     memset(cfg.sta_password, 0, sizeof(cfg.sta_password));
+    cfg.udp_enabled       = false;
+    udp_parse_addr("239.255.42.42", cfg.udp_group);
+    cfg.udp_port          = UDP_DEFAULT_PORT;
+    cfg.udp_every         = 1;
 }
 
-void config_load() {
-    config_init();  // start with defaults
+bool config_load() {
+    config_init();  // start with defaults; fields not stored keep them
 
-    if (!LittleFS.exists(CONFIG_PATH)) {
-        Serial.println("[Config] No config file, using defaults");
-        return;
-    }
+    bool ok = config_store_load(cfg);
+    config_sanitize(cfg);
+    config_apply();
 
-    File f = LittleFS.open(CONFIG_PATH, "r");
-    if (!f) {
-        Serial.println("[Config] Failed to open config file");
-        return;
+    if (ok) {
+        const ConfigStoreStats& st = config_store_stats();
+        Serial.printf("[Config] Loaded generation %u from slot %c in %u us\n",
+            st.seq, 'A' + st.slot, st.load_us);
     }
+    return ok;
+}
 
-    StaticJsonDocument<512> doc;
-    DeserializationError err = deserializeJson(doc, f);
-    f.close();
+bool config_save() {
+    save_pending = false;
+    if (!config_store_save(cfg)) return false;
+    Serial.printf("[Config] Saved generation %u\n", config_store_stats().seq);
+    return true;
+}
 
-    if (err) {
-        Serial.printf("[Config] Parse error: %s\n", err.c_str());
-        return;
+void config_request_save(uint32_t now_ms) {
+    if (!save_pending) {
+        save_pending  = true;
+        save_first_ms = now_ms;
     }
+    // Each change restarts the quiet period, but a steady stream of
+    // changes still reaches flash after CONFIG_SAVE_MAX_DELAY_MS
+    save_due_ms = now_ms + CONFIG_SAVE_DELAY_MS;
+    if ((int32_t)(save_due_ms - save_first_ms) > CONFIG_SAVE_MAX_DELAY_MS) {
+        save_due_ms = save_first_ms + CONFIG_SAVE_MAX_DELAY_MS;
+    }
+}
 
-    cfg.normal_fps        = config_clamp_fps(doc["normal_fps"] | 5);
-    cfg.idle_fps          = config_clamp_fps(doc["idle_fps"] | 1);
-    cfg.idle_timeout_sec  = constrain((int)(doc["idle_timeout_sec"] | 10), 1, 300);
-    cfg.temporal_enabled  = doc["temporal_enabled"] | false;
-    cfg.alpha             = config_clamp_alpha(doc["alpha"] | 0.3f);
-    cfg.calibration_offset = config_clamp_offset(doc["calibration_offset"] | 0.0f);
-    cfg.sta_enabled       = doc["sta_enabled"] | false;
-
-    strlcpy(cfg.sta_ssid,     doc["sta_ssid"] | "",     sizeof(cfg.sta_ssid));
-    strlcpy(cfg.sta_password, doc["sta_password"] | "",  sizeof(cfg.sta_password));
+bool config_save_pending() {
+    return save_pending;
+}
 
-    Serial.println("[Config] Loaded from flash");
+bool config_poll(uint32_t now_ms) {
+    if (!save_pending || (int32_t)(now_ms - save_due_ms) < 0) return false;
+    return config_save();
 }
 
-void config_save() {
-    StaticJsonDocument<512> doc;
-
-    doc["normal_fps"]        = cfg.normal_fps;
-    doc["idle_fps"]          = cfg.idle_fps;
-    doc["idle_timeout_sec"]  = cfg.idle_timeout_sec;
-    doc["temporal_enabled"]  = cfg.temporal_enabled;
-    doc["alpha"]             = cfg.alpha;
-    doc["calibration_offset"] = cfg.calibration_offset;
-    doc["sta_enabled"]       = cfg.sta_enabled;
-    doc["sta_ssid"]          = cfg.sta_ssid;
-    doc["sta_password"]      = cfg.sta_password;
-
-    File f = LittleFS.open(CONFIG_PATH, "w");
-    if (!f) {
-        Serial.println("[Config] Failed to write config");
-        return;
+void config_sanitize(SystemConfig& c) {
+    // A stored record passed its CRC but may come from other firmware
+    c.normal_fps         = config_clamp_fps(c.normal_fps);
+    c.idle_fps           = config_clamp_fps(c.idle_fps);
+    c.idle_timeout_sec   = constrain(c.idle_timeout_sec, 1, 300);
+    c.alpha              = config_clamp_alpha(c.alpha);
+    c.filter_mode        = c.filter_mode == FILTER_MODE_ADAPTIVE ? FILTER_MODE_ADAPTIVE : FILTER_MODE_IIR;
+    c.adaptive_threshold = config_clamp_threshold(c.adaptive_threshold);
+    c.calibration_offset = config_clamp_offset(c.calibration_offset);
+    c.batch_frames       = config_clamp_batch_frames(c.batch_frames);
+    c.batch_max_ms       = config_clamp_batch_ms(c.batch_max_ms);
+    if (c.roi_count > ROI_MAX)           c.roi_count = ROI_MAX;
+    if (c.alarm_count > ALARM_MAX_RULES) c.alarm_count = ALARM_MAX_RULES;
+    for (int i = 0; i < ROI_MAX; i++)         c.rois[i].name[ROI_NAME_LEN - 1] = '\0';
+    for (int i = 0; i < ALARM_MAX_RULES; i++) {
+        c.alarms[i].name[ALARM_NAME_LEN - 1] = '\0';
+        if (c.alarms[i].type >= ALARM_TYPE_COUNT) c.alarms[i].enabled = false;
     }
-    serializeJson(doc, f);
-    f.close();
-    Serial.println("[Config] Saved to flash");
+    c.sta_ssid[sizeof(c.sta_ssid) - 1]         = '\0';
+    c.sta_password[sizeof(c.sta_password) - 1] = '\0';
+    if (c.udp_port == 0)  c.udp_port  = UDP_DEFAULT_PORT;
+    if (c.udp_every == 0) c.udp_every = 1;
+}
+
+void config_apply() {
+    roi_configure(cfg.rois, cfg.roi_count);
+    alarm_configure(cfg.alarms, cfg.alarm_count);
+    udp_publisher_configure(cfg.udp_enabled, cfg.udp_group, cfg.udp_port, cfg.udp_every);
 }
 
 SystemConfig& config_get() {
@@ -100,3 +132,18 @@ float config_clamp_offset(float o) {
     if (o >  5.0f) return  5.0f;
     return o;
 }
+
+float config_clamp_threshold(float t) {
+    if (t < 0.25f) return 0.25f;
+    if (t > 10.0f) return 10.0f;
+    return t;
+}
+
+int config_clamp_batch_frames(int n) {
+    return constrain(n, 1, BATCH_MAX_FRAMES);
+}
+
+int config_clamp_batch_ms(int ms) {
+    return constrain(ms, 100, 60000);
+}
+
@@ -2,6 +2,8 @@
 #define CONFIG_H
 
 #include <Arduino.h>
+#include "roi.h"
+#include "alarm.h"
 
 struct SystemConfig {
     int   normal_fps;
@@ -9,21 +11,51 @@ struct SystemConfig {
     int   idle_timeout_sec;
     bool  temporal_enabled;
     float alpha;
+    uint8_t filter_mode;          // FILTER_MODE_IIR / FILTER_MODE_ADAPTIVE
+    float adaptive_threshold;     // °C change that bypasses smoothing
     float calibration_offset;
+    int   batch_frames;           // WS batch channel: frames per message
+    int   batch_max_ms;           // WS batch channel: max age of a pending frame
+    bool  record_enabled;         // append frames to the LittleFS recorder
+    uint8_t   roi_count;
+    RoiConfig rois[ROI_MAX];
+    uint8_t   alarm_count;
+    AlarmRule alarms[ALARM_MAX_RULES];
     bool  sta_enabled;
     char  sta_ssid[33];
     char  sta_password[65];
+    bool     udp_enabled;         // UDP frame publisher (udp_publisher.h)
+    uint8_t  udp_group[4];        // multicast or broadcast address
+    uint16_t udp_port;
+    uint8_t  udp_every;           // publish every Nth frame
 };
 
+// Settings live in the binary config store (config_store.h). Changes
+// from the UI are saved through config_request_save(), which turns a burst
+// of edits into one flash write once they stop.
+#define CONFIG_SAVE_DELAY_MS      3000    // quiet time before writing
+#define CONFIG_SAVE_MAX_DELAY_MS  15000   // longest a change stays unsaved
+
 // Default values
 void     config_init();
-void     config_load();
-void     config_save();
+bool     config_load();                   // false if nothing was stored
+bool     config_save();                   // writes now
+void     config_request_save(uint32_t now_ms);
+bool     config_save_pending();
+bool     config_poll(uint32_t now_ms);    // writes if a requested save is due
 SystemConfig& config_get();
 
+// Clamps every field to its valid range
+void     config_sanitize(SystemConfig& c);
+// Pushes ROI, alarm and UDP publisher settings to their modules
+void     config_apply();
+
 // Validation helpers
 int   config_clamp_fps(int fps);
 float config_clamp_alpha(float a);
 float config_clamp_offset(float o);
+float config_clamp_threshold(float t);
+int   config_clamp_batch_frames(int n);
+int   config_clamp_batch_ms(int ms);
 
 #endif
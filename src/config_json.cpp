@@ -0,0 +1,137 @@
+#include "config_json.h"
+#include <LittleFS.h>
+#include "temporal_filter.h"
+
+#define CONFIG_PATH           "/config.json"
+#define CONFIG_PATH_MIGRATED  "/config.json.bak"
+
+// ── Migration ───────────────────────────────────────
+
+bool config_migrate_json() {
+    SystemConfig& cfg = config_get();
+
+    if (!LittleFS.exists(CONFIG_PATH)) {
+        Serial.println("[Config] No config file, using defaults");
+        return false;
+    }
+
+    File f = LittleFS.open(CONFIG_PATH, "r");
+    if (!f) {
+        Serial.println("[Config] Failed to open config file");
+        return false;
+    }
+
+    DynamicJsonDocument doc(CONFIG_JSON_CAPACITY);
+    DeserializationError err = deserializeJson(doc, f);
+    f.close();
+
+    if (err) {
+        Serial.printf("[Config] Parse error: %s\n", err.c_str());
+        return false;
+    }
+
+    cfg.normal_fps        = config_clamp_fps(doc["normal_fps"] | 5);
+    cfg.idle_fps          = config_clamp_fps(doc["idle_fps"] | 1);
+    cfg.idle_timeout_sec  = constrain((int)(doc["idle_timeout_sec"] | 10), 1, 300);
+    cfg.temporal_enabled  = doc["temporal_enabled"] | false;
+    cfg.alpha             = config_clamp_alpha(doc["alpha"] | 0.3f);
+    cfg.filter_mode       = (doc["filter_mode"] | 0) == FILTER_MODE_ADAPTIVE
+                            ? FILTER_MODE_ADAPTIVE : FILTER_MODE_IIR;
+    cfg.adaptive_threshold = config_clamp_threshold(doc["adaptive_threshold"] | 2.0f);
+    cfg.calibration_offset = config_clamp_offset(doc["calibration_offset"] | 0.0f);
+    cfg.batch_frames      = config_clamp_batch_frames(doc["batch_frames"] | 10);
+    cfg.batch_max_ms      = config_clamp_batch_ms(doc["batch_max_ms"] | 5000);
+    cfg.record_enabled    = doc["record_enabled"] | false;
+    config_rois_from_json(doc["rois"], cfg);
+    config_alarms_from_json(doc["alarms"], cfg);
+    cfg.sta_enabled       = doc["sta_enabled"] | false;
+
+    strlcpy(cfg.sta_ssid,     doc["sta_ssid"] | "",     sizeof(cfg.sta_ssid));
+    strlcpy(cfg.sta_password, doc["sta_password"] | "",  sizeof(cfg.sta_password));
+
+    // Keep the JSON file until the binary record is safely written
+    if (!config_save()) return false;
+    LittleFS.rename(CONFIG_PATH, CONFIG_PATH_MIGRATED);
+    Serial.println("[Config] Migrated " CONFIG_PATH " to the binary store");
+    return true;
+}
+
+
+// ── ROI list ────────────────────────────────────────
+
+void config_rois_from_json(JsonArrayConst arr, SystemConfig& c) {
+    c.roi_count = 0;
+    memset(c.rois, 0, sizeof(c.rois));
+    for (JsonObjectConst o : arr) {
+        if (c.roi_count >= ROI_MAX) break;
+        RoiConfig& r = c.rois[c.roi_count];
+
+        if (o.containsKey("mask")) {
+            r.mask = strtoull(o["mask"] | "0", nullptr, 16);
+        } else {
+            r.mask = roi_rect_mask(o["x"] | 0, o["y"] | 0, o["w"] | 0, o["h"] | 0);
+        }
+        // An empty mask (e.g. a rectangle off the grid) keeps its slot, so
+        // later ROIs keep the index alarm rules refer to
+
+        snprintf(r.name, sizeof(r.name), "%s", o["name"] | "");
+        if (r.name[0] == '\0') snprintf(r.name, sizeof(r.name), "roi%u", c.roi_count);
+        r.threshold = constrain(o["threshold"] | 30.0f, -20.0f, 100.0f);
+        c.roi_count++;
+    }
+    roi_configure(c.rois, c.roi_count);
+}
+
+void config_rois_to_json(JsonArray arr, const SystemConfig& c) {
+    for (int i = 0; i < c.roi_count; i++) {
+        const RoiConfig& r = c.rois[i];
+        char mask[17];
+        snprintf(mask, sizeof(mask), "%08lx%08lx",
+                 (unsigned long)(r.mask >> 32), (unsigned long)(r.mask & 0xFFFFFFFFUL));
+        JsonObject o = arr.createNestedObject();
+        o["name"]      = r.name;
+        o["mask"]      = mask;
+        o["threshold"] = r.threshold;
+    }
+}
+
+// ── Alarm rules ─────────────────────────────────────
+
+void config_alarms_from_json(JsonArrayConst arr, SystemConfig& c) {
+    c.alarm_count = 0;
+    memset(c.alarms, 0, sizeof(c.alarms));
+    for (JsonObjectConst o : arr) {
+        if (c.alarm_count >= ALARM_MAX_RULES) break;
+        AlarmRule& r = c.alarms[c.alarm_count];
+
+        if (!alarm_type_from_name(o["type"] | "abs", r.type)) continue;
+        // "frame" or a ROI index
+        r.source = o["source"].is<int>()
+                 ? (uint8_t)constrain((int)o["source"], 0, ROI_MAX - 1)
+                 : ALARM_SOURCE_FRAME;
+
+        snprintf(r.name, sizeof(r.name), "%s", o["name"] | "");
+        if (r.name[0] == '\0') snprintf(r.name, sizeof(r.name), "alarm%u", c.alarm_count);
+        r.enabled     = o["enabled"] | true;
+        r.threshold   = constrain(o["threshold"] | 40.0f, -20.0f, 200.0f);
+        r.hysteresis  = constrain(o["hysteresis"] | 1.0f, 0.0f, 50.0f);
+        r.debounce_ms = (uint16_t)constrain((int)(o["debounce_ms"] | 1000), 0, 60000);
+        c.alarm_count++;
+    }
+    alarm_configure(c.alarms, c.alarm_count);
+}
+
+void config_alarms_to_json(JsonArray arr, const SystemConfig& c) {
+    for (int i = 0; i < c.alarm_count; i++) {
+        const AlarmRule& r = c.alarms[i];
+        JsonObject o = arr.createNestedObject();
+        o["name"] = r.name;
+        o["type"] = alarm_type_name(r.type);
+        if (r.source == ALARM_SOURCE_FRAME) o["source"] = "frame";
+        else                                o["source"] = r.source;
+        o["threshold"]   = r.threshold;
+        o["hysteresis"]  = r.hysteresis;
+        o["debounce_ms"] = r.debounce_ms;
+        o["enabled"]     = r.enabled;
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef CONFIG_JSON_H
+#define CONFIG_JSON_H
+
+#include <ArduinoJson.h>
+#include "config.h"
+
+// JSON for the HTTP API and the one-time migration of /config.json. Kept
+// out of config.h so the host build does not need ArduinoJson.
+
+// Full config with 4 ROIs and 8 alarm rules; on the heap, the loop stack
+// is only 4 KB
+#define CONFIG_JSON_CAPACITY  3072
+
+// Imports /config.json from older firmware into the binary store, then
+// renames it to /config.json.bak. False if there was nothing to import.
+bool config_migrate_json();
+
+// ROI list as JSON: [{"name", "mask": "<16 hex digits>", "threshold"}].
+// Mask bit i is pixel i (row-major, bit 0 = top-left). On input a
+// rectangle may be given as x/y/w/h instead of a mask. Also applies the
+// list to the ROI engine (roi_configure).
+void config_rois_from_json(JsonArrayConst arr, SystemConfig& c);
+void config_rois_to_json(JsonArray arr, const SystemConfig& c);
+
+// Alarm rules as JSON: [{"name", "type": "abs"|"delta"|"rate", "source":
+// "frame" or ROI index, "threshold", "hysteresis", "debounce_ms",
+// "enabled"}]. Also applies the rules (alarm_configure).
+void config_alarms_from_json(JsonArrayConst arr, SystemConfig& c);
+void config_alarms_to_json(JsonArray arr, const SystemConfig& c);
+
+#endif
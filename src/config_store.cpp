@@ -0,0 +1,179 @@
+#include "config_store.h"
+#include <LittleFS.h>
+#include <stddef.h>
+
+static_assert(sizeof(config_record_header_t) == 16, "config record header layout changed");
+
+struct ConfigField {
+    uint8_t  tag;
+    uint16_t offset;
+    uint16_t size;
+};
+
+#define CONFIG_FIELD(tag, member) \
+    { tag, (uint16_t)offsetof(SystemConfig, member), (uint16_t)sizeof(((SystemConfig*)0)->member) }
+
+// Tags are permanent: never reuse one, give a changed field a new tag
+static const ConfigField CONFIG_FIELDS[] = {
+    CONFIG_FIELD(1,  normal_fps),
+    CONFIG_FIELD(2,  idle_fps),
+    CONFIG_FIELD(3,  idle_timeout_sec),
+    CONFIG_FIELD(4,  temporal_enabled),
+    CONFIG_FIELD(5,  alpha),
+    CONFIG_FIELD(6,  filter_mode),
+    CONFIG_FIELD(7,  adaptive_threshold),
+    CONFIG_FIELD(8,  calibration_offset),
+    CONFIG_FIELD(9,  batch_frames),
+    CONFIG_FIELD(10, batch_max_ms),
+    CONFIG_FIELD(11, record_enabled),
+    CONFIG_FIELD(12, roi_count),
+    CONFIG_FIELD(13, rois),
+    CONFIG_FIELD(14, alarm_count),
+    CONFIG_FIELD(15, alarms),
+    CONFIG_FIELD(16, sta_enabled),
+    CONFIG_FIELD(17, sta_ssid),
+    CONFIG_FIELD(18, sta_password),
+    CONFIG_FIELD(19, udp_enabled),
+    CONFIG_FIELD(20, udp_group),
+    CONFIG_FIELD(21, udp_port),
+    CONFIG_FIELD(22, udp_every),
+};
+#define CONFIG_FIELD_COUNT  (sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]))
+
+static_assert(sizeof(config_record_header_t) + sizeof(SystemConfig) + 3 * CONFIG_FIELD_COUNT
+              <= CONFIG_STORE_MAX, "config record outgrew CONFIG_STORE_MAX");
+
+static const char* const SLOT_PATHS[2] = { CONFIG_SLOT_A, CONFIG_SLOT_B };
+
+static ConfigStoreStats stats;
+static uint8_t          record[CONFIG_STORE_MAX];
+
+// ── CRC-32 ──────────────────────────────────────────
+
+uint32_t config_crc32(uint32_t crc, const uint8_t* data, size_t len) {
+    // Bitwise: a 1 KB record once per save/boot does not justify a table
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+static uint32_t record_crc(const config_record_header_t& h, const uint8_t* fields) {
+    config_record_header_t tmp = h;
+    tmp.crc = 0;
+    uint32_t crc = config_crc32(0, (const uint8_t*)&tmp, sizeof(tmp));
+    return config_crc32(crc, fields, h.length);
+}
+
+// ── Slots ───────────────────────────────────────────
+
+// Reads and validates one slot into `record`; false if missing or corrupt
+static bool read_slot(int slot, config_record_header_t& h) {
+    File f = LittleFS.open(SLOT_PATHS[slot], "r");
+    if (!f) return false;
+    size_t n = f.read(record, sizeof(record));
+    f.close();
+
+    memset(&h, 0, sizeof(h));
+    if (n >= sizeof(h)) memcpy(&h, record, sizeof(h));
+    bool ok = n >= sizeof(h) &&
+              memcmp(h.magic, "CFG1", 4) == 0 &&
+              h.version == CONFIG_STORE_VERSION &&
+              h.length <= n - sizeof(h) &&
+              record_crc(h, record + sizeof(h)) == h.crc;
+    if (!ok) {
+        Serial.printf("[Config] Slot %c invalid\n", 'A' + slot);
+        stats.bad_records++;
+    }
+    return ok;
+}
+
+static void decode_fields(const uint8_t* p, size_t len, SystemConfig& cfg) {
+    const uint8_t* end = p + len;
+    while (end - p >= 3) {
+        uint8_t  tag  = p[0];
+        uint16_t size = (uint16_t)(p[1] | (p[2] << 8));
+        p += 3;
+        if (size > end - p) break;
+
+        for (size_t k = 0; k < CONFIG_FIELD_COUNT; k++) {
+            const ConfigField& fd = CONFIG_FIELDS[k];
+            if (fd.tag == tag && fd.size == size) {
+                memcpy((uint8_t*)&cfg + fd.offset, p, size);
+                break;
+            }
+        }
+        p += size;
+    }
+}
+
+bool config_store_load(SystemConfig& cfg) {
+    uint32_t t0 = micros();
+    config_record_header_t h[2];
+    bool valid[2] = { read_slot(0, h[0]), read_slot(1, h[1]) };
+
+    int slot = -1;
+    if (valid[0] && valid[1]) slot = (int32_t)(h[1].seq - h[0].seq) > 0 ? 1 : 0;
+    else if (valid[0])        slot = 0;
+    else if (valid[1])        slot = 1;
+
+    if (slot >= 0) {
+        // `record` may hold what was read from B
+        if (slot == 0) read_slot(0, h[0]);
+        decode_fields(record + sizeof(config_record_header_t), h[slot].length, cfg);
+        stats.seq  = h[slot].seq;
+        stats.slot = slot;
+    }
+    stats.load_us = micros() - t0;
+    return slot >= 0;
+}
+
+bool config_store_save(const SystemConfig& cfg) {
+    config_record_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "CFG1", 4);
+    h.version = CONFIG_STORE_VERSION;
+
+    uint8_t* p = record + sizeof(h);
+    for (size_t k = 0; k < CONFIG_FIELD_COUNT; k++) {
+        const ConfigField& fd = CONFIG_FIELDS[k];
+        p[0] = fd.tag;
+        p[1] = (uint8_t)(fd.size & 0xFF);
+        p[2] = (uint8_t)(fd.size >> 8);
+        memcpy(p + 3, (const uint8_t*)&cfg + fd.offset, fd.size);
+        p += 3 + fd.size;
+    }
+    h.length = (uint16_t)(p - record - sizeof(h));
+    h.seq    = stats.seq + 1;
+    h.crc    = record_crc(h, record + sizeof(h));
+    memcpy(record, &h, sizeof(h));
+
+    // Overwrite the older slot (A if nothing valid is stored); the newest
+    // stays valid until this write completes
+    uint8_t slot = (stats.seq == 0) ? 0 : 1 - stats.slot;
+    File f = LittleFS.open(SLOT_PATHS[slot], "w");
+    size_t len  = sizeof(h) + h.length;
+    bool   ok   = f && f.write(record, len) == len;
+    if (f) f.close();
+    if (!ok) {
+        Serial.printf("[Config] Write to slot %c failed\n", 'A' + slot);
+        stats.write_errors++;
+        return false;
+    }
+    stats.seq  = h.seq;
+    stats.slot = slot;
+    stats.writes++;
+    return true;
+}
+
+void config_store_erase() {
+    LittleFS.remove(CONFIG_SLOT_A);
+    LittleFS.remove(CONFIG_SLOT_B);
+    memset(&stats, 0, sizeof(stats));
+}
+
+const ConfigStoreStats& config_store_stats() {
+    return stats;
+}
@@ -0,0 +1,52 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Binary config record on LittleFS, written alternately to two slots so a
+// power loss during a write always leaves the previous generation intact.
+//
+// A record is a config_record_header_t followed by tagged fields
+// ([u8 tag][u16 len][bytes], see CONFIG_FIELDS in config_store.cpp).
+// Loading copies every known field whose length matches and skips the
+// rest, so fields can be added without invalidating stored configs; a
+// field whose layout changes gets a new tag. The CRC covers the header
+// (crc zeroed) and the fields. The valid slot with the highest seq wins.
+
+#define CONFIG_SLOT_A        "/cfg_a.bin"
+#define CONFIG_SLOT_B        "/cfg_b.bin"
+#define CONFIG_STORE_VERSION 1
+#define CONFIG_STORE_MAX     1024       // record bytes, header included
+
+struct __attribute__((packed)) config_record_header_t {
+    char     magic[4];                  // "CFG1"
+    uint8_t  version;                   // CONFIG_STORE_VERSION
+    uint8_t  reserved;
+    uint16_t length;                    // field bytes after the header
+    uint32_t seq;                       // generation, newest wins
+    uint32_t crc;                       // CRC-32 (IEEE)
+};
+
+struct ConfigStoreStats {
+    uint32_t seq;                       // generation loaded or last written
+    uint8_t  slot;                      // 0 = A, 1 = B
+    uint32_t writes;
+    uint32_t write_errors;
+    uint32_t bad_records;               // slots rejected at load (CRC, format)
+    uint32_t load_us;                   // last config_store_load()
+};
+
+// Fills the fields found in the newest valid slot; fields not stored keep
+// their value in `cfg`. False if neither slot holds a valid record.
+bool config_store_load(SystemConfig& cfg);
+
+// Writes `cfg` as the next generation into the older slot
+bool config_store_save(const SystemConfig& cfg);
+
+void config_store_erase();              // removes both slots
+const ConfigStoreStats& config_store_stats();
+
+uint32_t config_crc32(uint32_t crc, const uint8_t* data, size_t len);
+
+#endif
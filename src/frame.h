@@ -0,0 +1,24 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <Arduino.h>
+#include "pixel_format.h"
+#include "stats.h"
+#include "roi.h"
+
+// One processed frame as handed from the pipeline to the encoders.
+// Pixels are borrowed from the pipeline's static buffer.
+struct Frame {
+    uint32_t       seq;
+    uint32_t       timestamp_ms;
+    uint8_t        current_fps;
+    uint8_t        flags;              // WS_FLAG_*
+    float          calibration_offset;
+    FrameStats     stats;
+    const RoiResults* rois;            // nullptr or count 0: no ROIs configured
+    const pixel_t* pixels;             // GRID_WIDTH x GRID_HEIGHT, row-major
+    uint32_t       capture_us;         // micros() when the sensor frame was complete
+    uint32_t       processed_us;       // micros() after calibration, filter and stats
+};
+
+#endif
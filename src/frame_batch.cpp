@@ -0,0 +1,73 @@
+#include "frame_batch.h"
+#include "ws_codec.h"
+
+static ws_frame_record_t ring[BATCH_MAX_FRAMES];
+static uint8_t           head  = 0;    // index of the oldest record
+static uint8_t           count = 0;
+static uint8_t           target_frames = 10;
+static uint32_t          max_age_ms    = 5000;
+
+void batch_init() {
+    batch_clear();
+    batch_configure(10, 5000);
+}
+
+void batch_configure(uint8_t frames, uint32_t max_ms) {
+    target_frames = constrain(frames, 1, BATCH_MAX_FRAMES);
+    max_age_ms    = max_ms;
+}
+
+void batch_clear() {
+    head  = 0;
+    count = 0;
+}
+
+void batch_push(const Frame& frame) {
+    uint8_t slot;
+    if (count < BATCH_MAX_FRAMES) {
+        slot = (head + count) % BATCH_MAX_FRAMES;
+        count++;
+    } else {
+        // Nobody flushed in time; keep the newest frames
+        slot = head;
+        head = (head + 1) % BATCH_MAX_FRAMES;
+    }
+    ws_record_encode(frame, ring[slot]);
+}
+
+int batch_count() {
+    return count;
+}
+
+bool batch_due(uint32_t now_ms) {
+    return batch_next_flush_ms(now_ms) == 0;
+}
+
+uint32_t batch_next_flush_ms(uint32_t now_ms) {
+    if (count == 0) return UINT32_MAX;
+    if (count >= target_frames) return 0;
+    uint32_t age = now_ms - ring[head].timestamp_ms;
+    return age >= max_age_ms ? 0 : max_age_ms - age;
+}
+
+size_t batch_size() {
+    return sizeof(ws_batch_header_t) + count * sizeof(ws_frame_record_t);
+}
+
+size_t batch_flush(uint8_t* out, uint32_t now_ms) {
+    ws_batch_header_t* h = (ws_batch_header_t*)out;
+    h->type      = WS_PKT_BATCH;
+    h->count     = count;
+    h->first_seq = count ? ring[head].seq : 0;
+    h->sent_ms   = now_ms;
+
+    uint8_t* p = out + sizeof(ws_batch_header_t);
+    for (uint8_t i = 0; i < count; i++) {
+        memcpy(p, &ring[(head + i) % BATCH_MAX_FRAMES], sizeof(ws_frame_record_t));
+        p += sizeof(ws_frame_record_t);
+    }
+
+    size_t len = p - out;
+    batch_clear();
+    return len;
+}
@@ -0,0 +1,40 @@
+#ifndef FRAME_BATCH_H
+#define FRAME_BATCH_H
+
+#include <Arduino.h>
+#include "frame.h"
+#include "ws_protocol.h"
+
+// Fixed ring of compact frame records for WS_CHANNEL_BATCH subscribers.
+// Frames are collected until `frames` are buffered or the oldest one is
+// `max_ms` old, then sent as one message. Fewer, larger messages let the
+// radio stay idle between flushes; batch_next_flush_ms() tells a power
+// policy how long it may sleep without delaying a batch.
+
+// Ring size in records (144 B each for 8x8). The default holds the default
+// batch_frames; a larger ring only raises the settable maximum.
+#ifndef BATCH_MAX_FRAMES
+#define BATCH_MAX_FRAMES   10
+#endif
+
+#define BATCH_MAX_SIZE     (sizeof(ws_batch_header_t) + BATCH_MAX_FRAMES * sizeof(ws_frame_record_t))
+
+void     batch_init();
+void     batch_configure(uint8_t frames, uint32_t max_ms);  // clamped to the ring size
+void     batch_clear();
+void     batch_push(const Frame& frame);       // overwrites the oldest when full
+int      batch_count();
+bool     batch_due(uint32_t now_ms);           // target count reached or oldest too old
+
+// Milliseconds until the pending batch must be flushed (0 if due now,
+// UINT32_MAX if nothing is buffered).
+uint32_t batch_next_flush_ms(uint32_t now_ms);
+
+// Bytes batch_flush() will write for the records currently buffered
+size_t   batch_size();
+
+// Writes header + records (oldest first) and empties the ring.
+// `out` must hold batch_size() bytes. Returns bytes written.
+size_t   batch_flush(uint8_t* out, uint32_t now_ms);
+
+#endif
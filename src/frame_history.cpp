@@ -0,0 +1,67 @@
+#include "frame_history.h"
+#include "ws_codec.h"
+
+static ws_frame_record_t ring[HISTORY_FRAMES];
+static uint32_t          pushed = 0;   // absolute index of the next record
+
+void history_init() {
+    pushed = 0;
+}
+
+void history_push(const Frame& frame) {
+    ws_record_encode(frame, ring[pushed % HISTORY_FRAMES]);
+    pushed++;
+}
+
+int history_count() {
+    return pushed < HISTORY_FRAMES ? (int)pushed : HISTORY_FRAMES;
+}
+
+uint32_t history_begin() {
+    return pushed - history_count();
+}
+
+uint32_t history_end() {
+    return pushed;
+}
+
+const ws_frame_record_t* history_get(uint32_t index) {
+    if (index < history_begin() || index >= pushed) return nullptr;
+    return &ring[index % HISTORY_FRAMES];
+}
+
+uint32_t history_find_since(uint32_t since_ms) {
+    // Timestamps are non-decreasing along the ring; compare as signed
+    // differences so millis() wrap-around does not break the search
+    uint32_t lo = history_begin(), hi = pushed;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if ((int32_t)(history_get(mid)->timestamp_ms - since_ms) > 0) hi = mid;
+        else lo = mid + 1;
+    }
+    return lo;
+}
+
+bool history_stats(uint32_t index, HistoryStats& out) {
+    if (index < history_begin()) index = history_begin();
+    if (index >= pushed) return false;
+
+    memset(&out, 0, sizeof(out));
+    int32_t mean_sum = 0;
+    for (uint32_t i = index; i < pushed; i++) {
+        const ws_frame_record_t& r = ring[i % HISTORY_FRAMES];
+        if (out.count == 0 || r.tmin < out.tmin) out.tmin = r.tmin;
+        if (out.count == 0 || r.tmax > out.tmax) {
+            out.tmax    = r.tmax;
+            out.tmax_ms = r.timestamp_ms;
+            out.tmax_x  = r.hotspot_x;
+            out.tmax_y  = r.hotspot_y;
+        }
+        mean_sum += r.tmean;
+        out.count++;
+    }
+    out.first_ms = ring[index % HISTORY_FRAMES].timestamp_ms;
+    out.last_ms  = ring[(pushed - 1) % HISTORY_FRAMES].timestamp_ms;
+    out.tmean    = (int16_t)(mean_sum / out.count);
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef FRAME_HISTORY_H
+#define FRAME_HISTORY_H
+
+#include <Arduino.h>
+#include "frame.h"
+#include "ws_protocol.h"
+
+// RAM ring of the most recent processed frames as compact records, so a
+// client that lost its connection can fetch what it missed. Records are
+// addressed by an absolute index that keeps counting across wrap-around;
+// a reader holding an index can tell whether its record was overwritten.
+
+#ifndef HISTORY_FRAMES
+#define HISTORY_FRAMES  32     // 144 B each: ~4.6 KB, 3.2 s at 10 FPS
+#endif
+
+struct HistoryStats {
+    uint16_t count;
+    uint32_t first_ms;
+    uint32_t last_ms;
+    int16_t  tmin;             // centi-degrees, over all frames
+    int16_t  tmax;
+    int16_t  tmean;            // mean of per-frame means
+    uint32_t tmax_ms;          // when tmax was seen
+    uint8_t  tmax_x;
+    uint8_t  tmax_y;
+};
+
+void     history_init();
+void     history_push(const Frame& frame);
+int      history_count();
+
+// Absolute indices: records [history_begin(), history_end()) are held
+uint32_t history_begin();
+uint32_t history_end();
+const ws_frame_record_t* history_get(uint32_t index);   // nullptr if evicted
+
+// First held record with timestamp_ms > since_ms (history_end() if none)
+uint32_t history_find_since(uint32_t since_ms);
+
+// Rollup over the held records from `index` on; false if there are none
+bool     history_stats(uint32_t index, HistoryStats& out);
+
+#endif
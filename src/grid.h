@@ -0,0 +1,48 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <stdint.h>
+
+// Sensor array geometry as a compile-time type. Processing kernels
+// (stats.h, temporal_filter.h, pipeline_kernel.h) and wire structs
+// (ws_protocol.h) are templated on it, so buffer sizes are constexpr and
+// i % W / i / W fold to shifts or multiplies: an 8x8 build costs the same
+// as the former hard-coded loops.
+//
+// The firmware is built for one SensorGrid, selected with
+// -DSENSOR_GRID_W / -DSENSOR_GRID_H (default: AMG8833, 8x8). The host
+// benchmark instantiates the kernels for other grids as well.
+//
+// Not grid-generic: the AMG8833 driver (thermal_sensor, amg_reader), ROI
+// masks (64-bit, one bit per pixel) and the NUC blob (pixel count in a
+// byte). Each static_asserts the sizes it supports.
+
+template <int W, int H>
+struct Grid {
+    static_assert(W > 0 && H > 0 && W <= 255 && H <= 255, "hotspot coordinates are stored in a byte");
+
+    static constexpr int width  = W;
+    static constexpr int height = H;
+    static constexpr int pixels = W * H;
+
+    static constexpr int x_of(int i) { return i % W; }
+    static constexpr int y_of(int i) { return i / W; }
+};
+
+using Amg8833Grid  = Grid<8, 8>;
+using Mlx90640Grid = Grid<32, 24>;
+
+#ifndef SENSOR_GRID_W
+#define SENSOR_GRID_W  8
+#endif
+#ifndef SENSOR_GRID_H
+#define SENSOR_GRID_H  8
+#endif
+
+using SensorGrid = Grid<SENSOR_GRID_W, SENSOR_GRID_H>;
+
+constexpr int GRID_WIDTH  = SensorGrid::width;
+constexpr int GRID_HEIGHT = SensorGrid::height;
+constexpr int GRID_PIXELS = SensorGrid::pixels;
+
+#endif
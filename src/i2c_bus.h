@@ -0,0 +1,14 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+
+// Minimal I2C access used by the acquisition engine. Swappable so the
+// state machine can run against a mock bus on the host.
+struct I2CBus {
+    // Sets the register pointer, then reads `len` bytes (auto-increment).
+    // Returns the number of bytes actually read.
+    size_t (*read_regs)(uint8_t addr, uint8_t reg, uint8_t* buf, size_t len);
+};
+
+#endif
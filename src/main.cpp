@@ -2,66 +2,145 @@
 #include <LittleFS.h>
 
 #include "config.h"
+#include "config_json.h"
 #include "thermal_sensor.h"
 #include "temporal_filter.h"
 #include "stats.h"
+#include "pipeline.h"
+#include "nuc.h"
 #include "power_manager.h"
 #include "wifi_manager.h"
 #include "webserver.h"
 #include "ws_protocol.h"
+#include "scheduler.h"
+#include "metrics.h"
+#include "frame.h"
+#include "frame_history.h"
+#include "recorder.h"
+#include "trend.h"
+#include "alarm.h"
+#include "snapshot.h"
+#include "udp_publisher.h"
 
 // ── Static buffers ──────────────────────────────────
 
-static float         raw_pixels[64];
-static float         proc_pixels[64];
+static pixel_t       raw_pixels[GRID_PIXELS];
+static pixel_t       frame_pixels[GRID_PIXELS];   // processed frame, read by the encoders
 static FrameStats    frame_stats;
-static ws_payload_t  payload;
+static RoiResults    frame_rois;
+static uint32_t      frame_seq = 0;
 
-static uint32_t last_frame_ms    = 0;
-static uint32_t last_wifi_check  = 0;
+static int           task_frame = -1;
 
 // ── Processing pipeline ─────────────────────────────
 
 static void process_and_stream() {
     SystemConfig& cfg = config_get();
 
-    // 1) Read raw 8x8 frame
+    // 1) Read raw frame
     if (!sensor_read(raw_pixels)) return;
 
-    // Copy to processing buffer
-    memcpy(proc_pixels, raw_pixels, sizeof(proc_pixels));
+    // 2) Calibration, temporal filter, frame and ROI statistics in one pass
+    pipeline_process_fused(raw_pixels, frame_pixels, frame_stats, cfg, &frame_rois);
+    uint32_t processed_us = micros();
+    metrics_frame_produced();
+
+    // 3) Hand the frame to the encoders and stream it
+    Frame frame;
+    frame.seq                = frame_seq++;
+    frame.timestamp_ms       = millis();
+    frame.current_fps        = (uint8_t)power_active_fps();
+    frame.flags              = 0;
+    if (cfg.temporal_enabled)   frame.flags |= WS_FLAG_TEMPORAL_ENABLED;
+    if (power_is_idle())        frame.flags |= WS_FLAG_IDLE_ACTIVE;
+    if (wifi_sta_connected())   frame.flags |= WS_FLAG_STA_CONNECTED;
+    frame.calibration_offset = cfg.calibration_offset;
+    frame.stats              = frame_stats;
+    frame.rois               = &frame_rois;
+    frame.pixels             = frame_pixels;
+    frame.capture_us         = sensor_stats().last_frame_us;
+    frame.processed_us       = processed_us;
+
+    // 4) Alarm rules; events go out ahead of the frame
+    uint32_t t0 = metrics_now();
+    int events = alarm_evaluate(frame);
+    metrics_record(METRIC_ALARM, metrics_now() - t0);
+    if (events) webserver_push_events();
+
+    history_push(frame);
+    trend_add(frame.timestamp_ms, frame_stats);
+    if (recorder_active()) recorder_push(frame);
+    webserver_broadcast(frame);
+    udp_publish(frame, frame.timestamp_ms, wifi_sta_connected());
+}
 
-    // 2) Apply calibration offset
-    if (cfg.calibration_offset != 0.0f) {
-        for (int i = 0; i < 64; i++) {
-            proc_pixels[i] += cfg.calibration_offset;
-        }
-    }
+// ── Scheduled tasks ─────────────────────────────────
+
+static uint32_t clock_us() {
+    return micros();
+}
+
+static bool task_sensor() {
+    // Advance sensor acquisition by one I2C chunk
+    uint32_t t0 = metrics_now();
+    if (sensor_poll()) metrics_record(METRIC_SENSOR_READ, metrics_now() - t0);
+    return true;
+}
+
+static bool task_frame_tick() {
+#if STOP_SENSOR_WHEN_IDLE
+    if (power_is_idle()) return true;
+#else
+    // Always acquire, even in idle (at reduced rate)
+    if (power_client_count() == 0 && power_is_idle()) return true;
+#endif
+    // Wait for a fresh sensor frame without losing the frame deadline
+    if (!sensor_available()) return false;
+    process_and_stream();
+    return true;
+}
 
-    // 3) Apply temporal IIR filter (optional)
-    if (cfg.temporal_enabled) {
-        filter_apply(proc_pixels, cfg.alpha);
+static bool task_recorder() {
+    // Start / stop asked for by the handlers, then at most one flash block
+    if (!recorder_poll_request()) {
+        // No segment could be opened: report recording as off
+        config_get().record_enabled = false;
+        config_request_save(millis());
     }
+    recorder_poll();
+    return true;
+}
+
+static bool task_deferred() {
+    // Deferred operations (WiFi restart etc.)
+    webserver_loop();
+    return true;
+}
+
+static bool task_config() {
+    // Debounced config writes from the web handlers, and a finished NUC
+    // capture, off the frame path
+    config_poll(millis());
+    nuc_poll();
+    return true;
+}
+
+static bool task_power() {
+    power_update();
+    // Follow active/idle FPS changes; exact microsecond period avoids
+    // the truncation of 1000 / fps in milliseconds
+    sched_set_period(task_frame, 1000000UL / power_active_fps());
+    return true;
+}
+
+static bool task_wifi() {
+    wifi_update();
+    return true;
+}
 
-    // 4) Compute statistics
-    stats_compute(proc_pixels, frame_stats);
-
-    // 5) Build and stream payload
-    payload.timestamp_ms      = millis();
-    payload.current_fps       = (uint8_t)power_active_fps();
-    payload.flags             = 0;
-    if (cfg.temporal_enabled)   payload.flags |= WS_FLAG_TEMPORAL_ENABLED;
-    if (power_is_idle())        payload.flags |= WS_FLAG_IDLE_ACTIVE;
-    if (wifi_sta_connected())   payload.flags |= WS_FLAG_STA_CONNECTED;
-    payload.calibration_offset = cfg.calibration_offset;
-    payload.tmin              = frame_stats.tmin;
-    payload.tmax              = frame_stats.tmax;
-    payload.tmean             = frame_stats.tmean;
-    payload.hotspot_x         = frame_stats.hotspot_x;
-    payload.hotspot_y         = frame_stats.hotspot_y;
-    memcpy(payload.pixels, proc_pixels, sizeof(proc_pixels));
-
-    webserver_broadcast((const uint8_t*)&payload, sizeof(payload));
+static bool task_housekeeping() {
+    webserver_cleanup();
+    return true;
 }
 
 // ── Arduino setup ───────────────────────────────────
@@ -78,12 +157,22 @@ void setup() {
         Serial.println("[FS] LittleFS mounted");
     }
 
-    // Init subsystems
+    // Init subsystems (alarm rules and ROIs are installed by config_load)
+    alarm_init();
     config_init();
-    config_load();
+    if (!config_load()) config_migrate_json();   // first boot after the JSON store
     filter_init();
+    metrics_init();
+    history_init();
+    trend_init();
+    snapshot_init();
+    nuc_init();
+    nuc_load();
     power_init();
     wifi_init();
+    udp_publisher_init(wifi_udp_sink());
+    recorder_init();
+    if (config_get().record_enabled) recorder_request(true);
 
     // Init sensor
     if (!sensor_init()) {
@@ -96,45 +185,23 @@ void setup() {
 
     webserver_init();
 
+    // Period in µs, priority (0 = highest)
+    sched_init(clock_us);
+    sched_add("sensor",   task_sensor,        0,        0);  // every pass
+    task_frame = sched_add("frame", task_frame_tick, 1000000UL / power_active_fps(), 1);
+    sched_add("record",   task_recorder,      20000,    2);
+    sched_add("deferred", task_deferred,      100000,   2);
+    sched_add("config",   task_config,        500000,   5);
+    sched_add("power",    task_power,         100000,   3);
+    sched_add("wifi",     task_wifi,          5000000,  4);  // STA check every 5 s
+    sched_add("cleanup",  task_housekeeping,  1000000,  5);
+
     Serial.println("[Main] Setup complete, entering main loop");
 }
 
 // ── Arduino loop ────────────────────────────────────
 
 void loop() {
-    uint32_t now = millis();
-
-    // Handle deferred operations (WiFi restart etc.)
-    webserver_loop();
-
-    // Update power manager
-    power_update();
-
-    // Determine frame interval based on active FPS
-    int fps = power_active_fps();
-    uint32_t interval_ms = 1000 / fps;
-
-    // Frame acquisition
-    if (now - last_frame_ms >= interval_ms) {
-        last_frame_ms = now;
-
-#if STOP_SENSOR_WHEN_IDLE
-        if (!power_is_idle()) {
-            process_and_stream();
-        }
-#else
-        // Always acquire, even in idle (at reduced rate)
-        if (power_client_count() > 0 || !power_is_idle()) {
-            process_and_stream();
-        }
-#endif
-    }
-
-    // Periodic WiFi STA check (every 5 seconds)
-    if (now - last_wifi_check >= 5000) {
-        last_wifi_check = now;
-        wifi_update();
-    }
-
+    sched_run();
     yield();
 }
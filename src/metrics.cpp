@@ -0,0 +1,62 @@
+#include "metrics.h"
+
+static MetricHistogram hist[METRIC_STAGE_COUNT];
+static uint32_t        frames_produced = 0;
+
+static const char* const STAGE_NAMES[METRIC_STAGE_COUNT] = {
+    "sensor_read", "calibration", "filter", "stats", "process", "payload", "broadcast", "http", "record", "alarm", "snapshot", "control", "udp",
+};
+
+#if !defined(ESP8266)
+#include <time.h>
+
+uint32_t metrics_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec);
+}
+
+uint32_t metrics_ticks_per_us() {
+    return 1000;
+}
+#else
+uint32_t metrics_ticks_per_us() {
+    return ESP.getCpuFreqMHz();
+}
+#endif
+
+void metrics_init() {
+    memset(hist, 0, sizeof(hist));
+    for (int i = 0; i < METRIC_STAGE_COUNT; i++) hist[i].min = UINT32_MAX;
+    frames_produced = 0;
+}
+
+void metrics_record(MetricStage stage, uint32_t ticks) {
+    MetricHistogram& h = hist[stage];
+    h.count++;
+    h.sum += ticks;
+    if (ticks < h.min) h.min = ticks;
+    if (ticks > h.max) h.max = ticks;
+
+    int log2 = ticks ? 31 - __builtin_clz(ticks) : 0;
+    int b = log2 - METRICS_BUCKET_SHIFT;
+    if (b < 0) b = 0;
+    if (b >= METRICS_BUCKETS) b = METRICS_BUCKETS - 1;
+    h.buckets[b]++;
+}
+
+void metrics_frame_produced() {
+    frames_produced++;
+}
+
+const MetricHistogram& metrics_get(MetricStage stage) {
+    return hist[stage];
+}
+
+const char* metrics_stage_name(MetricStage stage) {
+    return STAGE_NAMES[stage];
+}
+
+uint32_t metrics_frames_produced() {
+    return frames_produced;
+}
@@ -0,0 +1,68 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+
+// Lightweight per-stage timing in fixed memory. Samples are CPU cycles on
+// the ESP8266 (ESP.getCycleCount) and nanoseconds on the host build.
+// Recording a sample is a handful of integer ops, far below 1% of a frame.
+
+enum MetricStage : uint8_t {
+    METRIC_SENSOR_READ,   // one I2C chunk of the acquisition state machine
+    METRIC_CALIBRATION,   // calibration / filter / stats: staged pipeline_process()
+    METRIC_FILTER,        //   only, which the device does not run
+    METRIC_STATS,
+    METRIC_PROCESS,       // fused calibration + filter + stats
+    METRIC_PAYLOAD,       // wire encodings for one frame
+    METRIC_BROADCAST,     // client fan-out, excluding encoding
+    METRIC_HTTP,          // REST handlers
+    METRIC_RECORD,        // one recorder block write to flash
+    METRIC_ALARM,         // alarm rule evaluation for one frame
+    METRIC_SNAPSHOT,      // colour-mapped image render for /api/frame.*
+    METRIC_CONTROL,       // WebSocket set-param / get-status message
+    METRIC_UDP,           // UDP datagram build + send
+    METRIC_STAGE_COUNT
+};
+
+// Bucket k holds samples in [2^(k+6), 2^(k+7)); the first and last are open.
+#define METRICS_BUCKETS      16
+#define METRICS_BUCKET_SHIFT 6
+
+struct MetricHistogram {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t buckets[METRICS_BUCKETS];
+};
+
+#if defined(ESP8266)
+static inline uint32_t metrics_now() { return ESP.getCycleCount(); }
+#else
+uint32_t metrics_now();
+#endif
+uint32_t metrics_ticks_per_us();
+
+void metrics_init();
+void metrics_record(MetricStage stage, uint32_t ticks);
+void metrics_frame_produced();
+
+// False for the stages only the staged reference path records; /api/metrics
+// leaves them out rather than export histograms that stay empty
+static inline bool metrics_stage_on_device(MetricStage stage) {
+    return stage < METRIC_CALIBRATION || stage > METRIC_STATS;
+}
+
+const MetricHistogram& metrics_get(MetricStage stage);
+const char*            metrics_stage_name(MetricStage stage);
+uint32_t               metrics_frames_produced();
+
+// Times the enclosing scope, e.g. an HTTP handler
+struct MetricScope {
+    MetricStage stage;
+    uint32_t    t0;
+    explicit MetricScope(MetricStage s) : stage(s), t0(metrics_now()) {}
+    ~MetricScope() { metrics_record(stage, metrics_now() - t0); }
+};
+
+#endif
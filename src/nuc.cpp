@@ -0,0 +1,183 @@
+#include "nuc.h"
+
+static NucMap      table;
+
+static uint8_t     cap_point = 0;      // 0 = not capturing
+static uint16_t    cap_total = 0;
+static uint16_t    cap_left  = 0;
+static pixel_sum_t cap_sum[GRID_PIXELS];
+static float       point1_mean[GRID_PIXELS];    // per-pixel raw mean of point 1, °C
+static bool        point1_valid = false;
+static bool        save_pending = false;    // capture finished, not yet on flash
+
+void nuc_init() {
+    table.active = false;
+    for (int i = 0; i < GRID_PIXELS; i++) {
+        table.gain[i]   = NUC_GAIN_ONE;
+        table.offset[i] = 0;
+    }
+    cap_point = 0;
+    point1_valid = false;
+    save_pending = false;
+}
+
+const NucMap& nuc_map() {
+    return table;
+}
+
+// ── Flat-field capture ──────────────────────────────
+
+bool nuc_capture_start(uint8_t point, uint16_t frames) {
+    if (point < 1 || point > 2) return false;
+    if (point == 2 && !point1_valid) return false;
+    if (frames < 1) frames = 1;
+    if (frames > NUC_MAX_FRAMES) frames = NUC_MAX_FRAMES;
+
+    memset(cap_sum, 0, sizeof(cap_sum));
+    cap_point = point;
+    cap_total = frames;
+    cap_left  = frames;
+    Serial.printf("[NUC] Capturing point %u over %u frames\n", point, frames);
+    return true;
+}
+
+bool nuc_capturing() {
+    return cap_point != 0;
+}
+
+uint16_t nuc_capture_remaining() {
+    return cap_left;
+}
+
+bool nuc_has_point1() {
+    return point1_valid;
+}
+
+static void capture_finish() {
+    float mean[GRID_PIXELS];
+    float frame_mean = 0.0f;
+    for (int i = 0; i < GRID_PIXELS; i++) {
+        mean[i] = pixel_to_c((pixel_t)(cap_sum[i] / cap_total));
+        frame_mean += mean[i];
+    }
+    frame_mean /= GRID_PIXELS;
+
+    float gain[GRID_PIXELS], offset[GRID_PIXELS];
+    if (cap_point == 1) {
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            gain[i]   = 1.0f;
+            offset[i] = frame_mean - mean[i];
+            point1_mean[i] = mean[i];
+        }
+        point1_valid = true;
+    } else {
+        // Two-point: map each pixel's (m1, m2) onto the frame means (M1, M2)
+        float frame_mean1 = 0.0f;
+        for (int i = 0; i < GRID_PIXELS; i++) frame_mean1 += point1_mean[i];
+        frame_mean1 /= GRID_PIXELS;
+
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            float span = mean[i] - point1_mean[i];
+            float g = (fabsf(span) > 0.5f) ? (frame_mean - frame_mean1) / span : 1.0f;
+            g = constrain(g, 0.5f, 2.0f);
+            gain[i]   = g;
+            offset[i] = frame_mean1 - g * point1_mean[i];
+        }
+    }
+
+    for (int i = 0; i < GRID_PIXELS; i++) {
+#if FIXED_POINT_PIPELINE
+        table.gain[i] = (nuc_gain_t)lroundf(gain[i] * NUC_GAIN_ONE);
+#else
+        table.gain[i] = gain[i];
+#endif
+        table.offset[i] = pixel_from_c(offset[i]);
+    }
+    table.active = true;
+
+    Serial.printf("[NUC] Point %u captured (frame mean %.2f C)\n", cap_point, frame_mean);
+    cap_point = 0;
+    // Finished inside the frame task; the flash write waits for nuc_poll()
+    save_pending = true;
+}
+
+void nuc_capture_feed(const pixel_t* raw) {
+    if (!cap_point) return;
+    for (int i = 0; i < GRID_PIXELS; i++) cap_sum[i] += raw[i];
+    if (--cap_left == 0) capture_finish();
+}
+
+bool nuc_poll() {
+    if (!save_pending) return false;
+    save_pending = false;
+    return nuc_save();
+}
+
+// ── LittleFS persistence (device only) ──────────────
+
+#if defined(ESP8266)
+#include <LittleFS.h>
+
+bool nuc_load() {
+    File f = LittleFS.open(NUC_PATH, "r");
+    if (!f) return false;
+
+    nuc_blob_header_t h;
+    int16_t gain[GRID_PIXELS], offset[GRID_PIXELS];
+    bool ok = f.read((uint8_t*)&h, sizeof(h)) == sizeof(h) &&
+              h.magic == NUC_MAGIC && h.pixels == GRID_PIXELS && h.gain_one == (1 << NUC_GAIN_Q) &&
+              f.read((uint8_t*)gain, sizeof(gain)) == sizeof(gain) &&
+              f.read((uint8_t*)offset, sizeof(offset)) == sizeof(offset);
+    f.close();
+
+    if (!ok) {
+        Serial.println("[NUC] Invalid table, ignoring");
+        return false;
+    }
+
+    for (int i = 0; i < GRID_PIXELS; i++) {
+#if FIXED_POINT_PIPELINE
+        table.gain[i] = gain[i];
+#else
+        table.gain[i] = (float)gain[i] / (1 << NUC_GAIN_Q);
+#endif
+        table.offset[i] = pixel_from_c(offset[i] * 0.01f);
+    }
+    table.active = true;
+    Serial.println("[NUC] Loaded per-pixel table");
+    return true;
+}
+
+bool nuc_save() {
+    nuc_blob_header_t h = { NUC_MAGIC, 1, GRID_PIXELS, (uint16_t)(1 << NUC_GAIN_Q) };
+    int16_t gain[GRID_PIXELS], offset[GRID_PIXELS];
+    for (int i = 0; i < GRID_PIXELS; i++) {
+#if FIXED_POINT_PIPELINE
+        gain[i] = table.gain[i];
+#else
+        gain[i] = (int16_t)lroundf(table.gain[i] * (1 << NUC_GAIN_Q));
+#endif
+        offset[i] = pixel_to_centi(table.offset[i]);
+    }
+
+    File f = LittleFS.open(NUC_PATH, "w");
+    if (!f) {
+        Serial.println("[NUC] Failed to write table");
+        return false;
+    }
+    f.write((const uint8_t*)&h, sizeof(h));
+    f.write((const uint8_t*)gain, sizeof(gain));
+    f.write((const uint8_t*)offset, sizeof(offset));
+    f.close();
+    return true;
+}
+
+void nuc_clear() {
+    nuc_init();
+    LittleFS.remove(NUC_PATH);
+}
+#else
+bool nuc_load()  { return false; }
+bool nuc_save()  { return false; }
+void nuc_clear() { nuc_init(); }
+#endif
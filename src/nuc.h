@@ -0,0 +1,69 @@
+#ifndef NUC_H
+#define NUC_H
+
+#include <Arduino.h>
+#include "pixel_format.h"
+#include "grid.h"
+
+// Per-pixel non-uniformity correction: corrected = raw * gain[i] + offset[i].
+// Applied inside pipeline_calibrate() together with the global offset, so it
+// costs no extra pass over the frame.
+//
+// Tables are captured against a uniform surface (flat field):
+//   point 1 — per-pixel offsets that flatten the frame to its mean
+//   point 2 — optional second surface temperature; adds per-pixel gain
+// and stored on LittleFS as a blob (NUC_PATH), 264 bytes for 8x8.
+
+#define NUC_PATH            "/nuc.bin"
+#define NUC_MAGIC           0x3143554E   // "NUC1"
+#define NUC_GAIN_Q          12           // stored gain is Q12
+#define NUC_DEFAULT_FRAMES  32
+#define NUC_MAX_FRAMES      255
+
+#if FIXED_POINT_PIPELINE
+typedef int16_t nuc_gain_t;              // Q12, 4096 = 1.0
+#define NUC_GAIN_ONE (1 << NUC_GAIN_Q)
+#else
+typedef float nuc_gain_t;
+#define NUC_GAIN_ONE 1.0f
+#endif
+
+struct NucMap {
+    bool       active;
+    nuc_gain_t gain[GRID_PIXELS];
+    pixel_t    offset[GRID_PIXELS];
+};
+
+struct __attribute__((packed)) nuc_blob_header_t {
+    uint32_t magic;
+    uint8_t  version;
+    uint8_t  pixels;      // GRID_PIXELS
+    uint16_t gain_one;    // 1 << NUC_GAIN_Q
+};
+// Followed by int16 gain[pixels] (Q12) and int16 offset[pixels] (centi-degrees)
+
+static_assert(GRID_PIXELS <= 255, "NUC blob stores the pixel count in a byte");
+
+static inline pixel_t nuc_apply(const NucMap& m, int i, pixel_t v) {
+#if FIXED_POINT_PIPELINE
+    return (pixel_t)((((int32_t)v * m.gain[i]) + (1 << (NUC_GAIN_Q - 1))) >> NUC_GAIN_Q) + m.offset[i];
+#else
+    return v * m.gain[i] + m.offset[i];
+#endif
+}
+
+void          nuc_init();      // identity map
+bool          nuc_load();      // from LittleFS; false if missing/invalid
+bool          nuc_save();
+bool          nuc_poll();      // writes a finished capture; true if it saved
+void          nuc_clear();     // identity map, removes the stored blob
+const NucMap& nuc_map();
+
+// Flat-field capture. Frames are fed raw (before any correction).
+bool nuc_capture_start(uint8_t point, uint16_t frames);
+bool nuc_capturing();
+void nuc_capture_feed(const pixel_t* raw);     // finishes on last frame; nuc_poll() saves
+uint16_t nuc_capture_remaining();
+bool nuc_has_point1();
+
+#endif
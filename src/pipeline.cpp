@@ -0,0 +1,95 @@
+#include "pipeline.h"
+#include "temporal_filter.h"
+#include "metrics.h"
+#include "nuc.h"
+#include "pipeline_kernel.h"
+
+void pipeline_calibrate(pixel_t* pixels, float offset) {
+    pixel_t off = pixel_from_c(offset);
+    const NucMap& nuc = nuc_map();
+
+    // Per-pixel gain/offset and the global offset in the same pass
+    if (nuc.active) {
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            pixels[i] = nuc_apply(nuc, i, pixels[i]) + off;
+        }
+        return;
+    }
+
+    if (off == 0) return;
+    for (int i = 0; i < GRID_PIXELS; i++) {
+        pixels[i] += off;
+    }
+}
+
+void pipeline_process(const pixel_t* raw, pixel_t* out, FrameStats& stats,
+                      const SystemConfig& cfg, RoiResults* rois)
+{
+    // Flat-field capture sees the uncorrected frame
+    if (nuc_capturing()) nuc_capture_feed(raw);
+
+    // Copy to processing buffer
+    memcpy(out, raw, GRID_PIXELS * sizeof(pixel_t));
+
+    // 1) Apply calibration offset
+    uint32_t t0 = metrics_now();
+    pipeline_calibrate(out, cfg.calibration_offset);
+    uint32_t t1 = metrics_now();
+    metrics_record(METRIC_CALIBRATION, t1 - t0);
+
+    // 2) Apply temporal IIR filter (optional)
+    if (cfg.temporal_enabled) {
+        filter_apply(out, filter_coeff(cfg.alpha, cfg.filter_mode, cfg.adaptive_threshold));
+        uint32_t t2 = metrics_now();
+        metrics_record(METRIC_FILTER, t2 - t1);
+        t1 = t2;
+    }
+
+    // 3) Compute statistics
+    stats_compute(out, stats);
+    if (rois) roi_compute(out, *rois);
+    metrics_record(METRIC_STATS, metrics_now() - t1);
+}
+
+// ROI accumulation only runs when a result is wanted and a mask is set
+template <bool NUC, bool FILTER, bool SEED>
+static void fused_dispatch(const pixel_t* raw, pixel_t* out, FrameStats& stats,
+                           pixel_t off, const NucMap& nuc, FilterState& fs, const filter_coeff_t& k,
+                           RoiResults* rois)
+{
+    if (rois && roi_masks().count > 0) {
+        fused_kernel<SensorGrid, pixel_t, NUC, FILTER, SEED, true>(raw, out, stats, off, &nuc, fs, k, rois);
+    } else {
+        if (rois) rois->count = 0;
+        fused_kernel<SensorGrid, pixel_t, NUC, FILTER, SEED, false>(raw, out, stats, off, &nuc, fs, k, rois);
+    }
+}
+
+void pipeline_process_fused(const pixel_t* raw, pixel_t* out, FrameStats& stats,
+                            const SystemConfig& cfg, RoiResults* rois)
+{
+    // Flat-field capture sees the uncorrected frame
+    if (nuc_capturing()) nuc_capture_feed(raw);
+
+    uint32_t t0 = metrics_now();
+
+    const pixel_t        off = pixel_from_c(cfg.calibration_offset);
+    const NucMap&        nuc = nuc_map();
+    FilterState&         fs  = filter_state();
+    const filter_coeff_t k   = filter_coeff(cfg.alpha, cfg.filter_mode,
+                                            cfg.adaptive_threshold);
+
+    if (!cfg.temporal_enabled) {
+        if (nuc.active) fused_dispatch<true,  false, false>(raw, out, stats, off, nuc, fs, k, rois);
+        else            fused_dispatch<false, false, false>(raw, out, stats, off, nuc, fs, k, rois);
+    } else if (!fs.primed) {
+        if (nuc.active) fused_dispatch<true,  true,  true>(raw, out, stats, off, nuc, fs, k, rois);
+        else            fused_dispatch<false, true,  true>(raw, out, stats, off, nuc, fs, k, rois);
+        fs.primed = true;
+    } else {
+        if (nuc.active) fused_dispatch<true,  true,  false>(raw, out, stats, off, nuc, fs, k, rois);
+        else            fused_dispatch<false, true,  false>(raw, out, stats, off, nuc, fs, k, rois);
+    }
+
+    metrics_record(METRIC_PROCESS, metrics_now() - t0);
+}
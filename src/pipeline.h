@@ -0,0 +1,30 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <Arduino.h>
+#include "pixel_format.h"
+#include "stats.h"
+#include "config.h"
+#include "roi.h"
+
+// Frame processing independent of sensor and network, so it also builds on
+// the host (see env:native).
+
+// Per-pixel NUC (if loaded) and the global offset, fused in one pass
+void pipeline_calibrate(pixel_t* pixels, float offset);
+
+// Staged path: copy raw -> out, calibration offset, temporal filter
+// (if enabled), statistics. Each stage is timed into metrics. If `rois`
+// is given, per-ROI statistics for the configured masks (roi_configure)
+// are computed alongside the frame statistics.
+void pipeline_process(const pixel_t* raw, pixel_t* out, FrameStats& stats,
+                      const SystemConfig& cfg, RoiResults* rois = nullptr);
+
+// Fused path: calibration, temporal filter and statistics in a single
+// traversal, writing each pixel once into `out` (the buffer the encoders
+// read). Bit-identical to pipeline_process(). The kernel itself is in
+// pipeline_kernel.h.
+void pipeline_process_fused(const pixel_t* raw, pixel_t* out, FrameStats& stats,
+                            const SystemConfig& cfg, RoiResults* rois = nullptr);
+
+#endif
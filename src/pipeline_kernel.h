@@ -0,0 +1,86 @@
+#ifndef PIPELINE_KERNEL_H
+#define PIPELINE_KERNEL_H
+
+#include "pixel_format.h"
+#include "grid.h"
+#include "stats.h"
+#include "temporal_filter.h"
+#include "nuc.h"
+#include "roi.h"
+#include <type_traits>
+
+// Single-pass frame kernel: calibration, temporal filter and statistics
+// (and ROI statistics) per pixel, writing each pixel once into `out`.
+//
+// Templated on the grid, the pixel type and the per-frame switches, so the
+// inner loop has no mode branches and a constexpr trip count. NUC tables
+// and ROI masks exist for the build's SensorGrid / pixel_t only; other
+// instantiations (host benchmark) must leave NUC and ROI off.
+
+template <class G, class P, bool NUC, bool FILTER, bool SEED, bool ROI>
+static inline void fused_kernel(const P* raw, P* out, FrameStatsT<P>& stats, P off,
+                                const NucMap* nuc, FilterStateT<G, P>& fs,
+                                const typename FilterMath<P>::Coeff& k, RoiResults* rois)
+{
+    static_assert(!(NUC || ROI) ||
+                  (std::is_same<G, SensorGrid>::value && std::is_same<P, pixel_t>::value),
+                  "NUC and ROI tables are sized for SensorGrid / pixel_t");
+
+    P   mn = 0, mx = 0;
+    typename PixelTraits<P>::sum_t sum = 0;
+    int max_idx = 0;
+
+    RoiAccum        acc;
+    const RoiMasks* masks = nullptr;
+    if constexpr (ROI) {
+        masks = &roi_masks();
+        roi_accum_init(acc);
+    }
+
+    // Same per-pixel operation order as the staged path
+    for (int i = 0; i < G::pixels; i++) {
+        P v = raw[i];
+
+        if constexpr (NUC) v = nuc_apply(*nuc, i, v) + off;
+        else if (off != 0) v += off;
+
+        if constexpr (FILTER) {
+            if (SEED) filter_seed(fs, i, v);   // first frame passes through
+            else      v = filter_step(fs, i, v, k);
+        }
+
+        out[i] = v;
+
+        if (i == 0) { mn = v; mx = v; }
+        sum += v;
+        if (v < mn) mn = v;
+        if (v > mx) {
+            mx = v;
+            max_idx = i;
+        }
+
+        if constexpr (ROI) roi_accum_pixel(acc, *masks, i, v);
+    }
+
+    stats_finish_t<G, P>(mn, mx, sum, max_idx, stats);
+    if constexpr (ROI) roi_finish(acc, *masks, *rois);
+}
+
+// Offset, optional temporal filter and statistics for any grid and pixel
+// type; the mode switch happens once per frame
+template <class G, class P>
+static inline void pipeline_run_t(const P* raw, P* out, FrameStatsT<P>& stats, P off,
+                                  FilterStateT<G, P>& fs, const typename FilterMath<P>::Coeff& k,
+                                  bool temporal)
+{
+    if (!temporal) {
+        fused_kernel<G, P, false, false, false, false>(raw, out, stats, off, nullptr, fs, k, nullptr);
+    } else if (!fs.primed) {
+        fused_kernel<G, P, false, true,  true,  false>(raw, out, stats, off, nullptr, fs, k, nullptr);
+        fs.primed = true;
+    } else {
+        fused_kernel<G, P, false, true,  false, false>(raw, out, stats, off, nullptr, fs, k, nullptr);
+    }
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef PIXEL_FORMAT_H
+#define PIXEL_FORMAT_H
+
+#include <stdint.h>
+#include <math.h>
+
+// Pixel representation used by the processing pipeline, chosen at build time.
+//
+//   FIXED_POINT_PIPELINE=0  float °C (default, matches the Adafruit driver)
+//   FIXED_POINT_PIPELINE=1  int16 centi-degrees (0.01 °C), no soft-float per pixel
+//
+// The AMG8833 reports 12-bit two's complement values with a 0.25 °C LSB,
+// so one raw count is exactly 25 centi-degrees.
+
+#ifndef FIXED_POINT_PIPELINE
+#define FIXED_POINT_PIPELINE 0
+#endif
+
+#define PIXEL_CENTI_PER_RAW  25
+
+// Both representations, for kernels templated on the pixel type. The
+// build's pixel_t below picks one of them.
+template <class P> struct PixelTraits;
+
+template <> struct PixelTraits<int16_t> {   // centi-degrees C
+    typedef int32_t sum_t;                  // frame sums: 768 px x 32767 still fits
+
+    static inline int16_t from_c(float c)     { return (int16_t)lroundf(c * 100.0f); }
+    static inline float   to_c(int16_t p)     { return (float)p * 0.01f; }
+    static inline int16_t from_raw(int16_t r) { return (int16_t)(r * PIXEL_CENTI_PER_RAW); }
+    static inline int16_t to_centi(int16_t p) { return p; }
+
+    // Round to nearest; plain division would bias negative means downward
+    static inline int16_t mean(int32_t sum, int n) {
+        return (int16_t)((sum + (sum >= 0 ? n / 2 : -n / 2)) / n);
+    }
+};
+
+template <> struct PixelTraits<float> {     // degrees C
+    typedef float sum_t;
+
+    static inline float   from_c(float c)     { return c; }
+    static inline float   to_c(float p)       { return p; }
+    static inline float   from_raw(int16_t r) { return (float)r * 0.25f; }
+    static inline int16_t to_centi(float p)   { return (int16_t)lroundf(p * 100.0f); }
+
+    static inline float   mean(float sum, int n) { return sum / (float)n; }
+};
+
+#if FIXED_POINT_PIPELINE
+typedef int16_t pixel_t;      // centi-degrees C
+#else
+typedef float pixel_t;        // degrees C
+#endif
+
+typedef PixelTraits<pixel_t>::sum_t pixel_sum_t;
+
+static inline pixel_t pixel_from_c(float c)      { return PixelTraits<pixel_t>::from_c(c); }
+static inline float   pixel_to_c(pixel_t p)      { return PixelTraits<pixel_t>::to_c(p); }
+static inline pixel_t pixel_from_raw(int16_t r)  { return PixelTraits<pixel_t>::from_raw(r); }
+static inline int16_t pixel_to_centi(pixel_t p)  { return PixelTraits<pixel_t>::to_centi(p); }
+
+#endif
@@ -26,12 +26,16 @@ void power_client_disconnected() {
 }
 
 void power_update() {
-    if (client_count > 0) {
+    SystemConfig& cfg = config_get();
+
+    // UDP receivers are not counted: an enabled publisher keeps the camera
+    // active, and the idle timeout starts when it is turned off
+    if (client_count > 0 || cfg.udp_enabled) {
         idle_active = false;
+        if (client_count == 0) last_client_disconnect_ms = millis();
         return;
     }
 
-    SystemConfig& cfg = config_get();
     uint32_t elapsed = millis() - last_client_disconnect_ms;
 
     if (elapsed >= (uint32_t)(cfg.idle_timeout_sec * 1000)) {
@@ -0,0 +1,404 @@
+#include "recorder.h"
+#include "ws_codec.h"
+#include "metrics.h"
+#include <LittleFS.h>
+
+// The recorder encoder has no extension trailers enabled
+static_assert(WS_V2_PIXELS_MAX_SIZE <= 255, "v2 frame no longer fits the u8 length prefix");
+static_assert(REC_SEGMENT_BYTES % REC_PAGE_SIZE == 0, "segments must be whole pages");
+
+#define REC_RING_SIZE  (REC_BUF_PAGES * REC_PAGE_SIZE)
+
+struct PendingIndex {
+    rec_index_entry_t entry;
+    uint16_t          seg;
+    uint32_t          pos;       // absolute stream position of the keyframe
+};
+
+static WsV2Encoder   enc;
+static RecorderStats stats;
+static bool          active   = false;
+static bool          stopping = false;
+
+// Start / stop from recorder_request(), applied by recorder_poll_request()
+static bool          start_requested = false;
+static bool          stop_requested  = false;
+
+// RAM ring between push (encoder side) and poll (flash side). Positions
+// are absolute byte counts of the recorded stream; ring index = pos % size.
+static uint8_t  ring[REC_RING_SIZE];
+static uint32_t push_pos  = 0;
+static uint32_t write_pos = 0;
+
+// Encoder side
+static uint16_t push_seg       = 0;
+static uint32_t push_seg_start = 0;
+static bool     need_header    = false;
+
+// Flash side
+static uint16_t write_seg       = 0;
+static uint32_t write_seg_start = 0;
+static File     data_file;
+static File     index_file;
+
+// The encoder side has started a new segment the writer has not reached
+static bool     break_pending = false;
+static uint32_t break_pos     = 0;
+
+static PendingIndex index_pending[REC_INDEX_PENDING];
+static int          index_count = 0;
+
+// Segments on flash: [seg_first, seg_next)
+static uint16_t seg_first = 0;
+static uint16_t seg_next  = 0;
+
+// ── Paths ───────────────────────────────────────────
+
+static void seg_path(char* out, size_t len, uint16_t id, const char* ext) {
+    snprintf(out, len, REC_DIR "/%05u.%s", id, ext);
+}
+
+static void remove_segment(uint16_t id) {
+    char path[32];
+    seg_path(path, sizeof(path), id, "seg");
+    LittleFS.remove(path);
+    seg_path(path, sizeof(path), id, "idx");
+    LittleFS.remove(path);
+}
+
+// ── Flash side ──────────────────────────────────────
+
+static bool open_segment(uint16_t id) {
+    char path[32];
+    seg_path(path, sizeof(path), id, "seg");
+    data_file = LittleFS.open(path, "w");
+    seg_path(path, sizeof(path), id, "idx");
+    index_file = LittleFS.open(path, "w");
+    if (!data_file || !index_file) {
+        Serial.printf("[Rec] Cannot create segment %u\n", id);
+        stats.write_errors++;
+        return false;
+    }
+
+    write_seg = id;
+    if ((int16_t)(id - seg_next) >= 0) seg_next = id + 1;
+    while ((uint16_t)(seg_next - seg_first) > REC_MAX_SEGMENTS) {
+        remove_segment(seg_first++);
+    }
+    return true;
+}
+
+// Writes index entries whose keyframes are already on flash. Entries are
+// grouped so the index file sees few small appends.
+static void flush_index(bool force) {
+    int ready = 0;
+    while (ready < index_count &&
+           index_pending[ready].seg == write_seg &&
+           (int32_t)(write_pos - index_pending[ready].pos) > 0) {
+        ready++;
+    }
+    if (ready == 0 || (!force && ready < REC_INDEX_BATCH)) return;
+
+    rec_index_entry_t block[REC_INDEX_PENDING];
+    for (int i = 0; i < ready; i++) block[i] = index_pending[i].entry;
+    if (index_file) index_file.write((const uint8_t*)block, ready * sizeof(rec_index_entry_t));
+
+    memmove(index_pending, index_pending + ready, (index_count - ready) * sizeof(PendingIndex));
+    index_count -= ready;
+}
+
+static void close_segment() {
+    flush_index(true);
+    data_file.close();
+    index_file.close();
+}
+
+static void write_block(uint32_t n) {
+    uint32_t t0  = metrics_now();
+    uint32_t us0 = micros();
+
+    uint32_t at    = write_pos % REC_RING_SIZE;
+    uint32_t first = (at + n <= REC_RING_SIZE) ? n : REC_RING_SIZE - at;
+    size_t   done  = data_file.write(ring + at, first);
+    if (first < n) done += data_file.write(ring, n - first);
+    if (done != n) stats.write_errors++;
+
+    uint32_t us = micros() - us0;
+    if (us > stats.max_write_us) stats.max_write_us = us;
+    metrics_record(METRIC_RECORD, metrics_now() - t0);
+
+    write_pos += n;
+    stats.bytes_written += n;
+    stats.pages_written++;
+}
+
+bool recorder_poll() {
+    if (!data_file) return false;
+
+    if (break_pending && write_pos == break_pos) {
+        close_segment();
+        write_seg_start = break_pos;
+        break_pending   = false;
+        stats.segments_rotated++;
+        if (!open_segment(write_seg + 1)) {
+            active = false;
+            return false;
+        }
+    }
+
+    // Blocks are page-aligned within the segment file. Partial blocks are
+    // only written to end a segment or on stop.
+    uint32_t limit = break_pending ? break_pos : push_pos;
+    uint32_t avail = limit - write_pos;
+    uint32_t room  = REC_PAGE_SIZE - (write_pos - write_seg_start) % REC_PAGE_SIZE;
+    bool     tail  = break_pending || stopping;
+
+    if (avail == 0 || (avail < room && !tail)) {
+        flush_index(false);
+        return false;
+    }
+
+    write_block(avail < room ? avail : room);
+    flush_index(false);
+    return true;
+}
+
+// ── Encoder side ────────────────────────────────────
+
+static void ring_put(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        ring[(push_pos + i) % REC_RING_SIZE] = data[i];
+    }
+    push_pos += len;
+}
+
+bool recorder_push(const Frame& frame) {
+    if (!active) return false;
+
+    // Start the next segment once a worst-case frame no longer fits
+    if (!need_header && !break_pending &&
+        push_pos - push_seg_start + 1 + WS_V2_PIXELS_MAX_SIZE > REC_SEGMENT_BYTES) {
+        break_pending  = true;
+        break_pos      = push_pos;
+        push_seg_start = push_pos;
+        push_seg++;
+        need_header    = true;
+    }
+    if (need_header) enc.primed = false;   // every segment starts with a keyframe
+
+    uint8_t buf[1 + WS_V2_PIXELS_MAX_SIZE];
+    size_t  len  = ws_v2_encode(enc, frame, buf + 1);
+    size_t  need = 1 + len + (need_header ? sizeof(rec_segment_header_t) : 0);
+    buf[0] = (uint8_t)len;
+
+    if (push_pos + need - write_pos > REC_RING_SIZE) {
+        // Flash is behind; the next frame must not be a delta on this one
+        enc.primed = false;
+        stats.dropped++;
+        return false;
+    }
+
+    if (need_header) {
+        rec_segment_header_t h;
+        memcpy(h.magic, "REC1", 4);
+        h.format  = WS_FORMAT_V2;
+        h.quant   = enc.quant;
+        h.segment = push_seg;
+        ring_put((const uint8_t*)&h, sizeof(h));
+        need_header = false;
+    }
+
+    if (((const ws_v2_header_t*)(buf + 1))->kind == WS_V2_KEYFRAME && index_count < REC_INDEX_PENDING) {
+        PendingIndex& p = index_pending[index_count++];
+        p.entry.timestamp_ms = frame.timestamp_ms;
+        p.entry.offset       = push_pos - push_seg_start;
+        p.seg                = push_seg;
+        p.pos                = push_pos;
+    }
+
+    ring_put(buf, 1 + len);
+    stats.frames++;
+    return true;
+}
+
+// ── Control ─────────────────────────────────────────
+
+void recorder_init() {
+    memset(&stats, 0, sizeof(stats));
+    active = false;
+    start_requested = stop_requested = false;
+    LittleFS.mkdir(REC_DIR);
+
+    // Segment ids are consecutive; find the range left by earlier runs
+    bool found = false;
+    uint16_t lo = 0, hi = 0;
+    Dir dir = LittleFS.openDir(REC_DIR);
+    while (dir.next()) {
+        auto        name = dir.fileName();
+        const char* dot  = strrchr(name.c_str(), '.');
+        if (!dot || strcmp(dot, ".seg") != 0) continue;
+        uint16_t id = (uint16_t)atoi(name.c_str());
+        if (!found || id < lo) lo = id;
+        if (!found || id > hi) hi = id;
+        found = true;
+    }
+    seg_first = found ? lo : 0;
+    seg_next  = found ? hi + 1 : 0;
+    Serial.printf("[Rec] %u segments on flash\n", (unsigned)(seg_next - seg_first));
+}
+
+bool recorder_start() {
+    if (active) return true;
+
+    ws_v2_encoder_init(enc, WS_QUANT_I16);
+    push_pos = write_pos = 0;
+    push_seg_start = write_seg_start = 0;
+    break_pending = false;
+    stopping      = false;
+    index_count   = 0;
+    need_header   = true;
+    push_seg      = seg_next;
+
+    if (!open_segment(push_seg)) {
+        stats.start_failures++;
+        return false;
+    }
+    active = true;
+    Serial.printf("[Rec] Recording to segment %u\n", push_seg);
+    return true;
+}
+
+void recorder_stop() {
+    if (!active) return;
+    active   = false;
+    stopping = true;
+    while (recorder_poll()) {}
+    close_segment();
+    stopping = false;
+    Serial.printf("[Rec] Stopped after %u frames\n", stats.frames);
+}
+
+bool recorder_active() {
+    return active;
+}
+
+void recorder_request(bool on) {
+    start_requested = on;
+    stop_requested  = !on;
+}
+
+bool recorder_poll_request() {
+    bool ok = true;
+    if (start_requested)     ok = recorder_start();
+    else if (stop_requested) recorder_stop();
+    start_requested = stop_requested = false;
+    return ok;
+}
+
+const RecorderStats& recorder_stats() {
+    return stats;
+}
+
+// ── Read side ───────────────────────────────────────
+
+int recorder_segment_count() {
+    return (uint16_t)(seg_next - seg_first);
+}
+
+bool recorder_segment_info(int i, RecSegmentInfo& out) {
+    if (i < 0 || i >= recorder_segment_count()) return false;
+    char path[32];
+    memset(&out, 0, sizeof(out));
+    out.id = seg_first + i;
+
+    seg_path(path, sizeof(path), out.id, "seg");
+    File f = LittleFS.open(path, "r");
+    if (!f) return false;
+    out.bytes = f.size();
+    f.close();
+
+    seg_path(path, sizeof(path), out.id, "idx");
+    f = LittleFS.open(path, "r");
+    if (f && f.size() >= sizeof(rec_index_entry_t)) {
+        rec_index_entry_t e;
+        f.read((uint8_t*)&e, sizeof(e));
+        out.first_ms = e.timestamp_ms;
+        f.seek(f.size() - sizeof(e));
+        f.read((uint8_t*)&e, sizeof(e));
+        out.last_key_ms = e.timestamp_ms;
+    }
+    f.close();
+    return true;
+}
+
+bool recorder_seek(uint32_t from_ms, uint32_t to_ms, RecCursor& cur) {
+    bool have_end = false, any = false;
+    char path[32];
+
+    for (uint16_t id = seg_first; id != seg_next && !have_end; id++) {
+        seg_path(path, sizeof(path), id, "idx");
+        File f = LittleFS.open(path, "r");
+        if (!f) continue;
+
+        rec_index_entry_t block[32];
+        size_t n;
+        while (!have_end && (n = f.read((uint8_t*)block, sizeof(block)) / sizeof(rec_index_entry_t)) > 0) {
+            for (size_t k = 0; k < n; k++) {
+                const rec_index_entry_t& e = block[k];
+                if (!any) {
+                    // Range starts before the recording: begin at the first keyframe
+                    cur.seg = id;
+                    cur.offset = e.offset;
+                    any = true;
+                }
+                if (e.timestamp_ms <= from_ms) {
+                    cur.seg = id;
+                    cur.offset = e.offset;
+                } else if (e.timestamp_ms > to_ms) {
+                    cur.end_seg = id;
+                    cur.end_offset = e.offset;
+                    have_end = true;
+                    break;
+                }
+            }
+        }
+        f.close();
+    }
+
+    if (!any) return false;
+    if (!have_end) {
+        cur.end_seg    = seg_next - 1;
+        cur.end_offset = UINT32_MAX;
+    }
+    return true;
+}
+
+size_t recorder_read(RecCursor& cur, uint8_t* buf, size_t max_len) {
+    char path[32];
+
+    while ((int16_t)(cur.end_seg - cur.seg) >= 0) {
+        seg_path(path, sizeof(path), cur.seg, "seg");
+        File f = LittleFS.open(path, "r");
+        uint32_t size = f ? f.size() : 0;
+        uint32_t end  = (cur.seg == cur.end_seg && cur.end_offset < size) ? cur.end_offset : size;
+
+        if (cur.offset < sizeof(rec_segment_header_t)) cur.offset = sizeof(rec_segment_header_t);
+        if (cur.offset >= end) {
+            // Segment done (or rotated away): continue with the next one
+            f.close();
+            if (cur.seg == cur.end_seg) break;
+            cur.seg++;
+            cur.offset = 0;
+            continue;
+        }
+
+        size_t n = end - cur.offset;
+        if (n > max_len) n = max_len;
+        f.seek(cur.offset);
+        n = f.read(buf, n);
+        f.close();
+        cur.offset += n;
+        return n;
+    }
+    return 0;
+}
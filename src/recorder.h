@@ -0,0 +1,98 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <Arduino.h>
+#include "frame.h"
+#include "ws_protocol.h"
+
+// Persistent frame recorder on LittleFS.
+//
+// Frames are compressed with their own v2 encoder (int16, lossless) and
+// appended to numbered segment files under REC_DIR. Each segment holds a
+// rec_segment_header_t followed by length-prefixed v2 frames ([u8 len]
+// [len bytes]), and starts with a keyframe. A sidecar index file lists
+// (timestamp, offset) for every keyframe, so a time range is found by
+// reading a few index entries and seeking, not by scanning frames.
+//
+// recorder_push() only encodes into a RAM ring. recorder_poll(), run from
+// the scheduler, writes at most one REC_PAGE_SIZE block per call, so flash
+// sees page-sized appends and loop() never stalls on more than one page.
+// When the oldest segment would exceed REC_MAX_SEGMENTS it is deleted.
+//
+// Timestamps are device millis(); a reboot or restart starts a new segment.
+
+#define REC_DIR              "/rec"
+#define REC_PAGE_SIZE        256
+#define REC_BUF_PAGES        4          // RAM ring: 1 KB
+#define REC_SEGMENT_BYTES    (64 * 1024)
+#define REC_MAX_SEGMENTS     8
+#define REC_INDEX_PENDING    16         // keyframe entries held before writing
+#define REC_INDEX_BATCH      8          // write index entries in groups of this many
+
+struct __attribute__((packed)) rec_segment_header_t {
+    char     magic[4];                  // "REC1"
+    uint8_t  format;                    // WS_FORMAT_V2
+    uint8_t  quant;                     // WS_QUANT_I16
+    uint16_t segment;
+};
+
+struct __attribute__((packed)) rec_index_entry_t {
+    uint32_t timestamp_ms;
+    uint32_t offset;                    // byte offset of the keyframe's length prefix
+};
+
+struct RecorderStats {
+    uint32_t frames;
+    uint32_t dropped;                   // ring full: flash could not keep up
+    uint32_t bytes_written;
+    uint32_t pages_written;
+    uint32_t segments_rotated;
+    uint32_t write_errors;
+    uint32_t start_failures;            // a segment could not be opened
+    uint32_t max_write_us;              // slowest single block write
+};
+
+struct RecSegmentInfo {
+    uint16_t id;
+    uint32_t bytes;
+    uint32_t first_ms;                  // first keyframe, 0 if none indexed yet
+    uint32_t last_key_ms;               // last indexed keyframe
+};
+
+// Stream position for recorder_read(): [seg:offset, end_seg:end_offset)
+struct RecCursor {
+    uint16_t seg;
+    uint32_t offset;
+    uint16_t end_seg;
+    uint32_t end_offset;                // UINT32_MAX = to the end of end_seg
+};
+
+void recorder_init();                   // scans REC_DIR for existing segments
+bool recorder_start();                  // opens a new segment
+void recorder_stop();                   // flushes everything and closes
+bool recorder_active();
+
+// Web and WebSocket handlers run in the async TCP callbacks and must not
+// open or drain segments there. They call recorder_request(); the record
+// task carries it out with recorder_poll_request(), which returns false
+// if a requested start failed.
+void recorder_request(bool on);
+bool recorder_poll_request();
+
+bool recorder_push(const Frame& frame); // false if dropped
+bool recorder_poll();                   // true if a block was written
+
+int  recorder_segment_count();
+bool recorder_segment_info(int i, RecSegmentInfo& out);   // 0 = oldest
+
+// Finds the keyframe at or before from_ms and the first keyframe after
+// to_ms. Returns false if nothing is recorded.
+bool   recorder_seek(uint32_t from_ms, uint32_t to_ms, RecCursor& cur);
+
+// Copies the next bytes of length-prefixed v2 frames (segment headers are
+// skipped). Returns 0 at the end of the range.
+size_t recorder_read(RecCursor& cur, uint8_t* buf, size_t max_len);
+
+const RecorderStats& recorder_stats();
+
+#endif
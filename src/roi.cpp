@@ -0,0 +1,73 @@
+#include "roi.h"
+
+static RoiMasks masks;
+
+void roi_configure(const RoiConfig* rois, uint8_t count) {
+    // Slot r stays ROI r, so results line up with the config (and with
+    // alarm sources); an empty mask just never collects a pixel
+    memset(&masks, 0, sizeof(masks));
+    masks.count = count < ROI_MAX ? count : ROI_MAX;
+    for (uint8_t r = 0; r < masks.count; r++) {
+        masks.threshold[r] = pixel_from_c(rois[r].threshold);
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            if (rois[r].mask & (1ULL << i)) masks.pixel_rois[i] |= 1 << r;
+        }
+    }
+}
+
+const RoiMasks& roi_masks() {
+    return masks;
+}
+
+static uint16_t centroid_q8(roi_weight_t wsum, roi_weight_t w) {
+#if FIXED_POINT_PIPELINE
+    return (uint16_t)((wsum * 256 + w / 2) / w);
+#else
+    return (uint16_t)lroundf(wsum / w * 256.0f);
+#endif
+}
+
+void roi_finish(const RoiAccum& a, const RoiMasks& m, RoiResults& out) {
+    out.count = m.count;
+    for (int r = 0; r < m.count; r++) {
+        RoiStats& s = out.roi[r];
+        if (!a.n[r]) {
+            memset(&s, 0, sizeof(s));      // empty slot: pixels == 0
+            continue;
+        }
+        s.pixels = a.n[r];
+        s.above  = a.above[r];
+        s.tmin   = a.mn[r];
+        s.tmax   = a.mx[r];
+#if FIXED_POINT_PIPELINE
+        s.tmean  = (pixel_t)((a.sum[r] + (a.sum[r] >= 0 ? a.n[r] / 2 : -a.n[r] / 2)) / a.n[r]);
+#else
+        s.tmean  = a.sum[r] / a.n[r];
+#endif
+        if (a.above[r] && a.w[r] > 0) {
+            s.cx_q8 = centroid_q8(a.wx[r], a.w[r]);
+            s.cy_q8 = centroid_q8(a.wy[r], a.w[r]);
+        } else {
+            // Nothing above threshold: fall back to the hottest pixel
+            s.cx_q8 = SensorGrid::x_of(a.max_idx[r]) << 8;
+            s.cy_q8 = SensorGrid::y_of(a.max_idx[r]) << 8;
+        }
+    }
+}
+
+void roi_compute(const pixel_t* pixels, RoiResults& out) {
+    RoiAccum a;
+    roi_accum_init(a);
+    for (int i = 0; i < GRID_PIXELS; i++) roi_accum_pixel(a, masks, i, pixels[i]);
+    roi_finish(a, masks, out);
+}
+
+uint64_t roi_rect_mask(int x, int y, int w, int h) {
+    uint64_t m = 0;
+    for (int yy = y; yy < y + h; yy++) {
+        for (int xx = x; xx < x + w; xx++) {
+            if (xx >= 0 && xx < GRID_WIDTH && yy >= 0 && yy < GRID_HEIGHT) m |= 1ULL << (yy * GRID_WIDTH + xx);
+        }
+    }
+    return m;
+}
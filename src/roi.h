@@ -0,0 +1,110 @@
+#ifndef ROI_H
+#define ROI_H
+
+#include <Arduino.h>
+#include "pixel_format.h"
+#include "grid.h"
+
+// Region-of-interest statistics. Each ROI is a 64-bit pixel mask (bit i =
+// pixel i, row-major) with its own threshold. Masks are turned into a
+// per-pixel ROI membership byte once per configuration change, so the
+// per-frame work is one lookup per pixel plus the ROIs that pixel is in.
+// The accumulation helpers are inline and shared with the fused kernel,
+// so staged and fused paths give identical results.
+
+#define ROI_MAX          4
+#define ROI_NAME_LEN     16
+
+static_assert(GRID_PIXELS <= 64, "ROI masks hold one bit per pixel in a uint64_t");
+
+struct RoiConfig {
+    char     name[ROI_NAME_LEN];
+    uint64_t mask;
+    float    threshold;       // °C, for area-above and the centroid
+};
+
+struct RoiStats {
+    pixel_t  tmin;
+    pixel_t  tmax;
+    pixel_t  tmean;
+    uint8_t  pixels;          // pixels in the ROI, 0 = empty slot
+    uint8_t  above;           // pixels above threshold
+    uint16_t cx_q8;           // heat centroid, pixel coordinates * 256
+    uint16_t cy_q8;
+};
+
+struct RoiResults {
+    uint8_t  count;
+    RoiStats roi[ROI_MAX];
+};
+
+struct RoiMasks {
+    uint8_t  count;
+    uint8_t  pixel_rois[GRID_PIXELS];  // bit r set if the pixel is in ROI r
+    pixel_t  threshold[ROI_MAX];
+};
+
+#if FIXED_POINT_PIPELINE
+typedef int32_t roi_weight_t;   // centi-degrees above threshold
+#define ROI_PIXEL_MIN  INT16_MIN
+#define ROI_PIXEL_MAX  INT16_MAX
+#else
+typedef float   roi_weight_t;
+#define ROI_PIXEL_MIN  (-INFINITY)
+#define ROI_PIXEL_MAX  INFINITY
+#endif
+
+struct RoiAccum {
+    pixel_t      mn[ROI_MAX];
+    pixel_t      mx[ROI_MAX];
+    pixel_sum_t  sum[ROI_MAX];
+    uint8_t      n[ROI_MAX];
+    uint8_t      above[ROI_MAX];
+    uint8_t      max_idx[ROI_MAX];
+    roi_weight_t w[ROI_MAX];
+    roi_weight_t wx[ROI_MAX];
+    roi_weight_t wy[ROI_MAX];
+};
+
+static inline void roi_accum_init(RoiAccum& a) {
+    memset(&a, 0, sizeof(a));
+    for (int r = 0; r < ROI_MAX; r++) {
+        a.mn[r] = ROI_PIXEL_MAX;
+        a.mx[r] = ROI_PIXEL_MIN;
+    }
+}
+
+static inline void roi_accum_pixel(RoiAccum& a, const RoiMasks& m, int i, pixel_t v) {
+    for (uint8_t bits = m.pixel_rois[i]; bits; bits &= bits - 1) {
+        int r = __builtin_ctz(bits);
+        if (v < a.mn[r]) a.mn[r] = v;
+        if (v > a.mx[r]) {
+            a.mx[r] = v;
+            a.max_idx[r] = i;
+        }
+        a.sum[r] += v;
+        a.n[r]++;
+        if (v > m.threshold[r]) {
+            // Heat above threshold weights the centroid
+            roi_weight_t w = (roi_weight_t)(v - m.threshold[r]);
+            a.above[r]++;
+            a.w[r]  += w;
+            a.wx[r] += w * SensorGrid::x_of(i);
+            a.wy[r] += w * SensorGrid::y_of(i);
+        }
+    }
+}
+
+void roi_finish(const RoiAccum& a, const RoiMasks& m, RoiResults& out);
+
+// Rebuilds the masks from the configured ROIs. Result r is always ROI r;
+// an empty mask gives an empty slot (pixels == 0, all other fields 0).
+void roi_configure(const RoiConfig* rois, uint8_t count);
+const RoiMasks& roi_masks();
+
+// Staged path: one pass over a processed frame
+void roi_compute(const pixel_t* pixels, RoiResults& out);
+
+uint64_t roi_rect_mask(int x, int y, int w, int h);
+
+#endif
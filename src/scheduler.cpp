@@ -0,0 +1,106 @@
+#include "scheduler.h"
+
+struct SchedTask {
+    const char*    name;
+    SchedTaskFn    fn;
+    uint32_t       period_us;   // 0 = every pass
+    uint32_t       next_us;     // absolute deadline
+    uint8_t        priority;
+    SchedTaskStats stats;
+};
+
+static SchedTask    tasks[SCHED_MAX_TASKS];
+static uint8_t      order[SCHED_MAX_TASKS];  // task indices by priority
+static int          task_count = 0;
+static SchedClockFn clock_fn   = nullptr;
+
+void sched_init(SchedClockFn clock) {
+    clock_fn   = clock;
+    task_count = 0;
+    memset(tasks, 0, sizeof(tasks));
+}
+
+int sched_add(const char* name, SchedTaskFn fn, uint32_t period_us, uint8_t priority) {
+    if (task_count >= SCHED_MAX_TASKS || !clock_fn) return -1;
+
+    int id = task_count++;
+    SchedTask& t = tasks[id];
+    memset(&t, 0, sizeof(t));
+    t.name      = name;
+    t.fn        = fn;
+    t.period_us = period_us;
+    t.next_us   = clock_fn();
+    t.priority  = priority;
+
+    // Keep the run order sorted by priority so sched_run() is a single scan
+    int pos = id;
+    while (pos > 0 && tasks[order[pos - 1]].priority > priority) {
+        order[pos] = order[pos - 1];
+        pos--;
+    }
+    order[pos] = (uint8_t)id;
+    return id;
+}
+
+void sched_set_period(int task, uint32_t period_us) {
+    if (task < 0 || task >= task_count || !clock_fn) return;
+    SchedTask& t = tasks[task];
+    if (t.period_us == period_us) return;
+
+    // Re-phase from the last deadline, so a 1 FPS -> 10 FPS switch takes
+    // effect within 100 ms instead of after the rest of the idle second
+    uint32_t last = t.next_us - t.period_us;
+    t.period_us = period_us;
+    t.next_us   = last + period_us;
+    uint32_t now = clock_fn();
+    if ((int32_t)(now - t.next_us) > 0) t.next_us = now;   // due now, not an overrun
+}
+
+void sched_run() {
+    if (!clock_fn) return;
+
+    for (int i = 0; i < task_count; i++) {
+        SchedTask& t = tasks[order[i]];
+        uint32_t now = clock_fn();
+        int32_t  late = (int32_t)(now - t.next_us);
+        if (late < 0) continue;
+
+        if (!t.fn()) continue;  // not ready — stays due
+
+        uint32_t end = clock_fn();
+        uint32_t run = end - now;
+        t.stats.runs++;
+        t.stats.sum_jitter_us += (uint32_t)late;
+        if ((uint32_t)late > t.stats.max_jitter_us) t.stats.max_jitter_us = late;
+        if (run > t.stats.max_run_us)               t.stats.max_run_us = run;
+
+        if (t.period_us == 0) {
+            t.next_us = end;
+            continue;
+        }
+
+        // Advance on the original grid; skip deadlines that already passed
+        t.next_us += t.period_us;
+        while ((int32_t)(end - t.next_us) >= 0) {
+            t.next_us += t.period_us;
+            t.stats.overruns++;
+        }
+    }
+}
+
+int sched_task_count() {
+    return task_count;
+}
+
+const char* sched_task_name(int task) {
+    return (task >= 0 && task < task_count) ? tasks[task].name : "";
+}
+
+uint32_t sched_task_period(int task) {
+    return (task >= 0 && task < task_count) ? tasks[task].period_us : 0;
+}
+
+const SchedTaskStats& sched_task_stats(int task) {
+    static const SchedTaskStats empty = {};
+    return (task >= 0 && task < task_count) ? tasks[task].stats : empty;
+}
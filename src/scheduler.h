@@ -0,0 +1,37 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+// Fixed-capacity cooperative scheduler with absolute deadlines.
+// Each task's next deadline advances by exactly its period, so rates do not
+// drift with loop latency. Due tasks run in priority order (0 = highest).
+
+#define SCHED_MAX_TASKS  8
+
+// Returns false if the task could not do its work yet (e.g. no fresh sensor
+// frame); it stays due and is retried on the next pass without losing phase.
+typedef bool     (*SchedTaskFn)();
+typedef uint32_t (*SchedClockFn)();   // microseconds, free-running
+
+struct SchedTaskStats {
+    uint32_t runs;
+    uint32_t overruns;        // whole periods skipped because the task ran late
+    uint32_t max_jitter_us;   // lateness of a run vs. its deadline
+    uint32_t sum_jitter_us;
+    uint32_t max_run_us;
+};
+
+void sched_init(SchedClockFn clock);
+int  sched_add(const char* name, SchedTaskFn fn, uint32_t period_us, uint8_t priority);  // -1 if full
+// Next deadline becomes the last one plus the new period (now, if that has
+// already passed); no-op if the period is unchanged
+void sched_set_period(int task, uint32_t period_us);
+void sched_run();                                     // call from loop()
+
+int                   sched_task_count();
+const char*           sched_task_name(int task);
+uint32_t              sched_task_period(int task);
+const SchedTaskStats& sched_task_stats(int task);
+
+#endif
@@ -0,0 +1,328 @@
+#include "snapshot.h"
+#include "config_store.h"
+#include "metrics.h"
+
+// Ironbow stops, identical to buildIronbow() in app.js
+struct PaletteStop { float t; uint8_t r, g, b; };
+static const PaletteStop PALETTE_STOPS[] = {
+    { 0.00f,   0,   0,   0 },
+    { 0.10f,  32,   0,  64 },
+    { 0.25f,  96,   0, 128 },
+    { 0.40f, 192,   0,  64 },
+    { 0.50f, 220,  40,   0 },
+    { 0.60f, 255, 100,   0 },
+    { 0.70f, 255, 160,   0 },
+    { 0.80f, 255, 220,  40 },
+    { 0.90f, 255, 255, 128 },
+    { 1.00f, 255, 255, 255 },
+};
+static const int PALETTE_STOP_COUNT = sizeof(PALETTE_STOPS) / sizeof(PALETTE_STOPS[0]);
+
+static uint8_t  palette[256][3];
+static uint32_t plte_crc;
+
+// Rendered index image for one (frame, params) key
+static struct {
+    bool           valid;
+    uint32_t       timestamp_ms;
+    uint16_t       seq;
+    SnapshotParams params;
+    bool           png_ready;                   // sums below computed
+    uint32_t       idat_crc;
+    uint32_t       adler;
+    uint8_t        img[SNAPSHOT_MAX_PIXELS];
+} cache;
+
+static SnapshotStats stats;
+
+// ── File layout ─────────────────────────────────────
+
+#define BMP_HEADER_SIZE   54
+#define BMP_PALETTE_SIZE  1024
+#define BMP_PIXELS_OFF    (BMP_HEADER_SIZE + BMP_PALETTE_SIZE)
+
+#define PNG_SIG_SIZE      8
+#define PNG_IHDR_OFF      PNG_SIG_SIZE
+#define PNG_PLTE_OFF      (PNG_IHDR_OFF + 12 + 13)
+#define PNG_IDAT_OFF      (PNG_PLTE_OFF + 12 + 768)
+#define PNG_ZHEAD_SIZE    7                     // zlib header + stored block header
+#define PNG_IEND_SIZE     12
+
+static const uint8_t PNG_SIG[PNG_SIG_SIZE] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+static const uint8_t PNG_IEND[PNG_IEND_SIZE] = { 0, 0, 0, 0, 'I', 'E', 'N', 'D', 0xAE, 0x42, 0x60, 0x82 };
+
+// One filter byte per row
+static uint32_t png_raw_size(const SnapshotStream& s)  { return (uint32_t)s.height * (s.width + 1); }
+static uint32_t png_zlib_size(const SnapshotStream& s) { return PNG_ZHEAD_SIZE + png_raw_size(s) + 4; }
+
+// BMP rows are padded to 4 bytes
+static uint32_t bmp_stride(const SnapshotStream& s)    { return (s.width + 3u) & ~3u; }
+
+static uint8_t be32_byte(uint32_t v, int i) { return (uint8_t)(v >> (24 - 8 * i)); }
+static uint8_t le32_byte(uint32_t v, int i) { return (uint8_t)(v >> (8 * i)); }
+
+// ── Rendering ───────────────────────────────────────
+
+void snapshot_palette(uint8_t i, uint8_t rgb[3]) {
+    memcpy(rgb, palette[i], 3);
+}
+
+void snapshot_init() {
+    for (int i = 0; i < 256; i++) {
+        float t = i / 255.0f;
+        const PaletteStop* lo = &PALETTE_STOPS[0];
+        const PaletteStop* hi = &PALETTE_STOPS[PALETTE_STOP_COUNT - 1];
+        for (int s = 0; s < PALETTE_STOP_COUNT - 1; s++) {
+            if (t >= PALETTE_STOPS[s].t && t <= PALETTE_STOPS[s + 1].t) {
+                lo = &PALETTE_STOPS[s];
+                hi = &PALETTE_STOPS[s + 1];
+                break;
+            }
+        }
+        float f = hi->t == lo->t ? 0.0f : (t - lo->t) / (hi->t - lo->t);
+        palette[i][0] = (uint8_t)floorf(lo->r + f * (hi->r - lo->r) + 0.5f);
+        palette[i][1] = (uint8_t)floorf(lo->g + f * (hi->g - lo->g) + 0.5f);
+        palette[i][2] = (uint8_t)floorf(lo->b + f * (hi->b - lo->b) + 0.5f);
+    }
+    plte_crc = config_crc32(0, (const uint8_t*)"PLTE", 4);
+    plte_crc = config_crc32(plte_crc, &palette[0][0], sizeof(palette));
+
+    cache.valid = false;
+    memset(&stats, 0, sizeof(stats));
+}
+
+void snapshot_params_resolve(const ws_frame_record_t& src, SnapshotParams& p) {
+    p.scale = constrain(p.scale, 1, SNAPSHOT_MAX_SCALE);
+    if (p.auto_range) {
+        p.lo = src.tmin;
+        p.hi = src.tmax;
+    }
+    if (p.hi <= p.lo) p.hi = p.lo + 1;
+}
+
+// Centi-degrees in Q8 -> palette index, rounded like app.js
+static uint8_t to_index(int32_t v_q8, const SnapshotParams& p) {
+    int32_t num = v_q8 - ((int32_t)p.lo << 8);
+    int32_t den = ((int32_t)p.hi - p.lo) << 8;
+    if (num <= 0)   return 0;
+    if (num >= den) return 255;
+    return (uint8_t)((num * 255 + den / 2) / den);
+}
+
+// Source position of output column/row x in Q8, pixel centres aligned
+static int32_t source_q8(int x, int scale, int size) {
+    int32_t s = ((2 * x + 1) * 128) / scale - 128;
+    return constrain(s, 0, (size - 1) * 256);
+}
+
+static uint8_t render_pixel(const ws_frame_record_t& src, const SnapshotParams& p, int x, int y) {
+    if (!p.bilinear || p.scale == 1) {
+        return to_index((int32_t)src.pixels[(y / p.scale) * GRID_WIDTH + x / p.scale] << 8, p);
+    }
+    int32_t sx = source_q8(x, p.scale, GRID_WIDTH), sy = source_q8(y, p.scale, GRID_HEIGHT);
+    int x0 = sx >> 8, y0 = sy >> 8;
+    int x1 = x0 < GRID_WIDTH - 1 ? x0 + 1 : x0, y1 = y0 < GRID_HEIGHT - 1 ? y0 + 1 : y0;
+    int32_t wx = sx & 0xFF, wy = sy & 0xFF;
+
+    // Q8 after each axis; the sensor range keeps this well inside int32
+    int32_t top = src.pixels[y0 * GRID_WIDTH + x0] * (256 - wx) + src.pixels[y0 * GRID_WIDTH + x1] * wx;
+    int32_t bot = src.pixels[y1 * GRID_WIDTH + x0] * (256 - wx) + src.pixels[y1 * GRID_WIDTH + x1] * wx;
+    return to_index((top * (256 - wy) + bot * wy) >> 8, p);
+}
+
+static bool cache_matches(const ws_frame_record_t& src, const SnapshotParams& p) {
+    return cache.valid && cache.timestamp_ms == src.timestamp_ms && cache.seq == src.seq &&
+           cache.params.scale == p.scale && cache.params.bilinear == p.bilinear &&
+           cache.params.lo == p.lo && cache.params.hi == p.hi;
+}
+
+static uint8_t pixel_at(const SnapshotStream& s, int x, int y) {
+    if (cache_matches(s.src, s.params)) return cache.img[y * s.width + x];
+    stats.stale_pixels++;
+    return render_pixel(s.src, s.params, x, y);
+}
+
+// ── PNG ─────────────────────────────────────────────
+
+// Byte k of the zlib stream inside IDAT
+static uint8_t png_zlib_byte(const SnapshotStream& s, uint32_t k) {
+    const uint32_t raw = png_raw_size(s);
+    if (k < PNG_ZHEAD_SIZE) {
+        switch (k) {
+            case 0: return 0x78;                // deflate, 32 KB window
+            case 1: return 0x01;                // no preset dict, fastest; (0x7801 % 31 == 0)
+            case 2: return 0x01;                // final stored block
+            case 3: return (uint8_t)raw;
+            case 4: return (uint8_t)(raw >> 8);
+            case 5: return (uint8_t)~raw;
+            default: return (uint8_t)(~raw >> 8);
+        }
+    }
+    k -= PNG_ZHEAD_SIZE;
+    if (k < raw) {
+        uint32_t y = k / (s.width + 1), x = k % (s.width + 1);
+        return x == 0 ? 0 : pixel_at(s, x - 1, y);   // filter type 0 (None)
+    }
+    return be32_byte(s.adler, k - raw);
+}
+
+static void png_sums(const SnapshotStream& s, uint32_t& idat_crc, uint32_t& adler) {
+    // Adler-32 of the raw scanlines, then CRC-32 of "IDAT" + zlib stream
+    uint32_t a = 1, b = 0;
+    for (int y = 0; y < s.height; y++) {
+        b = (b + a) % 65521;                    // filter byte 0
+        for (int x = 0; x < s.width; x++) {
+            a = (a + pixel_at(s, x, y)) % 65521;
+            b = (b + a) % 65521;
+        }
+    }
+    adler = (b << 16) | a;
+
+    SnapshotStream tmp = s;
+    tmp.adler = adler;
+    uint32_t crc = config_crc32(0, (const uint8_t*)"IDAT", 4);
+    uint8_t  chunk[64];
+    const uint32_t zlen = png_zlib_size(s);
+    for (uint32_t k = 0; k < zlen; ) {
+        size_t n = 0;
+        while (n < sizeof(chunk) && k < zlen) chunk[n++] = png_zlib_byte(tmp, k++);
+        crc = config_crc32(crc, chunk, n);
+    }
+    idat_crc = crc;
+}
+
+static uint8_t png_ihdr_field(const SnapshotStream& s, uint32_t k) {
+    // "IHDR", width, height, depth 8, colour type 3 (palette), 0, 0, 0
+    if (k < 4)  return "IHDR"[k];
+    if (k < 8)  return be32_byte(s.width, k - 4);
+    if (k < 12) return be32_byte(s.height, k - 8);
+    if (k == 12) return 8;
+    if (k == 13) return 3;
+    return 0;
+}
+
+static uint8_t png_byte(const SnapshotStream& s, uint32_t off) {
+    if (off < PNG_IHDR_OFF) return PNG_SIG[off];
+
+    if (off < PNG_PLTE_OFF) {
+        uint32_t k = off - PNG_IHDR_OFF;
+        if (k < 4)  return be32_byte(13, k);
+        if (k < 21) return png_ihdr_field(s, k - 4);
+        uint8_t body[17];
+        for (int i = 0; i < 17; i++) body[i] = png_ihdr_field(s, i);
+        return be32_byte(config_crc32(0, body, sizeof(body)), k - 21);
+    }
+
+    if (off < PNG_IDAT_OFF) {
+        uint32_t k = off - PNG_PLTE_OFF;
+        if (k < 4)   return be32_byte(768, k);
+        if (k < 8)   return "PLTE"[k - 4];
+        if (k < 776) return palette[(k - 8) / 3][(k - 8) % 3];
+        return be32_byte(plte_crc, k - 776);
+    }
+
+    const uint32_t zlen = png_zlib_size(s);
+    uint32_t k = off - PNG_IDAT_OFF;
+    if (k < 4)         return be32_byte(zlen, k);
+    if (k < 8)         return "IDAT"[k - 4];
+    if (k < 8 + zlen)  return png_zlib_byte(s, k - 8);
+    if (k < 12 + zlen) return be32_byte(s.idat_crc, k - 8 - zlen);
+    return PNG_IEND[k - 12 - zlen];
+}
+
+// ── BMP ─────────────────────────────────────────────
+
+static uint8_t bmp_byte(const SnapshotStream& s, uint32_t off) {
+    if (off < BMP_HEADER_SIZE) {
+        // BITMAPFILEHEADER + BITMAPINFOHEADER, 8 bpp, bottom-up
+        const uint32_t image = bmp_stride(s) * s.height;
+        if (off < 2)  return "BM"[off];
+        if (off < 6)  return le32_byte(s.length, off - 2);
+        if (off < 10) return 0;
+        if (off < 14) return le32_byte(BMP_PIXELS_OFF, off - 10);
+        if (off < 18) return le32_byte(40, off - 14);
+        if (off < 22) return le32_byte(s.width, off - 18);
+        if (off < 26) return le32_byte(s.height, off - 22);
+        if (off == 26) return 1;                // planes
+        if (off == 28) return 8;                // bits per pixel
+        if (off >= 34 && off < 38) return le32_byte(image, off - 34);
+        if (off >= 38 && off < 46) return le32_byte(2835, (off - 38) % 4);   // 72 dpi
+        if (off >= 46 && off < 50) return le32_byte(256, off - 46);          // colours used
+        return 0;
+    }
+    if (off < BMP_PIXELS_OFF) {
+        uint32_t k = off - BMP_HEADER_SIZE;
+        uint8_t  c = k % 4;
+        return c == 3 ? 0 : palette[k / 4][2 - c];   // B, G, R, 0
+    }
+    uint32_t k = off - BMP_PIXELS_OFF, stride = bmp_stride(s);
+    uint32_t x = k % stride;
+    return x < s.width ? pixel_at(s, x, s.height - 1 - k / stride) : 0;
+}
+
+// ── Streams ─────────────────────────────────────────
+
+void snapshot_begin(const ws_frame_record_t& src, uint8_t format,
+                    const SnapshotParams& params, SnapshotStream& s)
+{
+    stats.requests++;
+    s.src    = src;
+    s.params = params;
+    snapshot_params_resolve(src, s.params);
+    s.format = format == SNAPSHOT_PNG ? SNAPSHOT_PNG : SNAPSHOT_BMP;
+    s.width  = GRID_WIDTH * s.params.scale;
+    s.height = GRID_HEIGHT * s.params.scale;
+    s.length = s.format == SNAPSHOT_PNG
+        ? PNG_IDAT_OFF + 12 + png_zlib_size(s) + PNG_IEND_SIZE
+        : BMP_PIXELS_OFF + bmp_stride(s) * s.height;
+
+    if (cache_matches(src, s.params)) {
+        stats.cache_hits++;
+    } else {
+        uint32_t t0 = metrics_now();
+        for (int y = 0; y < s.height; y++) {
+            for (int x = 0; x < s.width; x++) cache.img[y * s.width + x] = render_pixel(src, s.params, x, y);
+        }
+        cache.valid        = true;
+        cache.timestamp_ms = src.timestamp_ms;
+        cache.seq          = src.seq;
+        cache.params       = s.params;
+        cache.png_ready    = false;
+        stats.renders++;
+        metrics_record(METRIC_SNAPSHOT, metrics_now() - t0);
+    }
+
+    if (s.format == SNAPSHOT_PNG) {
+        if (!cache.png_ready) {
+            png_sums(s, cache.idat_crc, cache.adler);
+            cache.png_ready = true;
+        }
+        s.idat_crc = cache.idat_crc;
+        s.adler    = cache.adler;
+    } else {
+        s.idat_crc = 0;
+        s.adler    = 0;
+    }
+}
+
+size_t snapshot_read(const SnapshotStream& s, size_t index, uint8_t* buf, size_t max_len) {
+    size_t n = 0;
+    if (s.format == SNAPSHOT_PNG) {
+        while (n < max_len && index + n < s.length) { buf[n] = png_byte(s, index + n); n++; }
+    } else {
+        while (n < max_len && index + n < s.length) { buf[n] = bmp_byte(s, index + n); n++; }
+    }
+    return n;
+}
+
+const char* snapshot_content_type(uint8_t format) {
+    return format == SNAPSHOT_PNG ? "image/png" : "image/bmp";
+}
+
+const char* snapshot_extension(uint8_t format) {
+    return format == SNAPSHOT_PNG ? "png" : "bmp";
+}
+
+const SnapshotStats& snapshot_stats() {
+    return stats;
+}
@@ -0,0 +1,90 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <Arduino.h>
+#include "ws_protocol.h"
+#include "grid.h"
+
+// Still images of a frame for clients that poll over plain HTTP
+// (/api/frame.bmp, /api/frame.png).
+//
+// A frame record is colour-mapped through the 256-entry ironbow palette of
+// the web UI, optionally upscaled (nearest or fixed-point bilinear), into a
+// static 8-bit index image. That image is cached for one (frame, params)
+// key, so any number of pollers within a frame interval cost one render.
+// Files are 8-bit palette images: BMP rows are copied from the cache;
+// PNG uses stored (uncompressed) deflate blocks, so only CRC-32 and
+// Adler-32 are computed, once per cached image.
+//
+// A response holds a SnapshotStream and reads the file through
+// snapshot_read() chunk by chunk; no file is ever assembled in memory. If
+// a newer frame replaces the cache while a response is still being sent,
+// the remaining pixels are rendered from the stream's own copy of the
+// record, so the file stays consistent.
+
+// Render cache bytes. The default allows 32x32 for 8x8, the default scale;
+// -DSNAPSHOT_MAX_PIXELS=4096 allows 64x64 for another 3 KB of RAM.
+#ifndef SNAPSHOT_MAX_PIXELS
+#define SNAPSHOT_MAX_PIXELS     (32 * 32)
+#endif
+
+// Largest scale (at most 8) whose image fits the cache: 4 for 8x8
+constexpr int snapshot_max_scale() {
+    int s = 8;
+    while (s > 1 && GRID_PIXELS * s * s > SNAPSHOT_MAX_PIXELS) s--;
+    return s;
+}
+constexpr int SNAPSHOT_MAX_SCALE     = snapshot_max_scale();
+constexpr int SNAPSHOT_DEFAULT_SCALE = SNAPSHOT_MAX_SCALE < 4 ? SNAPSHOT_MAX_SCALE : 4;
+
+enum SnapshotFormat : uint8_t {
+    SNAPSHOT_BMP = 0,
+    SNAPSHOT_PNG,
+};
+
+struct SnapshotParams {
+    uint8_t scale;                              // 1..SNAPSHOT_MAX_SCALE
+    bool    bilinear;                           // else nearest
+    bool    auto_range;                         // frame tmin..tmax
+    int16_t lo;                                 // centi-degrees, if !auto_range
+    int16_t hi;
+};
+
+struct SnapshotStream {
+    ws_frame_record_t src;                      // frame being sent
+    SnapshotParams    params;                   // range resolved
+    uint8_t           format;
+    uint16_t          width;                    // GRID_WIDTH * scale
+    uint16_t          height;
+    uint32_t          length;                   // file bytes
+    uint32_t          idat_crc;                 // PNG only
+    uint32_t          adler;
+};
+
+struct SnapshotStats {
+    uint32_t requests;
+    uint32_t renders;                           // cache (re)builds
+    uint32_t cache_hits;
+    uint32_t stale_pixels;                      // rendered outside the cache
+};
+
+void snapshot_init();
+
+// Clamps scale and resolves an automatic or empty range for `src`
+void snapshot_params_resolve(const ws_frame_record_t& src, SnapshotParams& p);
+
+// Prepares a response for `src`, rendering the cache if needed
+void   snapshot_begin(const ws_frame_record_t& src, uint8_t format,
+                      const SnapshotParams& params, SnapshotStream& s);
+// Copies file bytes [index, index + max_len); returns the count, 0 at the end
+size_t snapshot_read(const SnapshotStream& s, size_t index, uint8_t* buf, size_t max_len);
+
+const char* snapshot_content_type(uint8_t format);
+const char* snapshot_extension(uint8_t format);
+
+// Ironbow colour for index i, as in app.js
+void snapshot_palette(uint8_t i, uint8_t rgb[3]);
+
+const SnapshotStats& snapshot_stats();
+
+#endif
@@ -2,15 +2,60 @@
 #define STATS_H
 
 #include <Arduino.h>
+#include "pixel_format.h"
+#include "grid.h"
 
-struct FrameStats {
-    float   tmin;
-    float   tmax;
-    float   tmean;
-    uint8_t hotspot_x;  // 0-7
-    uint8_t hotspot_y;  // 0-7
+template <class P>
+struct FrameStatsT {
+    P       tmin;
+    P       tmax;
+    P       tmean;
+    uint8_t hotspot_x;  // 0 .. width - 1
+    uint8_t hotspot_y;  // 0 .. height - 1
 };
 
-void stats_compute(const float* pixels64, FrameStats& out);
+typedef FrameStatsT<pixel_t> FrameStats;
+
+// Completes FrameStats from a single-pass accumulation. Shared with the
+// fused kernel so both paths produce identical results.
+template <class G, class P>
+static inline void stats_finish_t(P mn, P mx, typename PixelTraits<P>::sum_t sum, int max_idx,
+                                  FrameStatsT<P>& out)
+{
+    out.tmin      = mn;
+    out.tmax      = mx;
+    out.tmean     = PixelTraits<P>::mean(sum, G::pixels);
+    out.hotspot_x = G::x_of(max_idx);
+    out.hotspot_y = G::y_of(max_idx);
+}
+
+template <class G, class P>
+static inline void stats_compute_t(const P* pixels, FrameStatsT<P>& out) {
+    P   mn  = pixels[0];
+    P   mx  = pixels[0];
+    typename PixelTraits<P>::sum_t sum = 0;
+    int max_idx = 0;
+
+    for (int i = 0; i < G::pixels; i++) {
+        P v = pixels[i];
+        sum += v;
+        if (v < mn) mn = v;
+        if (v > mx) {
+            mx = v;
+            max_idx = i;
+        }
+    }
+
+    stats_finish_t<G, P>(mn, mx, sum, max_idx, out);
+}
+
+// The build's grid and pixel type
+static inline void stats_finish(pixel_t mn, pixel_t mx, pixel_sum_t sum, int max_idx,
+                                FrameStats& out)
+{
+    stats_finish_t<SensorGrid, pixel_t>(mn, mx, sum, max_idx, out);
+}
+
+void stats_compute(const pixel_t* pixels, FrameStats& out);
 
 #endif
@@ -1,29 +1,19 @@
 #include "temporal_filter.h"
 
-static float prev[64];
-static bool  primed = false;
+static FilterState state;
 
 void filter_init() {
     filter_reset();
 }
 
 void filter_reset() {
-    memset(prev, 0, sizeof(prev));
-    primed = false;
+    memset(&state, 0, sizeof(state));
 }
 
-void filter_apply(float* pixels64, float alpha) {
-    if (!primed) {
-        // First frame: seed the filter
-        memcpy(prev, pixels64, sizeof(prev));
-        primed = true;
-        return;
-    }
+FilterState& filter_state() {
+    return state;
+}
 
-    // IIR: y[n] = alpha * x[n] + (1 - alpha) * y[n-1]
-    float one_minus_alpha = 1.0f - alpha;
-    for (int i = 0; i < 64; i++) {
-        prev[i] = alpha * pixels64[i] + one_minus_alpha * prev[i];
-        pixels64[i] = prev[i];
-    }
+void filter_apply(pixel_t* pixels, const filter_coeff_t& k) {
+    filter_apply_t(state, pixels, k);
 }
@@ -2,9 +2,150 @@
 #define TEMPORAL_FILTER_H
 
 #include <Arduino.h>
+#include "pixel_format.h"
+#include "grid.h"
+
+#define FILTER_MODE_IIR       0   // fixed alpha for every pixel
+#define FILTER_MODE_ADAPTIVE  1   // alpha rises with |x - y|, snaps at threshold
+
+// Adaptive mode: a pixel whose change since the last output is d uses
+//   alpha_eff = alpha + (1 - alpha) * min(d / threshold, 1)^2
+// so sensor noise (d well below threshold) is smoothed at close to `alpha`
+// while a change of `threshold` or more passes straight through. Needs no
+// per-pixel state beyond the IIR's own.
+
+// Per-pixel filter arithmetic for each pixel type
+template <class P> struct FilterMath;
+
+template <> struct FilterMath<int16_t> {
+    // Centi-degrees << 8 so small per-frame steps are not lost to rounding
+    // when alpha is low
+    typedef int32_t state_t;
+
+    struct Coeff {
+        int32_t a;          // alpha in Q8
+        bool    adaptive;
+        int32_t thr;        // threshold, centi-degrees
+        int32_t inv_thr;    // 65536 / thr
+    };
+
+    static inline Coeff coeff(float alpha, uint8_t mode, float threshold) {
+        Coeff c;
+        c.a        = (int32_t)(alpha * 256.0f + 0.5f);
+        c.adaptive = (mode == FILTER_MODE_ADAPTIVE);
+        int32_t thr = (int32_t)(threshold * 100.0f + 0.5f);
+        c.thr      = thr > 0 ? thr : 1;
+        c.inv_thr  = 65536 / c.thr;
+        return c;
+    }
+
+    static inline void seed(state_t& y, int16_t x) {
+        y = (int32_t)x << 8;
+    }
+
+    // IIR in Q8: y += a * (x - y). Every product is int32 and rounded to
+    // nearest; a plain >> 8 floors, which leaves a falling pixel one
+    // centi-degree above where it settles. a * diff stays in range for
+    // |x - y| up to 327 °C.
+    static inline int16_t step(state_t& y, int16_t x, const Coeff& c) {
+        int32_t xq   = (int32_t)x << 8;
+        int32_t diff = xq - y;
+        int32_t a    = c.a;
+        if (c.adaptive) {
+            int32_t d = ((diff < 0 ? -diff : diff) + 128) >> 8;    // centi-degrees
+            if (d >= c.thr) {
+                a = 256;
+            } else {
+                int32_t r  = (d * c.inv_thr + 128) >> 8;           // d / thr in Q8, < 65536
+                int32_t r2 = (r * r + 128) >> 8;
+                a += ((256 - a) * r2 + 128) >> 8;
+            }
+        }
+        if (a >= 256) y = xq;
+        else          y += (a * diff + 128) >> 8;
+        return (int16_t)((y + 128) >> 8);
+    }
+};
+
+template <> struct FilterMath<float> {
+    typedef float state_t;
+
+    struct Coeff {
+        float alpha;
+        float one_minus_alpha;
+        bool  adaptive;
+        float inv_thr;      // 1 / threshold (°C)
+    };
+
+    static inline Coeff coeff(float alpha, uint8_t mode, float threshold) {
+        Coeff c;
+        c.alpha           = alpha;
+        c.one_minus_alpha = 1.0f - alpha;
+        c.adaptive        = (mode == FILTER_MODE_ADAPTIVE);
+        c.inv_thr         = 1.0f / (threshold > 0.01f ? threshold : 0.01f);
+        return c;
+    }
+
+    static inline void seed(state_t& y, float x) {
+        y = x;
+    }
+
+    // IIR: y[n] = alpha * x[n] + (1 - alpha) * y[n-1]
+    static inline float step(state_t& y, float x, const Coeff& c) {
+        if (c.adaptive) {
+            float r = fabsf(x - y) * c.inv_thr;
+            float a = (r >= 1.0f) ? 1.0f : c.alpha + c.one_minus_alpha * r * r;
+            y = a * x + (1.0f - a) * y;
+        } else {
+            y = c.alpha * x + c.one_minus_alpha * y;
+        }
+        return y;
+    }
+};
+
+// Per-pixel IIR state. Exposed so the fused frame kernel
+// (pipeline_kernel.h) can run the filter inside its single pass with
+// exactly the same arithmetic as filter_apply().
+template <class G, class P>
+struct FilterStateT {
+    typename FilterMath<P>::state_t prev[G::pixels];
+    bool primed;
+};
+
+template <class G, class P>
+static inline void filter_seed(FilterStateT<G, P>& st, int i, P x) {
+    FilterMath<P>::seed(st.prev[i], x);
+}
+
+template <class G, class P>
+static inline P filter_step(FilterStateT<G, P>& st, int i, P x, const typename FilterMath<P>::Coeff& c) {
+    return FilterMath<P>::step(st.prev[i], x, c);
+}
+
+template <class G, class P>
+static inline void filter_apply_t(FilterStateT<G, P>& st, P* pixels, const typename FilterMath<P>::Coeff& k) {
+    if (!st.primed) {
+        // First frame: seed the filter
+        for (int i = 0; i < G::pixels; i++) filter_seed(st, i, pixels[i]);
+        st.primed = true;
+        return;
+    }
+    for (int i = 0; i < G::pixels; i++) {
+        pixels[i] = filter_step(st, i, pixels[i], k);
+    }
+}
+
+// The build's grid and pixel type
+typedef FilterStateT<SensorGrid, pixel_t> FilterState;
+typedef FilterMath<pixel_t>::Coeff        filter_coeff_t;
+
+static inline filter_coeff_t filter_coeff(float alpha, uint8_t mode, float threshold) {
+    return FilterMath<pixel_t>::coeff(alpha, mode, threshold);
+}
 
 void filter_init();
 void filter_reset();
-void filter_apply(float* pixels64, float alpha);
+void filter_apply(pixel_t* pixels, const filter_coeff_t& k);
+FilterState& filter_state();
 
 #endif
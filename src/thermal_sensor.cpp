@@ -5,6 +5,25 @@
 static Adafruit_AMG88xx amg;
 static bool initialized = false;
 
+static size_t wire_read_regs(uint8_t addr, uint8_t reg, uint8_t* buf, size_t len) {
+    Wire.beginTransmission(addr);
+    Wire.write(reg);
+    if (Wire.endTransmission() != 0) return 0;
+    size_t got = Wire.requestFrom(addr, (uint8_t)len);
+    for (size_t i = 0; i < got; i++) buf[i] = Wire.read();
+    return got;
+}
+
+static const I2CBus wire_bus = { wire_read_regs };
+
+#if AMG_INT_PIN >= 0
+static volatile bool int_fired = false;
+
+static void IRAM_ATTR on_amg_int() {
+    int_fired = true;
+}
+#endif
+
 bool sensor_init() {
     // Wemos D1 mini default I2C: D1=GPIO5 (SCL), D2=GPIO4 (SDA)
     Wire.begin(4, 5);
@@ -15,15 +34,53 @@ bool sensor_init() {
         return false;
     }
 
+    amg_reader_init(&wire_bus);
+#if AMG_INT_PIN >= 0
+    // Absolute-value threshold interrupt (INTC, INTHL/H, INTLL/H, IHYSL/H)
+    amg.setInterruptLevels(AMG_INT_HIGH_C, AMG_INT_LOW_C, AMG_INT_HYST_C);
+    amg.setInterruptMode(AMG88xx_ABSOLUTE_VALUE);
+    amg.enableInterrupt();
+    amg.clearInterrupt();
+    // INT is open-drain, active low
+    pinMode(AMG_INT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(AMG_INT_PIN), on_amg_int, FALLING);
+    Serial.printf("[Sensor] INT on GPIO%d outside %.1f..%.1f C starts a read early\n",
+        AMG_INT_PIN, AMG_INT_LOW_C, AMG_INT_HIGH_C);
+#endif
+
     Serial.println("[Sensor] AMG8833 initialized");
     initialized = true;
     return true;
 }
 
-bool sensor_read(float* pixels64) {
+bool sensor_poll() {
     if (!initialized) return false;
-    amg.readPixels(pixels64);
-    return true;
+#if AMG_INT_PIN >= 0
+    if (int_fired) {
+        int_fired = false;
+        // Re-arm INT so the next crossing gives a new edge
+        amg.clearInterrupt();
+        amg_reader_trigger();
+    }
+#endif
+    return amg_reader_poll(millis());
+}
+
+bool sensor_available() {
+    return initialized && amg_reader_available();
+}
+
+bool sensor_read(pixel_t* pixels64) {
+    if (!initialized) return false;
+    return amg_reader_take(pixels64);
+}
+
+uint32_t sensor_frame_age_ms() {
+    return millis() - amg_reader_stats().last_frame_ms;
+}
+
+const AmgReaderStats& sensor_stats() {
+    return amg_reader_stats();
 }
 
 float sensor_thermistor() {
@@ -2,9 +2,31 @@
 #define THERMAL_SENSOR_H
 
 #include <Arduino.h>
+#include "pixel_format.h"
+#include "amg_reader.h"
+
+// Optional AMG8833 INT pin (GPIO number). INT is a threshold interrupt,
+// not data-ready: the sensor is programmed to assert it when any pixel
+// leaves [AMG_INT_LOW_C, AMG_INT_HIGH_C], and the falling edge starts a
+// read straight away instead of at the next frame-clock slot. Reads still
+// follow the frame clock while INT stays quiet.
+#ifndef AMG_INT_PIN
+#define AMG_INT_PIN -1
+#endif
+#ifndef AMG_INT_HIGH_C
+#define AMG_INT_HIGH_C  35.0f
+#endif
+#ifndef AMG_INT_LOW_C
+#define AMG_INT_LOW_C   0.0f
+#endif
+#define AMG_INT_HYST_C  1.0f
 
 bool  sensor_init();
-bool  sensor_read(float* pixels64);  // fills 64 floats with °C values
-float sensor_thermistor();           // on-chip thermistor reading
+bool  sensor_poll();                   // call every loop iteration; true if an I2C chunk was read
+bool  sensor_available();              // a fresh frame is waiting
+bool  sensor_read(pixel_t* pixels64);  // takes the fresh frame (see pixel_format.h)
+uint32_t sensor_frame_age_ms();        // age of the newest fresh frame
+const AmgReaderStats& sensor_stats();
+float sensor_thermistor();             // on-chip thermistor reading
 
 #endif
@@ -0,0 +1,101 @@
+#include "trend.h"
+
+static TrendBucket sec_ring[TREND_SECOND_BUCKETS];
+static TrendBucket min_ring[TREND_MINUTE_BUCKETS];
+static TrendBucket hour_ring[TREND_HOUR_BUCKETS];
+
+struct TrendRing {
+    TrendBucket* buckets;
+    uint16_t     capacity;
+    uint32_t     period_s;
+    const char*  name;
+    uint16_t     head;     // position of the newest bucket
+    uint16_t     count;
+};
+
+static TrendRing rings[TREND_LEVEL_COUNT] = {
+    { sec_ring,  TREND_SECOND_BUCKETS, 1,    "second", 0, 0 },
+    { min_ring,  TREND_MINUTE_BUCKETS, 60,   "minute", 0, 0 },
+    { hour_ring, TREND_HOUR_BUCKETS,   3600, "hour",   0, 0 },
+};
+
+void trend_init() {
+    for (int l = 0; l < TREND_LEVEL_COUNT; l++) {
+        rings[l].head  = 0;
+        rings[l].count = 0;
+    }
+}
+
+static void ring_add(TrendRing& r, uint32_t now_s, int16_t tmin, int16_t tmax, int16_t tmean) {
+    uint32_t start = now_s - now_s % r.period_s;
+    TrendBucket* b = &r.buckets[r.head];
+
+    if (r.count == 0 || b->start_s != start) {
+        // New period; empty periods are simply absent from the ring
+        if (r.count > 0) r.head = (r.head + 1) % r.capacity;
+        if (r.count < r.capacity) r.count++;
+        b = &r.buckets[r.head];
+        b->start_s  = start;
+        b->tmin     = tmin;
+        b->tmax     = tmax;
+        b->mean_sum = 0;
+        b->count    = 0;
+    }
+
+    if (tmin < b->tmin) b->tmin = tmin;
+    if (tmax > b->tmax) b->tmax = tmax;
+    if (b->count < UINT16_MAX) {
+        b->mean_sum += tmean;
+        b->count++;
+    }
+}
+
+void trend_add(uint32_t timestamp_ms, const FrameStats& stats) {
+    uint32_t now_s = timestamp_ms / 1000;
+    int16_t  tmin  = pixel_to_centi(stats.tmin);
+    int16_t  tmax  = pixel_to_centi(stats.tmax);
+    int16_t  tmean = pixel_to_centi(stats.tmean);
+
+    for (int l = 0; l < TREND_LEVEL_COUNT; l++) {
+        ring_add(rings[l], now_s, tmin, tmax, tmean);
+    }
+}
+
+uint32_t trend_period_s(TrendLevel level) {
+    return rings[level].period_s;
+}
+
+int trend_capacity(TrendLevel level) {
+    return rings[level].capacity;
+}
+
+const char* trend_level_name(TrendLevel level) {
+    return rings[level].name;
+}
+
+bool trend_level_from_name(const char* name, TrendLevel& out) {
+    for (int l = 0; l < TREND_LEVEL_COUNT; l++) {
+        if (!strcmp(name, rings[l].name)) {
+            out = (TrendLevel)l;
+            return true;
+        }
+    }
+    return false;
+}
+
+int trend_query(TrendLevel level, uint32_t since_s, int& first) {
+    const TrendRing& r = rings[level];
+    int oldest = (r.head + r.capacity - r.count + 1) % r.capacity;
+
+    // Buckets are in start order; skip those before since_s
+    int skip = 0;
+    while (skip < r.count && r.buckets[(oldest + skip) % r.capacity].start_s < since_s) skip++;
+
+    first = (oldest + skip) % r.capacity;
+    return r.count - skip;
+}
+
+const TrendBucket& trend_get(TrendLevel level, int pos) {
+    const TrendRing& r = rings[level];
+    return r.buckets[pos % r.capacity];
+}
@@ -0,0 +1,51 @@
+#ifndef TREND_H
+#define TREND_H
+
+#include <Arduino.h>
+#include "stats.h"
+
+// Min/max/mean of the frame statistics at several resolutions, each in a
+// fixed ring of buckets. Every frame updates the current bucket of every
+// level in O(1); a query walks at most one ring, never raw frames.
+
+enum TrendLevel : uint8_t {
+    TREND_SECOND,
+    TREND_MINUTE,
+    TREND_HOUR,
+    TREND_LEVEL_COUNT
+};
+
+// 14 B per bucket; the defaults take about 2.4 KB
+#ifndef TREND_SECOND_BUCKETS
+#define TREND_SECOND_BUCKETS  60    // 1 min
+#endif
+#ifndef TREND_MINUTE_BUCKETS
+#define TREND_MINUTE_BUCKETS  60    // 1 h
+#endif
+#ifndef TREND_HOUR_BUCKETS
+#define TREND_HOUR_BUCKETS    48    // 2 days
+#endif
+
+struct __attribute__((packed)) TrendBucket {
+    uint32_t start_s;    // uptime seconds at the bucket start
+    int16_t  tmin;       // centi-degrees
+    int16_t  tmax;
+    int32_t  mean_sum;   // sum of per-frame means, centi-degrees
+    uint16_t count;      // frames in the bucket
+};
+
+void        trend_init();
+void        trend_add(uint32_t timestamp_ms, const FrameStats& stats);
+
+uint32_t    trend_period_s(TrendLevel level);
+int         trend_capacity(TrendLevel level);
+const char* trend_level_name(TrendLevel level);
+bool        trend_level_from_name(const char* name, TrendLevel& out);
+
+// Buckets of `level` that started at or after since_s, oldest first.
+// Returns the number of buckets held; `first` is the ring position to pass
+// to trend_get() for the oldest of them.
+int                trend_query(TrendLevel level, uint32_t since_s, int& first);
+const TrendBucket& trend_get(TrendLevel level, int pos);
+
+#endif
@@ -0,0 +1,94 @@
+#include "udp_publisher.h"
+#include "ws_codec.h"
+#include "metrics.h"
+
+static_assert(sizeof(udp_frame_header_t) == 16, "UDP header layout changed");
+
+static const UdpSink*    sink = nullptr;
+static bool              enabled = false;
+static uint8_t           group[4] = { 239, 255, 42, 42 };
+static uint16_t          port = UDP_DEFAULT_PORT;
+static uint8_t           every = 1;
+static uint8_t           countdown = 0;
+static UdpPublisherStats stats;
+static uint8_t           datagram[UDP_DATAGRAM_SIZE];
+
+void udp_publisher_init(const UdpSink* s) {
+    sink = s;
+    memset(&stats, 0, sizeof(stats));
+    countdown = 0;
+}
+
+void udp_publisher_configure(bool on, const uint8_t addr[4], uint16_t p, uint8_t n) {
+    if (on && !enabled) {
+        char buf[16];
+        udp_format_addr(addr, buf);
+        Serial.printf("[UDP] Publishing to %s:%u every %u frame(s)\n", buf, p, n ? n : 1);
+    }
+    enabled   = on;
+    memcpy(group, addr, sizeof(group));
+    port      = p ? p : UDP_DEFAULT_PORT;
+    every     = n ? n : 1;
+    countdown = 0;
+}
+
+bool udp_publisher_enabled() {
+    return enabled;
+}
+
+size_t udp_datagram_build(const Frame& frame, uint32_t seq, uint32_t now_ms, uint8_t* out) {
+    udp_frame_header_t h;
+    memcpy(h.magic, UDP_MAGIC, 2);
+    h.version     = UDP_VERSION;
+    h.type        = UDP_TYPE_FRAME;
+    h.seq         = seq;
+    h.sent_ms     = now_ms;
+    h.grid_w      = GRID_WIDTH;
+    h.grid_h      = GRID_HEIGHT;
+    h.record_size = sizeof(ws_frame_record_t);
+    memcpy(out, &h, sizeof(h));
+
+    ws_frame_record_t rec;
+    ws_record_encode(frame, rec);
+    memcpy(out + sizeof(h), &rec, sizeof(rec));
+    return UDP_DATAGRAM_SIZE;
+}
+
+bool udp_publish(const Frame& frame, uint32_t now_ms, bool link_up) {
+    if (!enabled || !sink) return false;
+    if (countdown > 0) {
+        countdown--;
+        return false;
+    }
+    countdown = every - 1;
+    if (!link_up) {
+        stats.no_link++;
+        return false;
+    }
+
+    // A refused datagram still uses its seq, so receivers see it as loss
+    uint32_t t0 = metrics_now();
+    size_t len = udp_datagram_build(frame, stats.seq++, now_ms, datagram);
+    bool ok = sink->send(group, port, datagram, len);
+    metrics_record(METRIC_UDP, metrics_now() - t0);
+    if (ok) stats.sent++;
+    else    stats.send_errors++;
+    return ok;
+}
+
+bool udp_parse_addr(const char* s, uint8_t out[4]) {
+    unsigned a, b, c, d;
+    char tail;
+    if (!s || sscanf(s, "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4) return false;
+    if (a > 255 || b > 255 || c > 255 || d > 255) return false;
+    out[0] = a; out[1] = b; out[2] = c; out[3] = d;
+    return true;
+}
+
+void udp_format_addr(const uint8_t addr[4], char* buf) {
+    snprintf(buf, 16, "%u.%u.%u.%u", addr[0], addr[1], addr[2], addr[3]);
+}
+
+const UdpPublisherStats& udp_publisher_stats() {
+    return stats;
+}
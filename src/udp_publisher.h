@@ -0,0 +1,69 @@
+#ifndef UDP_PUBLISHER_H
+#define UDP_PUBLISHER_H
+
+#include <Arduino.h>
+#include "frame.h"
+#include "ws_protocol.h"
+
+// Optional UDP publisher: each produced frame is sent once, as one
+// datagram, to a multicast or broadcast group on the STA network. Any
+// number of receivers cost the device the same one datagram per frame,
+// independent of the AP client limit and of per-client TCP buffers.
+//
+// A datagram is a udp_frame_header_t followed by one ws_frame_record_t.
+// Every datagram stands on its own (no deltas), so a lost one costs only
+// that frame; receivers count gaps in `seq` as loss. tools/udp_receiver.py
+// decodes the stream and reports rate and loss.
+
+#define UDP_MAGIC           "TC"
+#define UDP_VERSION         1
+#define UDP_TYPE_FRAME      1
+#define UDP_DEFAULT_PORT    5008
+
+struct __attribute__((packed)) udp_frame_header_t {
+    char     magic[2];             // UDP_MAGIC
+    uint8_t  version;              // UDP_VERSION
+    uint8_t  type;                 // UDP_TYPE_FRAME
+    uint32_t seq;                  // +1 per published frame, gaps are loss
+    uint32_t sent_ms;              // device time
+    uint8_t  grid_w;
+    uint8_t  grid_h;
+    uint16_t record_size;          // bytes of the record that follows
+};
+// Total size: 2+1+1+4+4+1+1+2 = 16 bytes
+
+#define UDP_DATAGRAM_SIZE   (sizeof(udp_frame_header_t) + sizeof(ws_frame_record_t))
+
+// Datagram transport. Swappable so the publisher can run against host
+// sockets; the device uses WiFiUDP (wifi_manager.h).
+struct UdpSink {
+    // Sends one datagram to addr:port; false if it could not be queued
+    bool (*send)(const uint8_t addr[4], uint16_t port, const uint8_t* data, size_t len);
+};
+
+struct UdpPublisherStats {
+    uint32_t sent;
+    uint32_t send_errors;          // the sink refused the datagram
+    uint32_t no_link;              // frames while the STA link was down
+    uint32_t seq;                  // next datagram seq
+};
+
+void udp_publisher_init(const UdpSink* sink);
+// `every` sends every Nth frame (1 = all)
+void udp_publisher_configure(bool enabled, const uint8_t group[4], uint16_t port, uint8_t every);
+bool udp_publisher_enabled();
+
+// Publishes `frame` if enabled and due; true if a datagram was sent
+bool udp_publish(const Frame& frame, uint32_t now_ms, bool link_up);
+
+// Writes header + record; `out` must hold UDP_DATAGRAM_SIZE bytes
+size_t udp_datagram_build(const Frame& frame, uint32_t seq, uint32_t now_ms, uint8_t* out);
+
+// Dotted quad ("239.255.42.42") to bytes; false if malformed
+bool udp_parse_addr(const char* s, uint8_t out[4]);
+// Formats addr into buf (at least 16 bytes)
+void udp_format_addr(const uint8_t addr[4], char* buf);
+
+const UdpPublisherStats& udp_publisher_stats();
+
+#endif
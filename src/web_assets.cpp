@@ -0,0 +1,107 @@
+#include "web_assets.h"
+#include <LittleFS.h>
+
+static WebAsset assets[WEB_ASSET_MAX];
+static int      asset_count = 0;
+
+static bool parse_line(char* line, WebAsset& a) {
+    char name[WEB_ASSET_NAME_LEN + 1], etag[17], flags[4];
+    unsigned long size, raw_size;
+    if (sscanf(line, "%32s %16s %3s %lu %lu", name, etag, flags, &size, &raw_size) != 5) return false;
+    if (strlen(name) >= WEB_ASSET_NAME_LEN) return false;
+
+    snprintf(a.name, sizeof(a.name), "%s", name);
+    snprintf(a.etag, sizeof(a.etag), "\"%s\"", etag);
+    a.flags = 0;
+    if (strchr(flags, 'g')) a.flags |= WEB_ASSET_GZIP;
+    if (strchr(flags, 'i')) a.flags |= WEB_ASSET_IMMUTABLE;
+    a.size     = size;
+    a.raw_size = raw_size;
+    return true;
+}
+
+int web_assets_load() {
+    asset_count = 0;
+
+    File f = LittleFS.open(WEB_ASSET_MANIFEST, "r");
+    if (!f) return 0;
+    char   buf[WEB_ASSET_MAX * 64];
+    size_t len = f.read((uint8_t*)buf, sizeof(buf) - 1);
+    f.close();
+    buf[len] = '\0';
+
+    char* save = nullptr;
+    for (char* line = strtok_r(buf, "\n", &save); line; line = strtok_r(nullptr, "\n", &save)) {
+        if (asset_count >= WEB_ASSET_MAX) {
+            Serial.printf("[Web] Manifest has more than %d assets\n", WEB_ASSET_MAX);
+            break;
+        }
+        if (parse_line(line, assets[asset_count])) asset_count++;
+    }
+    return asset_count;
+}
+
+int web_asset_count() {
+    return asset_count;
+}
+
+const WebAsset* web_asset_get(int i) {
+    return i >= 0 && i < asset_count ? &assets[i] : nullptr;
+}
+
+const WebAsset* web_asset_find(const char* url) {
+    if (!url || url[0] != '/') return nullptr;
+    const char* name = url[1] ? url + 1 : "index.html";
+    for (int i = 0; i < asset_count; i++) {
+        if (!strcmp(assets[i].name, name)) return &assets[i];
+    }
+    return nullptr;
+}
+
+// If-None-Match is "*" or a list of entity tags; weak comparison applies
+static bool etag_matches(const char* header, const char* etag) {
+    if (!header || !header[0]) return false;
+    size_t n = strlen(etag);
+    const char* p = header;
+    while (*p) {
+        while (*p == ' ' || *p == ',') p++;
+        if (*p == '*') return true;
+        if (p[0] == 'W' && p[1] == '/') p += 2;
+        if (!strncmp(p, etag, n)) return true;
+        while (*p && *p != ',') p++;
+    }
+    return false;
+}
+
+int web_asset_reply(const char* url, const char* if_none_match, WebAssetReply& out) {
+    memset(&out, 0, sizeof(out));
+    const WebAsset* a = web_asset_find(url);
+    if (!a) {
+        out.status = 404;
+        return out.status;
+    }
+
+    out.asset            = a;
+    out.content_type     = web_asset_content_type(a->name);
+    out.content_encoding = (a->flags & WEB_ASSET_GZIP) ? "gzip" : nullptr;
+    out.cache_control    = (a->flags & WEB_ASSET_IMMUTABLE) ? WEB_CACHE_IMMUTABLE : WEB_CACHE_REVALIDATE;
+    snprintf(out.path, sizeof(out.path), WEB_ASSET_DIR "/%s%s", a->name,
+             (a->flags & WEB_ASSET_GZIP) ? ".gz" : "");
+
+    out.status = etag_matches(if_none_match, a->etag) ? 304 : 200;
+    return out.status;
+}
+
+const char* web_asset_content_type(const char* name) {
+    const char* ext = strrchr(name, '.');
+    if (!ext)                  return "application/octet-stream";
+    if (!strcmp(ext, ".html")) return "text/html";
+    if (!strcmp(ext, ".js"))   return "application/javascript";
+    if (!strcmp(ext, ".css"))  return "text/css";
+    if (!strcmp(ext, ".json")) return "application/json";
+    if (!strcmp(ext, ".svg"))  return "image/svg+xml";
+    if (!strcmp(ext, ".png"))  return "image/png";
+    if (!strcmp(ext, ".ico"))  return "image/x-icon";
+    if (!strcmp(ext, ".txt"))  return "text/plain";
+    return "application/octet-stream";
+}
@@ -0,0 +1,58 @@
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <Arduino.h>
+
+// Static web files prepared by tools/build_web.py: gzipped, content-hashed
+// names for everything but index.html, and WEB_ASSET_MANIFEST listing each
+// file as "<name> <etag> <flags> <stored bytes> <original bytes>".
+//
+// web_asset_reply() decides the response for a GET; the webserver only
+// turns it into headers and a file body. Hashed files never change under
+// their name and are cached for a year; index.html is revalidated on every
+// load and answered with 304 while its ETag matches.
+
+#define WEB_ASSET_DIR       "/www"
+#define WEB_ASSET_MANIFEST  "/www/manifest.txt"
+#define WEB_ASSET_MAX       12
+#define WEB_ASSET_NAME_LEN  32
+#define WEB_ASSET_ETAG_LEN  19          // quoted 16 hex digits + NUL
+
+#define WEB_ASSET_GZIP      0x01        // stored as <name>.gz
+#define WEB_ASSET_IMMUTABLE 0x02        // content-hashed name
+
+#define WEB_CACHE_IMMUTABLE "public, max-age=31536000, immutable"
+#define WEB_CACHE_REVALIDATE "no-cache"
+
+struct WebAsset {
+    char     name[WEB_ASSET_NAME_LEN];
+    char     etag[WEB_ASSET_ETAG_LEN];  // strong, quoted
+    uint8_t  flags;
+    uint32_t size;                      // bytes sent (stored file)
+    uint32_t raw_size;                  // before compression
+};
+
+struct WebAssetReply {
+    int             status;             // 200, 304 or 404
+    const WebAsset* asset;
+    char            path[48];           // LittleFS file to send for 200
+    const char*     content_type;
+    const char*     content_encoding;   // nullptr if sent as stored
+    const char*     cache_control;
+};
+
+// Reads the manifest. Returns the number of assets, 0 if there is none
+// (data/www uploaded without the build step).
+int  web_assets_load();
+int  web_asset_count();
+const WebAsset* web_asset_get(int i);
+
+// "/" is index.html. nullptr if the URL is not an asset.
+const WebAsset* web_asset_find(const char* url);
+
+// if_none_match may be nullptr or empty
+int  web_asset_reply(const char* url, const char* if_none_match, WebAssetReply& out);
+
+const char* web_asset_content_type(const char* name);
+
+#endif
@@ -1,8 +1,25 @@
 #include "webserver.h"
 #include "config.h"
+#include "config_json.h"
+#include "config_store.h"
 #include "power_manager.h"
 #include "wifi_manager.h"
 #include "temporal_filter.h"
+#include "thermal_sensor.h"
+#include "scheduler.h"
+#include "metrics.h"
+#include "nuc.h"
+#include "ws_codec.h"
+#include "ws_clients.h"
+#include "frame_batch.h"
+#include "frame_history.h"
+#include "recorder.h"
+#include "trend.h"
+#include "alarm.h"
+#include "web_assets.h"
+#include "snapshot.h"
+#include "ws_control.h"
+#include "udp_publisher.h"
 
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
@@ -15,11 +32,108 @@ static AsyncWebSocket  ws("/ws");
 static bool     wifi_restart_pending = false;
 static uint32_t wifi_restart_at_ms   = 0;
 
-// Buffer for POST body (config JSON is small, <256 bytes)
-static uint8_t  post_body_buf[512];
+// Buffer for POST body (config JSON with full ROI and alarm lists)
+static uint8_t  post_body_buf[2048];
 static size_t   post_body_len = 0;
 static bool     post_body_ready = false;
 
+// Per-client wire format, selected by WS_MSG_HELLO. Clients that never
+// send a hello stay on v1.
+static WsV2Encoder   v2_enc[2];  // indexed by WS_QUANT_*
+
+// One encoding of the current frame, written straight into a library
+// message buffer of its exact size. Every client queue shares that buffer,
+// so a frame costs one heap block per encoding, not per client.
+struct Encoding {
+    AsyncWebSocketMessageBuffer* msg;
+};
+
+// Heap cost of the fan-out, for measuring multi-client load
+struct BroadcastHeapStats {
+    uint32_t frames;
+    uint32_t allocs;          // library message buffers created, total
+    uint32_t alloc_bytes;
+    uint16_t last_allocs;     // for the most recent frame
+    uint16_t last_alloc_bytes;
+    int32_t  last_heap_delta; // free heap after fan-out minus before
+    uint32_t alloc_failed;    // encodings dropped because makeBuffer failed
+};
+static BroadcastHeapStats heap_stats;
+
+// Next alarm event id to push to event subscribers
+static uint32_t events_sent = 0;
+
+static const char* channel_name(uint8_t channel) {
+    switch (channel) {
+        case WS_CHANNEL_STATS: return "stats";
+        case WS_CHANNEL_BATCH: return "batch";
+        case WS_CHANNEL_EVENTS: return "events";
+        default:               return "frames";
+    }
+}
+
+static void handleWsMessage(AsyncWebSocketClient* client, const uint8_t* data, size_t len) {
+    if (len < 1) return;
+
+    switch (data[0]) {
+        case WS_MSG_HELLO: {
+            WsClientSlot* c = ws_clients_find(client->id());
+            if (!c || len < 3) return;
+            if (data[1] == WS_FORMAT_V2 && data[2] <= WS_QUANT_I8) {
+                c->format   = WS_FORMAT_V2;
+                c->quant    = data[2];
+                c->need_key = true;
+            } else {
+                c->format = WS_FORMAT_V1;
+            }
+            Serial.printf("[WS] Client #%u selected format v%u\n", client->id(), c->format);
+            break;
+        }
+
+        case WS_MSG_SUBSCRIBE: {
+            WsClientSlot* c = ws_clients_find(client->id());
+            if (!c || len < 3) return;
+            c->channel   = (data[1] <= WS_CHANNEL_EVENTS) ? data[1] : WS_CHANNEL_FRAMES;
+            c->every     = data[2] ? data[2] : 1;
+            c->countdown = 0;
+            c->need_key  = true;
+            c->events    = c->channel == WS_CHANNEL_EVENTS || (len >= 4 && (data[3] & WS_SUB_EVENTS));
+            Serial.printf("[WS] Client #%u subscribed to %s every %u%s\n", client->id(),
+                channel_name(c->channel), c->every, c->events ? " with events" : "");
+            break;
+        }
+
+        case WS_MSG_SET_PARAM:
+        case WS_MSG_GET_STATUS: {
+            // Answered from this callback: no new connection, no JSON, no flash
+            MetricScope scope(METRIC_CONTROL);
+            WsControlLive live = { (uint8_t)power_active_fps(), (uint8_t)power_client_count(), power_is_idle() };
+            uint8_t reply[WS_CONTROL_REPLY_MAX];
+            size_t n = ws_control_handle(data, len, millis(), live, reply);
+            if (n) client->binary(reply, n);
+            break;
+        }
+
+        case WS_MSG_PING: {
+            WsClientSlot* c = ws_clients_find(client->id());
+            if (!c) return;
+            uint8_t reply[sizeof(ws_pong_packet_t)];
+            size_t n = ws_client_ping(*c, data, len, millis(), micros(), reply);
+            if (n) client->binary(reply, n);
+            break;
+        }
+
+        case WS_MSG_ECHO: {
+            WsClientSlot* c = ws_clients_find(client->id());
+            if (c) ws_client_echo(*c, data, len, micros());
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
 // ── WebSocket events ────────────────────────────────
 
 static void onWsEvent(AsyncWebSocket* srv, AsyncWebSocketClient* client,
@@ -29,21 +143,35 @@ static void onWsEvent(AsyncWebSocket* srv, AsyncWebSocketClient* client,
         case WS_EVT_CONNECT:
             Serial.printf("[WS] Client #%u connected from %s\n",
                 client->id(), client->remoteIP().toString().c_str());
+            if (!ws_clients_add(client->id())) {
+                Serial.printf("[WS] Client table full, closing #%u\n", client->id());
+                client->close();
+                break;
+            }
             power_client_connected();
             break;
 
         case WS_EVT_DISCONNECT:
             Serial.printf("[WS] Client #%u disconnected\n", client->id());
-            power_client_disconnected();
+            if (ws_clients_find(client->id())) {
+                ws_clients_remove(client->id());
+                power_client_disconnected();
+            }
             break;
 
         case WS_EVT_ERROR:
             Serial.printf("[WS] Client #%u error\n", client->id());
             break;
 
-        case WS_EVT_DATA:
-            // No incoming data expected from clients
+        case WS_EVT_DATA: {
+            // Only complete, unfragmented binary messages are handled
+            AwsFrameInfo* info = (AwsFrameInfo*)arg;
+            if (info->final && info->index == 0 && info->len == len &&
+                info->opcode == WS_BINARY) {
+                handleWsMessage(client, data, len);
+            }
             break;
+        }
 
         default:
             break;
@@ -53,29 +181,562 @@ static void onWsEvent(AsyncWebSocket* srv, AsyncWebSocketClient* client,
 // ── REST API: GET /api/config ───────────────────────
 
 static void handleGetConfig(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
     SystemConfig& cfg = config_get();
-    StaticJsonDocument<512> doc;
+    DynamicJsonDocument doc(CONFIG_JSON_CAPACITY);
 
     doc["normal_fps"]        = cfg.normal_fps;
     doc["idle_fps"]          = cfg.idle_fps;
     doc["idle_timeout_sec"]  = cfg.idle_timeout_sec;
     doc["temporal_enabled"]  = cfg.temporal_enabled;
     doc["alpha"]             = cfg.alpha;
+    doc["filter_mode"]       = cfg.filter_mode;
+    doc["adaptive_threshold"] = cfg.adaptive_threshold;
     doc["calibration_offset"] = cfg.calibration_offset;
+    doc["batch_frames"]      = cfg.batch_frames;
+    doc["batch_max_ms"]      = cfg.batch_max_ms;
+    doc["record_enabled"]    = cfg.record_enabled;
+    config_rois_to_json(doc.createNestedArray("rois"), cfg);
+    config_alarms_to_json(doc.createNestedArray("alarms"), cfg);
     doc["sta_enabled"]       = cfg.sta_enabled;
     doc["sta_ssid"]          = cfg.sta_ssid;
     // Don't expose password
+    char group[16];
+    udp_format_addr(cfg.udp_group, group);
+    doc["udp_enabled"]       = cfg.udp_enabled;
+    doc["udp_group"]         = group;
+    doc["udp_port"]          = cfg.udp_port;
+    doc["udp_every"]         = cfg.udp_every;
     doc["sta_ip"]            = wifi_sta_ip();
     doc["sta_connected"]     = wifi_sta_connected();
     doc["clients"]           = power_client_count();
     doc["idle"]              = power_is_idle();
     doc["version"]           = VERSION_STR;
 
+    JsonObject grid = doc.createNestedObject("grid");
+    grid["w"] = GRID_WIDTH;
+    grid["h"] = GRID_HEIGHT;
+
+    const AmgReaderStats& ss = sensor_stats();
+    JsonObject sensor = doc.createNestedObject("sensor");
+    sensor["frames"]       = ss.frames;
+    sensor["duplicates"]   = ss.duplicates;
+    sensor["errors"]       = ss.errors;
+    sensor["triggered"]    = ss.triggered;
+    sensor["frame_age_ms"] = sensor_frame_age_ms();
+
+    const ConfigStoreStats& cs = config_store_stats();
+    JsonObject store = doc.createNestedObject("store");
+    store["generation"]   = cs.seq;
+    store["slot"]         = cs.slot == 0 ? "A" : "B";
+    store["writes"]       = cs.writes;
+    store["write_errors"] = cs.write_errors;
+    store["bad_records"]  = cs.bad_records;
+    store["load_us"]      = cs.load_us;
+    store["pending"]      = config_save_pending();
+
+    const UdpPublisherStats& us = udp_publisher_stats();
+    JsonObject udp = doc.createNestedObject("udp");
+    udp["sent"]        = us.sent;
+    udp["send_errors"] = us.send_errors;
+    udp["no_link"]     = us.no_link;
+
+    String json;
+    serializeJson(doc, json);
+    request->send(200, "application/json", json);
+}
+
+// ── REST API: GET /api/clients ──────────────────────
+
+static void handleGetClients(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
+    DynamicJsonDocument doc(3072);
+    JsonArray arr = doc.createNestedArray("clients");
+
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        WsClientSlot* c = ws_clients_at(i);
+        if (!c) continue;
+        JsonObject o = arr.createNestedObject();
+        o["id"]      = c->id;
+        o["format"]  = c->format;
+        o["channel"] = channel_name(c->channel);
+        o["every"]   = c->every;
+        o["events"]  = c->events;
+        o["sent"]    = c->sent;
+        o["dropped"] = c->dropped;
+        o["queue"]   = c->queue_depth;
+
+        // Link telemetry, once the client has answered a pong
+        o["pings"]           = c->pings;
+        o["rtt_ms"]          = c->rtt_us / 1000.0f;
+        o["rtt_min_ms"]      = c->rtt_min_us / 1000.0f;
+        o["rtt_avg_ms"]      = c->rtt_avg_us / 1000.0f;
+        o["clock_offset_ms"] = c->clock_offset_ms;
+        o["client_frames"]   = c->client_frames;
+        o["client_lost"]     = c->client_lost;
+        o["latency_ms"]      = c->latency_ms;
+    }
+
+    JsonObject heap = doc.createNestedObject("heap");
+    heap["free"]             = ESP.getFreeHeap();
+    heap["frames"]           = heap_stats.frames;
+    heap["allocs"]           = heap_stats.allocs;
+    heap["alloc_bytes"]      = heap_stats.alloc_bytes;
+    heap["last_allocs"]      = heap_stats.last_allocs;
+    heap["last_alloc_bytes"] = heap_stats.last_alloc_bytes;
+    heap["last_heap_delta"]  = heap_stats.last_heap_delta;
+    heap["alloc_failed"]     = heap_stats.alloc_failed;
+
+    String json;
+    serializeJson(doc, json);
+    request->send(200, "application/json", json);
+}
+
+// ── REST API: GET /api/tasks ────────────────────────
+
+// Task names are static strings, stored by pointer
+static constexpr size_t TASKS_JSON_CAPACITY =
+    JSON_OBJECT_SIZE(1) + JSON_ARRAY_SIZE(SCHED_MAX_TASKS) + SCHED_MAX_TASKS * JSON_OBJECT_SIZE(7);
+
+static void handleGetTasks(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
+    StaticJsonDocument<TASKS_JSON_CAPACITY> doc;
+    JsonArray arr = doc.createNestedArray("tasks");
+
+    for (int i = 0; i < sched_task_count(); i++) {
+        const SchedTaskStats& st = sched_task_stats(i);
+        JsonObject o = arr.createNestedObject();
+        o["name"]          = sched_task_name(i);
+        o["period_us"]     = sched_task_period(i);
+        o["runs"]          = st.runs;
+        o["overruns"]      = st.overruns;
+        o["max_jitter_us"] = st.max_jitter_us;
+        o["mean_jitter_us"] = st.runs ? st.sum_jitter_us / st.runs : 0;
+        o["max_run_us"]    = st.max_run_us;
+    }
+
+    String json;
+    serializeJson(doc, json);
+    request->send(200, "application/json", json);
+}
+
+// ── REST API: GET /api/metrics (Prometheus text) ────
+
+// The ESP8266 printf has no %llu; digits into the end of a 21-byte buffer
+static const char* u64_dec(uint64_t v, char* buf) {
+    char* p = buf + 20;
+    *p = '\0';
+    do {
+        *--p = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    return p;
+}
+
+static void handleGetMetrics(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
+    AsyncResponseStream* res = request->beginResponseStream("text/plain; version=0.0.4");
+
+    res->printf("# TYPE thermal_ticks_per_us gauge\nthermal_ticks_per_us %u\n",
+        metrics_ticks_per_us());
+
+    res->print("# TYPE thermal_stage_ticks histogram\n");
+    for (int s = 0; s < METRIC_STAGE_COUNT; s++) {
+        if (!metrics_stage_on_device((MetricStage)s)) continue;
+        const MetricHistogram& h = metrics_get((MetricStage)s);
+        const char* name = metrics_stage_name((MetricStage)s);
+        uint32_t cum = 0;
+        for (int b = 0; b < METRICS_BUCKETS - 1; b++) {
+            cum += h.buckets[b];
+            res->printf("thermal_stage_ticks_bucket{stage=\"%s\",le=\"%u\"} %u\n",
+                name, 1u << (b + METRICS_BUCKET_SHIFT + 1), cum);
+        }
+        res->printf("thermal_stage_ticks_bucket{stage=\"%s\",le=\"+Inf\"} %u\n", name, h.count);
+        char sum[21];
+        res->printf("thermal_stage_ticks_sum{stage=\"%s\"} %s\n", name, u64_dec(h.sum, sum));
+        res->printf("thermal_stage_ticks_count{stage=\"%s\"} %u\n", name, h.count);
+        res->printf("thermal_stage_ticks_min{stage=\"%s\"} %u\n", name, h.count ? h.min : 0);
+        res->printf("thermal_stage_ticks_max{stage=\"%s\"} %u\n", name, h.max);
+    }
+
+    res->print("# TYPE thermal_task_runs_total counter\n");
+    for (int i = 0; i < sched_task_count(); i++) {
+        res->printf("thermal_task_runs_total{task=\"%s\"} %u\n",
+            sched_task_name(i), sched_task_stats(i).runs);
+    }
+    res->print("# TYPE thermal_task_overruns_total counter\n");
+    for (int i = 0; i < sched_task_count(); i++) {
+        res->printf("thermal_task_overruns_total{task=\"%s\"} %u\n",
+            sched_task_name(i), sched_task_stats(i).overruns);
+    }
+    res->print("# TYPE thermal_task_jitter_max_us gauge\n");
+    for (int i = 0; i < sched_task_count(); i++) {
+        res->printf("thermal_task_jitter_max_us{task=\"%s\"} %u\n",
+            sched_task_name(i), sched_task_stats(i).max_jitter_us);
+    }
+
+    res->printf("# TYPE thermal_frames_produced_total counter\nthermal_frames_produced_total %u\n",
+        metrics_frames_produced());
+    res->printf("# TYPE thermal_frames_dropped_total counter\nthermal_frames_dropped_total %u\n",
+        ws_clients_total_dropped());
+    res->printf("# TYPE thermal_sensor_duplicates_total counter\nthermal_sensor_duplicates_total %u\n",
+        sensor_stats().duplicates);
+    res->printf("# TYPE thermal_heap_free_bytes gauge\nthermal_heap_free_bytes %u\n",
+        ESP.getFreeHeap());
+    res->printf("# TYPE thermal_heap_max_block_bytes gauge\nthermal_heap_max_block_bytes %u\n",
+        ESP.getMaxFreeBlockSize());
+    res->printf("# TYPE thermal_heap_fragmentation_percent gauge\nthermal_heap_fragmentation_percent %u\n",
+        ESP.getHeapFragmentation());
+    res->printf("# TYPE thermal_ws_clients gauge\nthermal_ws_clients %d\n", ws_clients_count());
+
+    const SnapshotStats& snap = snapshot_stats();
+    res->printf("# TYPE thermal_snapshot_requests_total counter\nthermal_snapshot_requests_total %u\n",
+        snap.requests);
+    res->printf("# TYPE thermal_snapshot_renders_total counter\nthermal_snapshot_renders_total %u\n",
+        snap.renders);
+
+    const UdpPublisherStats& udp = udp_publisher_stats();
+    res->printf("# TYPE thermal_udp_sent_total counter\nthermal_udp_sent_total %u\n", udp.sent);
+    res->printf("# TYPE thermal_udp_send_errors_total counter\nthermal_udp_send_errors_total %u\n",
+        udp.send_errors);
+
+    request->send(res);
+}
+
+// ── REST API: per-pixel NUC ─────────────────────────
+
+static void handleGetNuc(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
+    StaticJsonDocument<1536> doc;
+    const NucMap& m = nuc_map();
+
+    doc["active"]    = m.active;
+    doc["capturing"] = nuc_capturing();
+    doc["remaining"] = nuc_capture_remaining();
+    doc["point1"]    = nuc_has_point1();
+
+    // Offsets in °C for inspection
+    JsonArray offsets = doc.createNestedArray("offset");
+    for (int i = 0; i < GRID_PIXELS; i++) offsets.add(pixel_to_c(m.offset[i]));
+
+    String json;
+    serializeJson(doc, json);
+    request->send(200, "application/json", json);
+}
+
+// POST /api/nuc/capture?point=1|2&frames=N — aim the sensor at a uniform
+// surface first; point 2 needs a second surface at another temperature
+static void handleNucCapture(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
+    int point  = request->hasParam("point")  ? request->getParam("point")->value().toInt()  : 1;
+    int frames = request->hasParam("frames") ? request->getParam("frames")->value().toInt() : NUC_DEFAULT_FRAMES;
+
+    if (!nuc_capture_start((uint8_t)point, (uint16_t)constrain(frames, 1, NUC_MAX_FRAMES))) {
+        request->send(400, "application/json", "{\"error\":\"invalid point\"}");
+        return;
+    }
+    request->send(202, "application/json", "{\"ok\":true}");
+}
+
+static void handleNucClear(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
+    nuc_clear();
+    request->send(200, "application/json", "{\"ok\":true}");
+}
+
+// ── REST API: history ───────────────────────────────
+
+static uint32_t history_since_param(AsyncWebServerRequest* request) {
+    if (!request->hasParam("since")) return history_begin();
+    return history_find_since((uint32_t)strtoul(request->getParam("since")->value().c_str(), nullptr, 10));
+}
+
+// GET /api/history?since=<ms> — ws_frame_record_t records newer than
+// `since` (device millis), oldest first, generated chunk by chunk straight
+// from the ring. Records pushed after the request started are not sent.
+// If the ring overwrites a record before it is sent, the body ends early;
+// clients should drop a trailing partial record.
+static void handleGetHistory(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
+    const uint32_t first = history_since_param(request);
+    const uint32_t last  = history_end();
+
+    AsyncWebServerResponse* response = request->beginChunkedResponse("application/octet-stream",
+        [first, last](uint8_t* buffer, size_t max_len, size_t index) -> size_t {
+            const size_t rec_size = sizeof(ws_frame_record_t);
+            size_t written = 0;
+            while (written < max_len) {
+                uint32_t rec_index = first + (uint32_t)((index + written) / rec_size);
+                size_t   rec_off   = (index + written) % rec_size;
+                if (rec_index >= last) break;
+                const ws_frame_record_t* rec = history_get(rec_index);
+                if (!rec) break;   // overwritten while streaming
+                size_t n = rec_size - rec_off;
+                if (n > max_len - written) n = max_len - written;
+                memcpy(buffer + written, (const uint8_t*)rec + rec_off, n);
+                written += n;
+            }
+            return written;
+        });
+    response->addHeader("X-Record-Size", String(sizeof(ws_frame_record_t)));
+    response->addHeader("X-Record-Count", String(last - first));
+    response->addHeader("X-Device-Millis", String(millis()));
+    request->send(response);
+}
+
+// GET /api/history/stats?since=<ms> — rollup of the held frames
+static void handleGetHistoryStats(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
+    StaticJsonDocument<384> doc;
+    HistoryStats st;
+
+    doc["capacity"]  = HISTORY_FRAMES;
+    doc["device_ms"] = millis();
+    if (history_stats(history_since_param(request), st)) {
+        doc["count"]    = st.count;
+        doc["first_ms"] = st.first_ms;
+        doc["last_ms"]  = st.last_ms;
+        doc["tmin"]     = st.tmin / 100.0f;
+        doc["tmax"]     = st.tmax / 100.0f;
+        doc["tmean"]    = st.tmean / 100.0f;
+        JsonObject hot  = doc.createNestedObject("tmax_at");
+        hot["ms"]       = st.tmax_ms;
+        hot["x"]        = st.tmax_x;
+        hot["y"]        = st.tmax_y;
+    } else {
+        doc["count"]    = 0;
+    }
+
+    String json;
+    serializeJson(doc, json);
+    request->send(200, "application/json", json);
+}
+
+// ── REST API: GET /api/trend ────────────────────────
+
+// GET /api/trend?res=second|minute|hour&span=<s> — min/max/mean buckets
+// covering the last `span` seconds (default: the whole ring), oldest first.
+// Each bucket is [start_s, tmin, tmax, tmean, frames]; times are uptime
+// seconds, temperatures °C.
+static void handleGetTrend(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
+    TrendLevel level = TREND_MINUTE;
+    if (request->hasParam("res") &&
+        !trend_level_from_name(request->getParam("res")->value().c_str(), level)) {
+        request->send(400, "application/json", "{\"error\":\"res must be second, minute or hour\"}");
+        return;
+    }
+
+    uint32_t now_s = millis() / 1000;
+    uint32_t span  = request->hasParam("span")
+                   ? strtoul(request->getParam("span")->value().c_str(), nullptr, 10)
+                   : trend_capacity(level) * trend_period_s(level);
+    uint32_t since = span < now_s ? now_s - span : 0;
+
+    int first;
+    int n = trend_query(level, since, first);
+
+    AsyncResponseStream* res = request->beginResponseStream("application/json");
+    res->printf("{\"res\":\"%s\",\"period_s\":%u,\"now_s\":%u,\"buckets\":[",
+        trend_level_name(level), trend_period_s(level), now_s);
+    for (int k = 0; k < n; k++) {
+        const TrendBucket& b = trend_get(level, first + k);
+        res->printf("%s[%u,%.2f,%.2f,%.2f,%u]", k ? "," : "", b.start_s,
+            b.tmin / 100.0f, b.tmax / 100.0f,
+            b.count ? (float)b.mean_sum / b.count / 100.0f : 0.0f, b.count);
+    }
+    res->print("]}");
+    request->send(res);
+}
+
+// ── REST API: alarms ────────────────────────────────
+
+static const char* source_name(uint8_t source, char* buf, size_t len) {
+    if (source == ALARM_SOURCE_FRAME) return "frame";
+    const SystemConfig& cfg = config_get();
+    if (source < cfg.roi_count) return cfg.rois[source].name;
+    snprintf(buf, len, "roi%u", source);
+    return buf;
+}
+
+// GET /api/alarms — rules with their live state
+static void handleGetAlarms(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
+    AsyncResponseStream* res = request->beginResponseStream("application/json");
+    res->printf("{\"now_ms\":%u,\"active\":%u,\"next_event\":%u,\"rules\":[",
+        millis(), alarm_active_mask(), alarm_events_end());
+    for (int i = 0; i < alarm_rule_count(); i++) {
+        const AlarmRule&  r  = alarm_rule(i);
+        const AlarmState& st = alarm_state(i);
+        char src[8];
+        res->printf("%s{\"name\":\"%s\",\"type\":\"%s\",\"source\":\"%s\",\"enabled\":%s,"
+                    "\"active\":%s,\"value\":%.2f,\"threshold\":%.2f,\"changed_ms\":%u}",
+            i ? "," : "", r.name, alarm_type_name(r.type), source_name(r.source, src, sizeof(src)),
+            r.enabled ? "true" : "false", st.active ? "true" : "false",
+            st.value, r.threshold, st.changed_ms);
+    }
+    res->print("]}");
+    request->send(res);
+}
+
+// GET /api/events?since=<id> — the event log from `since` on (all held
+// events by default). `next` is the id to ask for next time.
+static void handleGetEvents(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
+    uint32_t id = alarm_events_begin();
+    if (request->hasParam("since")) {
+        uint32_t since = strtoul(request->getParam("since")->value().c_str(), nullptr, 10);
+        if (since > id) id = since;
+    }
+
+    AsyncResponseStream* res = request->beginResponseStream("application/json");
+    res->printf("{\"now_ms\":%u,\"first\":%u,\"next\":%u,\"events\":[",
+        millis(), alarm_events_begin(), alarm_events_end());
+    for (bool first = true; id < alarm_events_end(); id++) {
+        const AlarmEvent* e = alarm_event_get(id);
+        if (!e) continue;
+        res->printf("%s{\"id\":%u,\"t\":%u,\"rule\":%u,\"name\":\"%s\",\"kind\":\"%s\","
+                    "\"value\":%.2f,\"x\":%u,\"y\":%u}",
+            first ? "" : ",", e->id, e->timestamp_ms, e->rule,
+            e->rule < alarm_rule_count() ? alarm_rule(e->rule).name : "",
+            e->kind == ALARM_EVENT_RAISE ? "raise" : "clear",
+            e->value / 100.0f, e->x, e->y);
+        first = false;
+    }
+    res->print("]}");
+    request->send(res);
+}
+
+// ── REST API: recordings ────────────────────────────
+
+// GET /api/recording — recorder state and the segments on flash
+static void handleGetRecording(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
+    StaticJsonDocument<1536> doc;
+    const RecorderStats& st = recorder_stats();
+
+    doc["active"]           = recorder_active();
+    doc["frames"]           = st.frames;
+    doc["dropped"]          = st.dropped;
+    doc["bytes_written"]    = st.bytes_written;
+    doc["pages_written"]    = st.pages_written;
+    doc["segments_rotated"] = st.segments_rotated;
+    doc["write_errors"]     = st.write_errors;
+    doc["start_failures"]   = st.start_failures;
+    doc["max_write_us"]     = st.max_write_us;
+
+    JsonArray segs = doc.createNestedArray("segments");
+    RecSegmentInfo info;
+    for (int i = 0; i < recorder_segment_count(); i++) {
+        if (!recorder_segment_info(i, info)) continue;
+        JsonObject o = segs.createNestedObject();
+        o["id"]          = info.id;
+        o["bytes"]       = info.bytes;
+        o["first_ms"]    = info.first_ms;
+        o["last_key_ms"] = info.last_key_ms;
+    }
+
     String json;
     serializeJson(doc, json);
     request->send(200, "application/json", json);
 }
 
+// GET /api/recording/download?from=<ms>&to=<ms> — length-prefixed v2
+// frames ([u8 len][frame]) from the keyframe at or before `from` up to the
+// first keyframe after `to`, streamed from flash in chunks
+static void handleRecordingDownload(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
+    uint32_t from = request->hasParam("from") ? strtoul(request->getParam("from")->value().c_str(), nullptr, 10) : 0;
+    uint32_t to   = request->hasParam("to")   ? strtoul(request->getParam("to")->value().c_str(), nullptr, 10) : UINT32_MAX;
+
+    RecCursor cur;
+    if (!recorder_seek(from, to, cur)) {
+        request->send(404, "application/json", "{\"error\":\"nothing recorded\"}");
+        return;
+    }
+
+    AsyncWebServerResponse* response = request->beginChunkedResponse("application/octet-stream",
+        [cur](uint8_t* buffer, size_t max_len, size_t index) mutable -> size_t {
+            return recorder_read(cur, buffer, max_len);
+        });
+    response->addHeader("Content-Disposition", "attachment; filename=\"recording.v2s\"");
+    request->send(response);
+}
+
+// ── REST API: snapshots ─────────────────────────────
+
+// Newest frame, copied so a response does not depend on the history ring
+static bool latest_record(ws_frame_record_t& rec) {
+    if (history_count() == 0) return false;
+    const ws_frame_record_t* r = history_get(history_end() - 1);
+    if (!r) return false;
+    rec = *r;
+    return true;
+}
+
+static void add_frame_headers(AsyncWebServerResponse* response, const ws_frame_record_t& rec) {
+    response->addHeader("Cache-Control", "no-cache");
+    response->addHeader("X-Frame-Seq", String(rec.seq));
+    response->addHeader("X-Frame-Millis", String(rec.timestamp_ms));
+    response->addHeader("X-Device-Millis", String(millis()));
+}
+
+// GET /api/frame.bin — newest frame as one ws_frame_record_t
+static void handleFrameBin(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
+    ws_frame_record_t rec;
+    if (!latest_record(rec)) {
+        request->send(503, "application/json", "{\"error\":\"no frame yet\"}");
+        return;
+    }
+    AsyncWebServerResponse* response = request->beginResponse("application/octet-stream", sizeof(rec),
+        [rec](uint8_t* buffer, size_t max_len, size_t index) -> size_t {
+            size_t n = sizeof(rec) - index;
+            if (n > max_len) n = max_len;
+            memcpy(buffer, (const uint8_t*)&rec + index, n);
+            return n;
+        });
+    add_frame_headers(response, rec);
+    request->send(response);
+}
+
+// GET /api/frame.bmp|png?scale=1..SNAPSHOT_MAX_SCALE&interp=nearest|bilinear&min=<C>&max=<C>
+// Newest frame in the ironbow palette; min/max fix the colour range,
+// otherwise it follows the frame. Rendered once per frame and parameters,
+// and generated chunk by chunk from that cache.
+static void sendSnapshot(AsyncWebServerRequest* request, uint8_t format) {
+    MetricScope scope(METRIC_HTTP);
+    ws_frame_record_t rec;
+    if (!latest_record(rec)) {
+        request->send(503, "application/json", "{\"error\":\"no frame yet\"}");
+        return;
+    }
+
+    SnapshotParams p;
+    p.scale      = request->hasParam("scale")
+                 ? constrain(request->getParam("scale")->value().toInt(), 1, SNAPSHOT_MAX_SCALE)
+                 : SNAPSHOT_DEFAULT_SCALE;
+    p.bilinear   = !(request->hasParam("interp") && request->getParam("interp")->value() == "nearest");
+    p.auto_range = !(request->hasParam("min") && request->hasParam("max"));
+    p.lo = p.hi  = 0;
+    if (!p.auto_range) {
+        p.lo = (int16_t)constrain(request->getParam("min")->value().toFloat() * 100.0f, -30000.0f, 30000.0f);
+        p.hi = (int16_t)constrain(request->getParam("max")->value().toFloat() * 100.0f, -30000.0f, 30000.0f);
+    }
+
+    SnapshotStream st;
+    snapshot_begin(rec, format, p, st);
+    AsyncWebServerResponse* response = request->beginResponse(snapshot_content_type(format), st.length,
+        [st](uint8_t* buffer, size_t max_len, size_t index) -> size_t {
+            return snapshot_read(st, index, buffer, max_len);
+        });
+    add_frame_headers(response, rec);
+    request->send(response);
+}
+
+static void handleFrameBmp(AsyncWebServerRequest* request) { sendSnapshot(request, SNAPSHOT_BMP); }
+static void handleFramePng(AsyncWebServerRequest* request) { sendSnapshot(request, SNAPSHOT_PNG); }
+
 // ── REST API: POST /api/config ──────────────────────
 
 // Body handler: accumulates incoming data
@@ -97,12 +758,13 @@ static void handlePostConfigBody(AsyncWebServerRequest* request,
 
 // Request handler: called after body is complete
 static void handlePostConfigRequest(AsyncWebServerRequest* request) {
+    MetricScope scope(METRIC_HTTP);
     if (!post_body_ready || post_body_len == 0) {
         request->send(400, "application/json", "{\"error\":\"no body\"}");
         return;
     }
 
-    StaticJsonDocument<512> doc;
+    DynamicJsonDocument doc(CONFIG_JSON_CAPACITY);
     DeserializationError err = deserializeJson(doc, post_body_buf, post_body_len);
     if (err) {
         Serial.printf("[Web] POST /api/config parse error: %s\n", err.c_str());
@@ -135,9 +797,35 @@ static void handlePostConfigRequest(AsyncWebServerRequest* request) {
     if (doc.containsKey("alpha"))
         cfg.alpha = config_clamp_alpha(doc["alpha"]);
 
+    if (doc.containsKey("filter_mode"))
+        cfg.filter_mode = ((int)doc["filter_mode"] == FILTER_MODE_ADAPTIVE)
+                          ? FILTER_MODE_ADAPTIVE : FILTER_MODE_IIR;
+
+    if (doc.containsKey("adaptive_threshold"))
+        cfg.adaptive_threshold = config_clamp_threshold(doc["adaptive_threshold"]);
+
     if (doc.containsKey("calibration_offset"))
         cfg.calibration_offset = config_clamp_offset(doc["calibration_offset"]);
 
+    if (doc.containsKey("batch_frames"))
+        cfg.batch_frames = config_clamp_batch_frames(doc["batch_frames"]);
+
+    if (doc.containsKey("batch_max_ms"))
+        cfg.batch_max_ms = config_clamp_batch_ms(doc["batch_max_ms"]);
+
+    batch_configure(cfg.batch_frames, cfg.batch_max_ms);
+
+    if (doc.containsKey("record_enabled")) {
+        cfg.record_enabled = doc["record_enabled"];
+        recorder_request(cfg.record_enabled);
+    }
+
+    if (doc.containsKey("rois"))
+        config_rois_from_json(doc["rois"], cfg);
+
+    if (doc.containsKey("alarms"))
+        config_alarms_from_json(doc["alarms"], cfg);
+
     if (doc.containsKey("sta_enabled")) {
         bool new_val = doc["sta_enabled"];
         if (new_val != cfg.sta_enabled) {
@@ -160,7 +848,22 @@ static void handlePostConfigRequest(AsyncWebServerRequest* request) {
         need_wifi_restart = true;
     }
 
-    config_save();
+    if (doc.containsKey("udp_enabled"))
+        cfg.udp_enabled = doc["udp_enabled"];
+
+    if (doc.containsKey("udp_group") && !udp_parse_addr(doc["udp_group"].as<const char*>(), cfg.udp_group))
+        Serial.println("[Web] Ignoring malformed udp_group");
+
+    if (doc.containsKey("udp_port"))
+        cfg.udp_port = constrain((int)doc["udp_port"], 1, 65535);
+
+    if (doc.containsKey("udp_every"))
+        cfg.udp_every = constrain((int)doc["udp_every"], 1, 255);
+
+    udp_publisher_configure(cfg.udp_enabled, cfg.udp_group, cfg.udp_port, cfg.udp_every);
+
+    // Written once the UI stops sending changes (task "config")
+    config_request_save(millis());
 
     // Send response BEFORE restarting WiFi
     request->send(200, "application/json", "{\"ok\":true}");
@@ -173,16 +876,80 @@ static void handlePostConfigRequest(AsyncWebServerRequest* request) {
     }
 }
 
+// ── Static files ────────────────────────────────────
+
+// Files listed in the build manifest, with ETag / 304 and cache headers
+// from web_asset_reply()
+class WebAssetHandler : public AsyncWebHandler {
+public:
+    bool canHandle(AsyncWebServerRequest* request) override {
+        if (request->method() != HTTP_GET) return false;
+        if (!web_asset_find(request->url().c_str())) return false;
+        request->addInterestingHeader("If-None-Match");
+        return true;
+    }
+
+    void handleRequest(AsyncWebServerRequest* request) override {
+        String inm = request->hasHeader("If-None-Match") ? request->header("If-None-Match") : String();
+        WebAssetReply r;
+        web_asset_reply(request->url().c_str(), inm.c_str(), r);
+
+        AsyncWebServerResponse* response;
+        if (r.status == 304) {
+            response = request->beginResponse(304);
+        } else {
+            File f = LittleFS.open(r.path, "r");
+            if (!f) {
+                request->send(404);
+                return;
+            }
+            // The path keeps its .gz, so the library adds no encoding of its own
+            response = request->beginResponse(f, r.path, r.content_type);
+            if (r.content_encoding) response->addHeader("Content-Encoding", r.content_encoding);
+        }
+        response->addHeader("ETag", r.asset->etag);
+        response->addHeader("Cache-Control", r.cache_control);
+        request->send(response);
+    }
+
+    bool isRequestHandlerTrivial() override { return true; }
+};
+
 // ── Init ────────────────────────────────────────────
 
 void webserver_init() {
-    // Serve static files from LittleFS — no cache to avoid stale JS
-    server.serveStatic("/", LittleFS, "/www/")
-        .setDefaultFile("index.html")
-        .setCacheControl("no-cache, no-store, must-revalidate");
+    if (web_assets_load() > 0) {
+        server.addHandler(new WebAssetHandler());
+        Serial.printf("[Web] %d static assets from manifest\n", web_asset_count());
+    } else {
+        // data/www uploaded as is, without tools/build_web.py: no cache to
+        // avoid stale JS
+        Serial.println("[Web] No asset manifest, serving /www/ uncached");
+        server.serveStatic("/", LittleFS, "/www/")
+            .setDefaultFile("index.html")
+            .setCacheControl("no-cache, no-store, must-revalidate");
+    }
 
     // API endpoints
     server.on("/api/config", HTTP_GET, handleGetConfig);
+    server.on("/api/clients", HTTP_GET, handleGetClients);
+    server.on("/api/tasks",   HTTP_GET, handleGetTasks);
+    server.on("/api/metrics", HTTP_GET, handleGetMetrics);
+    server.on("/api/trend",   HTTP_GET, handleGetTrend);
+    server.on("/api/alarms",  HTTP_GET, handleGetAlarms);
+    server.on("/api/events",  HTTP_GET, handleGetEvents);
+    server.on("/api/frame.bin", HTTP_GET, handleFrameBin);
+    server.on("/api/frame.bmp", HTTP_GET, handleFrameBmp);
+    server.on("/api/frame.png", HTTP_GET, handleFramePng);
+
+    // Sub-paths first: a handler for /x also matches /x/...
+    server.on("/api/nuc/capture", HTTP_POST, handleNucCapture);
+    server.on("/api/nuc/clear",   HTTP_POST, handleNucClear);
+    server.on("/api/nuc",         HTTP_GET,  handleGetNuc);
+    server.on("/api/recording/download", HTTP_GET, handleRecordingDownload);
+    server.on("/api/recording",          HTTP_GET, handleGetRecording);
+    server.on("/api/history/stats", HTTP_GET, handleGetHistoryStats);
+    server.on("/api/history",       HTTP_GET, handleGetHistory);
 
     // POST config — request handler processes after body is accumulated
     server.on("/api/config", HTTP_POST,
@@ -191,6 +958,13 @@ void webserver_init() {
         handlePostConfigBody);
 
     // WebSocket
+    ws_clients_init();
+    memset(&heap_stats, 0, sizeof(heap_stats));
+    ws_v2_encoder_init(v2_enc[WS_QUANT_I16], WS_QUANT_I16, WS_V2_EXT_ROI | WS_V2_EXT_TIMING);
+    ws_v2_encoder_init(v2_enc[WS_QUANT_I8],  WS_QUANT_I8,  WS_V2_EXT_ROI | WS_V2_EXT_TIMING);
+    batch_init();
+    batch_configure(config_get().batch_frames, config_get().batch_max_ms);
+    events_sent = alarm_events_end();
     ws.onEvent(onWsEvent);
     server.addHandler(&ws);
 
@@ -198,15 +972,257 @@ void webserver_init() {
     Serial.println("[Web] Server started on port 80");
 }
 
+// Sends the buffered records as one message to every batch subscriber.
+// The message buffer is filled in place, so a batch costs one heap block
+// however many clients receive it.
+static void send_batch(uint32_t now_ms) {
+    bool any = false;
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        WsClientSlot* c = ws_clients_at(i);
+        if (c && c->channel == WS_CHANNEL_BATCH) any = true;
+    }
+    if (!any) {
+        batch_clear();
+        return;
+    }
+
+    size_t len = batch_size();
+    AsyncWebSocketMessageBuffer* msg = ws.makeBuffer(len);
+    if (!msg) return;   // keep the records and retry on the next tick
+    msg->lock();
+    batch_flush((uint8_t*)msg->get(), now_ms);
+    heap_stats.allocs++;
+    heap_stats.alloc_bytes += len;
+
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        WsClientSlot* c = ws_clients_at(i);
+        if (!c || c->channel != WS_CHANNEL_BATCH) continue;
+
+        AsyncWebSocketClient* client = ws.client(c->id);
+        if (!client || client->status() != WS_CONNECTED) continue;
+
+        if (ws_client_policy(*c, client->queueLen(), true) != WS_SEND_SKIP) {
+            client->binary(msg);
+        }
+    }
+
+    msg->unlock();
+    ws._cleanBuffers();
+}
+
 void webserver_loop() {
     if (wifi_restart_pending && millis() >= wifi_restart_at_ms) {
         wifi_restart_pending = false;
         Serial.println("[Web] Applying deferred WiFi restart");
         wifi_init();
     }
+
+    // Flush-on-timeout for the batch channel
+    if (batch_due(millis())) send_batch(millis());
 }
 
-void webserver_broadcast(const uint8_t* data, size_t len) {
-    ws.binaryAll(const_cast<uint8_t*>(data), len);
+void webserver_cleanup() {
     ws.cleanupClients();
 }
+
+// Allocates the message buffer an encoding is written into; nullptr if
+// the heap is short, in which case the encoding is skipped this frame
+static uint8_t* encoding_alloc(Encoding& e, size_t len) {
+    e.msg = ws.makeBuffer(len);
+    if (!e.msg) {
+        heap_stats.alloc_failed++;
+        return nullptr;
+    }
+    e.msg->lock();
+    heap_stats.last_allocs++;
+    heap_stats.last_alloc_bytes += len;
+    return (uint8_t*)e.msg->get();
+}
+
+static bool encoding_send(AsyncWebSocketClient* client, Encoding& e) {
+    if (!e.msg) return false;
+    client->binary(e.msg);
+    return true;
+}
+
+static void encoding_release(Encoding& e) {
+    if (e.msg) e.msg->unlock();
+    e.msg = nullptr;
+}
+
+// Sends `frame_enc` to every due frame-channel client using the given
+// format/quant, subject to each client's backpressure policy. Clients
+// resuming after a drop, a decimated gap or a join get a keyframe of the
+// current stream state (encoded lazily).
+static void send_to_format(uint8_t format, uint8_t quant, const bool* due,
+                           Encoding& frame_enc, bool is_key, const Frame& frame)
+{
+    Encoding key_enc = { nullptr };
+    bool     key_built = false;
+
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        WsClientSlot* c = ws_clients_at(i);
+        if (!c || !due[i] || c->channel != WS_CHANNEL_FRAMES || c->format != format) continue;
+        if (format == WS_FORMAT_V2 && c->quant != quant) continue;
+
+        AsyncWebSocketClient* client = ws.client(c->id);
+        if (!client || client->status() != WS_CONNECTED) continue;
+
+        switch (ws_client_policy(*c, client->queueLen(), is_key)) {
+            case WS_SEND_SKIP:
+                break;
+            case WS_SEND_RESYNC:
+                if (!key_built) {
+                    key_built = true;
+                    size_t   len = ws_v2_resync_size(v2_enc[quant], frame);
+                    uint8_t* out = encoding_alloc(key_enc, len);
+                    if (out) {
+                        ws_v2_encode_resync(v2_enc[quant], frame, out);
+                        ws_v2_stamp_enqueue(out, len, frame.capture_us, micros());
+                    }
+                }
+                encoding_send(client, key_enc);
+                break;
+            case WS_SEND_FRAME:
+                encoding_send(client, frame_enc);
+                break;
+        }
+    }
+
+    encoding_release(key_enc);
+}
+
+static void send_stats(const bool* due, Encoding& stats_enc) {
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        WsClientSlot* c = ws_clients_at(i);
+        if (!c || !due[i] || c->channel != WS_CHANNEL_STATS) continue;
+
+        AsyncWebSocketClient* client = ws.client(c->id);
+        if (!client || client->status() != WS_CONNECTED) continue;
+
+        if (ws_client_policy(*c, client->queueLen(), true) != WS_SEND_SKIP) {
+            encoding_send(client, stats_enc);
+        }
+    }
+}
+
+void webserver_push_events() {
+    // Events are rare and small: each goes to every event subscriber,
+    // without the frame backpressure policy
+    while (events_sent != alarm_events_end()) {
+        const AlarmEvent* ev = alarm_event_get(events_sent++);
+        if (!ev) continue;   // evicted before it could be sent
+
+        uint8_t buf[sizeof(ws_event_packet_t)];
+        size_t  len = ws_event_encode(*ev, alarm_active_mask(), buf);
+        AsyncWebSocketMessageBuffer* msg = nullptr;
+
+        for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+            WsClientSlot* c = ws_clients_at(i);
+            if (!c || !c->events) continue;
+
+            AsyncWebSocketClient* client = ws.client(c->id);
+            if (!client || client->status() != WS_CONNECTED) continue;
+
+            if (!msg) {
+                if ((msg = ws.makeBuffer(buf, len)) == nullptr) break;
+                msg->lock();
+                heap_stats.allocs++;
+                heap_stats.alloc_bytes += len;
+            }
+            client->binary(msg);
+        }
+        if (msg) msg->unlock();
+    }
+    ws._cleanBuffers();
+}
+
+void webserver_broadcast(const Frame& frame) {
+    // Only encodings some due subscriber needs are built this frame
+    bool due[WS_MAX_CLIENTS];
+    bool want_v1    = false;
+    bool want_v2[2] = { false, false };
+    bool want_stats = false;
+    bool want_batch = false;
+
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        WsClientSlot* c = ws_clients_at(i);
+        due[i] = c && ws_client_due(*c);
+        if (!due[i]) continue;
+        if (c->channel == WS_CHANNEL_EVENTS)     continue;
+        else if (c->channel == WS_CHANNEL_BATCH) want_batch = true;
+        else if (c->channel == WS_CHANNEL_STATS) want_stats = true;
+        else if (c->format == WS_FORMAT_V2)      want_v2[c->quant] = true;
+        else                                     want_v1 = true;
+    }
+
+    uint32_t t_start     = metrics_now();
+    uint32_t encode      = 0;   // ticks spent in encoders
+    uint32_t heap_before = ESP.getFreeHeap();
+    heap_stats.last_allocs      = 0;
+    heap_stats.last_alloc_bytes = 0;
+
+    if (want_v1) {
+        Encoding enc = { nullptr };
+        uint32_t t0 = metrics_now();
+        uint8_t* out = encoding_alloc(enc, sizeof(ws_payload_t));
+        if (out) ws_v1_encode(frame, out);
+        encode += metrics_now() - t0;
+        send_to_format(WS_FORMAT_V1, 0, due, enc, true, frame);
+        encoding_release(enc);
+    }
+
+    for (uint8_t q = WS_QUANT_I16; q <= WS_QUANT_I8; q++) {
+        Encoding enc = { nullptr };
+        if (!want_v2[q]) {
+            // Nobody decodes this stream; restart it with a keyframe later
+            v2_enc[q].primed = false;
+            continue;
+        }
+        uint32_t t0  = metrics_now();
+        size_t   len = ws_v2_prepare(v2_enc[q], frame);
+        uint8_t* out = encoding_alloc(enc, len);
+        if (!out) {
+            // No buffer this frame: clients see a seq gap, so restart the
+            // stream with a keyframe
+            v2_enc[q].primed = false;
+            encode += metrics_now() - t0;
+            continue;
+        }
+        ws_v2_write(v2_enc[q], frame, out);
+        encode += metrics_now() - t0;
+        bool is_key = ((const ws_v2_header_t*)out)->kind == WS_V2_KEYFRAME;
+        // Stamped before any client queue can start sending the buffer
+        ws_v2_stamp_enqueue(out, len, frame.capture_us, micros());
+        send_to_format(WS_FORMAT_V2, q, due, enc, is_key, frame);
+        encoding_release(enc);
+    }
+
+    if (want_stats) {
+        Encoding enc = { nullptr };
+        uint32_t t0 = metrics_now();
+        uint8_t* out = encoding_alloc(enc, ws_stats_size(frame));
+        if (out) ws_stats_encode(frame, out);
+        encode += metrics_now() - t0;
+        send_stats(due, enc);
+        encoding_release(enc);
+    }
+
+    if (want_batch) {
+        uint32_t t0 = metrics_now();
+        batch_push(frame);
+        encode += metrics_now() - t0;
+        if (batch_due(frame.timestamp_ms)) send_batch(frame.timestamp_ms);
+    }
+
+    // Free message buffers no client queue references any more
+    ws._cleanBuffers();
+
+    heap_stats.frames++;
+    heap_stats.allocs          += heap_stats.last_allocs;
+    heap_stats.alloc_bytes     += heap_stats.last_alloc_bytes;
+    heap_stats.last_heap_delta  = (int32_t)ESP.getFreeHeap() - (int32_t)heap_before;
+
+    metrics_record(METRIC_PAYLOAD, encode);
+    metrics_record(METRIC_BROADCAST, metrics_now() - t_start - encode);
+}
@@ -2,9 +2,12 @@
 #define APP_WEBSERVER_H
 
 #include <Arduino.h>
+#include "frame.h"
 
 void webserver_init();
-void webserver_loop();  // call from main loop — handles deferred WiFi restart
-void webserver_broadcast(const uint8_t* data, size_t len);
+void webserver_loop();     // call periodically — handles deferred WiFi restart
+void webserver_cleanup();  // call periodically — reaps disconnected clients
+void webserver_broadcast(const Frame& frame);  // encodes once per wire format in use
+void webserver_push_events();  // sends alarm events logged since the last call
 
 #endif
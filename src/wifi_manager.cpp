@@ -1,6 +1,7 @@
 #include "wifi_manager.h"
 #include "config.h"
 #include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
 
 #define AP_SSID     "THERMAL_ESP"
 #define AP_PASSWORD "thermal1234"
@@ -8,6 +9,7 @@
 
 static bool sta_was_connected = false;
 static bool ap_started = false;
+static WiFiUDP udp;
 
 static void ensure_ap() {
     if (ap_started) return;
@@ -67,3 +69,21 @@ String wifi_sta_ip() {
     }
     return "";
 }
+
+// ── UDP transport ───────────────────────────────────
+
+static bool udp_send(const uint8_t addr[4], uint16_t port, const uint8_t* data, size_t len) {
+    IPAddress ip(addr[0], addr[1], addr[2], addr[3]);
+    bool multicast = addr[0] >= 224 && addr[0] <= 239;
+    int ok = multicast ? udp.beginPacketMulticast(ip, port, WiFi.localIP(), 1)
+                       : udp.beginPacket(ip, port);
+    if (!ok) return false;
+    udp.write(data, len);
+    return udp.endPacket() == 1;
+}
+
+static const UdpSink wifi_udp = { udp_send };
+
+const UdpSink* wifi_udp_sink() {
+    return &wifi_udp;
+}
@@ -2,10 +2,15 @@
 #define WIFI_MANAGER_H
 
 #include <Arduino.h>
+#include "udp_publisher.h"
 
 void wifi_init();
 void wifi_update();           // call periodically to monitor STA
 bool wifi_sta_connected();
 String wifi_sta_ip();
 
+// WiFiUDP transport for udp_publisher; multicast groups go out on the STA
+// interface with TTL 1
+const UdpSink* wifi_udp_sink();
+
 #endif
@@ -0,0 +1,130 @@
+#include "ws_clients.h"
+#include "ws_protocol.h"
+
+static_assert(sizeof(ws_ping_t) == 12, "ping layout changed");
+static_assert(sizeof(ws_pong_packet_t) == 28, "pong layout changed");
+static_assert(sizeof(ws_echo_t) == 32, "echo layout changed");
+
+static WsClientSlot clients[WS_MAX_CLIENTS];
+static uint32_t     total_dropped = 0;
+
+void ws_clients_init() {
+    memset(clients, 0, sizeof(clients));
+    total_dropped = 0;
+}
+
+WsClientSlot* ws_clients_add(uint32_t id) {
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (!clients[i].in_use) {
+            memset(&clients[i], 0, sizeof(clients[i]));
+            clients[i].id     = id;
+            clients[i].in_use = true;
+            clients[i].format = WS_FORMAT_V1;
+            clients[i].channel = WS_CHANNEL_FRAMES;
+            clients[i].every  = 1;
+            return &clients[i];
+        }
+    }
+    return nullptr;
+}
+
+void ws_clients_remove(uint32_t id) {
+    WsClientSlot* c = ws_clients_find(id);
+    if (c) c->in_use = false;
+}
+
+WsClientSlot* ws_clients_find(uint32_t id) {
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (clients[i].in_use && clients[i].id == id) return &clients[i];
+    }
+    return nullptr;
+}
+
+WsClientSlot* ws_clients_at(int index) {
+    if (index < 0 || index >= WS_MAX_CLIENTS) return nullptr;
+    return clients[index].in_use ? &clients[index] : nullptr;
+}
+
+uint32_t ws_clients_total_dropped() {
+    return total_dropped;
+}
+
+int ws_clients_count() {
+    int n = 0;
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (clients[i].in_use) n++;
+    }
+    return n;
+}
+
+bool ws_client_due(WsClientSlot& c) {
+    if (c.countdown > 0) {
+        c.countdown--;
+        if (c.format == WS_FORMAT_V2) c.need_key = true;
+        return false;
+    }
+    c.countdown = c.every > 1 ? c.every - 1 : 0;
+    return true;
+}
+
+WsSendAction ws_client_policy(WsClientSlot& c, size_t queue_depth, bool frame_is_key) {
+    c.queue_depth = (uint16_t)queue_depth;
+
+    if (queue_depth >= WS_CLIENT_QUEUE_WATERMARK) {
+        c.dropped++;
+        total_dropped++;
+        // A skipped v2 frame breaks the delta chain
+        if (c.format == WS_FORMAT_V2) c.need_key = true;
+        return WS_SEND_SKIP;
+    }
+
+    WsSendAction action = (c.need_key && !frame_is_key) ? WS_SEND_RESYNC : WS_SEND_FRAME;
+    c.need_key = false;
+    c.sent++;
+    return action;
+}
+
+// ── Link telemetry ──────────────────────────────────
+
+size_t ws_client_ping(WsClientSlot& c, const uint8_t* msg, size_t len,
+                      uint32_t now_ms, uint32_t now_us, uint8_t* reply) {
+    if (len < sizeof(ws_ping_t)) return 0;
+    ws_ping_t ping;
+    memcpy(&ping, msg, sizeof(ping));
+
+    ws_pong_packet_t pong;
+    pong.type      = WS_PKT_PONG;
+    pong.reserved  = 0;
+    pong.id        = ping.id;
+    pong.client_ms = ping.client_ms;
+    pong.device_ms = now_ms;
+    pong.device_us = now_us;
+    pong.offset_ms = c.clock_offset_ms;
+    pong.rtt_us    = c.rtt_us;
+    memcpy(reply, &pong, sizeof(pong));
+    return sizeof(pong);
+}
+
+bool ws_client_echo(WsClientSlot& c, const uint8_t* msg, size_t len, uint32_t now_us) {
+    if (len < sizeof(ws_echo_t)) return false;
+    ws_echo_t echo;
+    memcpy(&echo, msg, sizeof(echo));
+
+    uint32_t rtt = now_us - echo.device_us;
+    c.pings++;
+    c.rtt_us     = rtt;
+    c.rtt_avg_us = c.pings == 1 ? rtt : c.rtt_avg_us - c.rtt_avg_us / 8 + rtt / 8;
+    if (c.rtt_min_us == 0 || rtt < c.rtt_min_us) c.rtt_min_us = rtt;
+
+    // The pong left at device_ms and, on a symmetric path, arrived at the
+    // client half a round trip later
+    if (rtt <= c.rtt_min_us + WS_CLOCK_RTT_SLACK_US) {
+        double device_at_arrival = (double)echo.device_ms + rtt / 2000.0;
+        c.clock_offset_ms = (int32_t)lround(echo.client_ms - device_at_arrival);
+    }
+
+    c.client_frames = echo.frames;
+    c.client_lost   = echo.lost;
+    c.latency_ms    = echo.latency_ms;
+    return true;
+}
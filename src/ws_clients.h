@@ -0,0 +1,80 @@
+#ifndef WS_CLIENTS_H
+#define WS_CLIENTS_H
+
+#include <Arduino.h>
+
+// Fixed table of WebSocket client state, independent of the async library
+// so the send policy can be exercised without a network stack.
+
+#define WS_MAX_CLIENTS              8
+
+// A client with this many messages still queued in AsyncTCP skips frames
+// until it drains, then resumes with the newest frame.
+#define WS_CLIENT_QUEUE_WATERMARK   3
+
+struct WsClientSlot {
+    uint32_t id;
+    bool     in_use;
+    uint8_t  format;       // WS_FORMAT_V1 / WS_FORMAT_V2
+    uint8_t  quant;        // WS_QUANT_* (v2 only)
+    bool     need_key;     // must receive a keyframe before any delta
+    uint8_t  channel;      // WS_CHANNEL_*
+    uint8_t  every;        // send every Nth frame (1 = all)
+    uint8_t  countdown;    // frames until the next due one
+    bool     events;       // push alarm events (WS_CHANNEL_EVENTS or WS_SUB_EVENTS)
+    uint32_t sent;
+    uint32_t dropped;
+    uint16_t queue_depth;  // last observed AsyncTCP message queue length
+
+    // Link telemetry from WS_MSG_PING / WS_MSG_ECHO (0 until measured)
+    uint32_t pings;
+    uint32_t rtt_us;           // last round trip, device clock
+    uint32_t rtt_min_us;
+    uint32_t rtt_avg_us;       // EWMA, 1/8
+    int32_t  clock_offset_ms;  // client clock - device clock
+    uint32_t client_frames;    // as reported by the client
+    uint32_t client_lost;
+    uint16_t latency_ms;       // capture -> displayed, client-measured
+};
+
+enum WsSendAction : uint8_t {
+    WS_SEND_SKIP,     // queue over watermark — drop this frame
+    WS_SEND_FRAME,    // send the shared encoding
+    WS_SEND_RESYNC,   // send a keyframe of the current stream state
+};
+
+void          ws_clients_init();
+WsClientSlot* ws_clients_add(uint32_t id);   // nullptr if table is full
+void          ws_clients_remove(uint32_t id);
+WsClientSlot* ws_clients_find(uint32_t id);
+WsClientSlot* ws_clients_at(int index);      // nullptr for free slots
+int           ws_clients_count();
+uint32_t      ws_clients_total_dropped();  // includes disconnected clients
+
+// Decimation: true if the client wants the current frame. Called once per
+// produced frame; a skipped frame forces a v2 client back to a keyframe.
+bool          ws_client_due(WsClientSlot& c);
+
+// Per-frame send decision. `frame_is_key` is true for frames that stand on
+// their own (all v1 frames, v2 keyframes). Updates the slot's counters.
+WsSendAction  ws_client_policy(WsClientSlot& c, size_t queue_depth, bool frame_is_key);
+
+// ── Link telemetry ──
+// The client pings with its clock, the device answers with a pong carrying
+// its own clock, and the client echoes the pong straight back. The echo
+// gives the round trip on the device clock alone; the client timestamp
+// taken when the pong arrived gives the clock offset, assuming a
+// symmetric path. Only samples whose round trip is within
+// WS_CLOCK_RTT_SLACK_US of the best seen update the offset: queueing
+// delay on a slow sample is rarely symmetric.
+#define WS_CLOCK_RTT_SLACK_US      2000
+
+// Builds the pong for a WS_MSG_PING. Returns bytes written to `reply`
+// (sizeof(ws_pong_packet_t)), or 0 if the message is malformed.
+size_t        ws_client_ping(WsClientSlot& c, const uint8_t* msg, size_t len,
+                             uint32_t now_ms, uint32_t now_us, uint8_t* reply);
+
+// Folds a WS_MSG_ECHO into the slot. Returns false if malformed.
+bool          ws_client_echo(WsClientSlot& c, const uint8_t* msg, size_t len, uint32_t now_us);
+
+#endif
@@ -0,0 +1,325 @@
+#include "ws_codec.h"
+
+static_assert(sizeof(ws_payload_t) == 24 + 4 * GRID_PIXELS, "v1 payload layout changed");
+static_assert(sizeof(ws_v2_header_t) == 25, "v2 header layout changed");
+static_assert(sizeof(ws_stats_packet_t) == 17, "stats packet layout changed");
+static_assert(sizeof(ws_frame_record_t) == 16 + 2 * GRID_PIXELS, "frame record layout changed");
+static_assert(sizeof(ws_batch_header_t) == 8, "batch header layout changed");
+static_assert(sizeof(ws_roi_t) == 12, "ROI block layout changed");
+static_assert(sizeof(ws_event_packet_t) == 16, "event packet layout changed");
+static_assert(sizeof(ws_timing_t) == 12, "timing trailer layout changed");
+static_assert(WS_ROI_MAX == ROI_MAX, "ROI trailer and engine disagree on the ROI limit");
+
+// ── v1 ──────────────────────────────────────────────
+
+size_t ws_v1_encode(const Frame& frame, uint8_t* out) {
+    ws_payload_t* p = (ws_payload_t*)out;
+
+    p->timestamp_ms       = frame.timestamp_ms;
+    p->current_fps        = frame.current_fps;
+    p->flags              = frame.flags;
+    p->calibration_offset = frame.calibration_offset;
+    p->tmin               = pixel_to_c(frame.stats.tmin);
+    p->tmax               = pixel_to_c(frame.stats.tmax);
+    p->tmean              = pixel_to_c(frame.stats.tmean);
+    p->hotspot_x          = frame.stats.hotspot_x;
+    p->hotspot_y          = frame.stats.hotspot_y;
+#if FIXED_POINT_PIPELINE
+    for (int i = 0; i < GRID_PIXELS; i++) {
+        p->pixels[i] = pixel_to_c(frame.pixels[i]);
+    }
+#else
+    memcpy(p->pixels, frame.pixels, sizeof(p->pixels));
+#endif
+    return sizeof(ws_payload_t);
+}
+
+// ── v2 ──────────────────────────────────────────────
+
+void ws_v2_encoder_init(WsV2Encoder& enc, uint8_t quant, uint8_t ext) {
+    memset(&enc, 0, sizeof(enc));
+    enc.quant = quant;
+    enc.ext   = ext;
+    enc.step  = 1;
+}
+
+static uint8_t* put_varint(uint8_t* p, uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static inline uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static bool has_rois(const Frame& frame) {
+    return frame.rois && frame.rois->count > 0;
+}
+
+static size_t roi_trailer_size(const Frame& frame) {
+    return 1 + frame.rois->count * sizeof(ws_roi_t);
+}
+
+static size_t write_roi_trailer(const Frame& frame, uint8_t* p) {
+    const RoiResults& r = *frame.rois;
+    p[0] = r.count;
+    ws_roi_t* out = (ws_roi_t*)(p + 1);
+    for (int i = 0; i < r.count; i++) {
+        out[i].tmin   = pixel_to_centi(r.roi[i].tmin);
+        out[i].tmax   = pixel_to_centi(r.roi[i].tmax);
+        out[i].tmean  = pixel_to_centi(r.roi[i].tmean);
+        out[i].pixels = r.roi[i].pixels;
+        out[i].above  = r.roi[i].above;
+        out[i].cx     = r.roi[i].cx_q8;
+        out[i].cy     = r.roi[i].cy_q8;
+    }
+    return roi_trailer_size(frame);
+}
+
+static inline uint16_t saturate_us(uint32_t us) {
+    return us > 0xFFFF ? 0xFFFF : (uint16_t)us;
+}
+
+// enqueue_us is left at process_us; ws_v2_stamp_enqueue() fills it in
+static size_t write_timing_trailer(const Frame& frame, uint8_t* p) {
+    uint32_t process_us = frame.processed_us - frame.capture_us;
+    ws_timing_t t;
+    t.frame_seq  = frame.seq;
+    t.capture_ms = frame.timestamp_ms - process_us / 1000;
+    t.process_us = saturate_us(process_us);
+    t.enqueue_us = t.process_us;
+    memcpy(p, &t, sizeof(t));
+    return sizeof(t);
+}
+
+static size_t trailers_size(uint8_t ext, const Frame& frame) {
+    size_t n = 0;
+    if (ext & WS_V2_EXT_ROI)    n += roi_trailer_size(frame);
+    if (ext & WS_V2_EXT_TIMING) n += sizeof(ws_timing_t);
+    return n;
+}
+
+static size_t write_trailers(uint8_t ext, const Frame& frame, uint8_t* p) {
+    size_t n = 0;
+    if (ext & WS_V2_EXT_ROI)    n += write_roi_trailer(frame, p);
+    if (ext & WS_V2_EXT_TIMING) n += write_timing_trailer(frame, p + n);
+    return n;
+}
+
+// Trailers actually written for this frame
+static uint8_t frame_ext(const WsV2Encoder& enc, const Frame& frame) {
+    return ((enc.ext & WS_V2_EXT_ROI) && has_rois(frame) ? WS_V2_EXT_ROI : 0) |
+           (enc.ext & WS_V2_EXT_TIMING);
+}
+
+static void write_header(const WsV2Encoder& enc, const Frame& frame,
+                         uint8_t kind, ws_v2_header_t* h)
+{
+    h->version            = WS_FORMAT_V2;
+    h->kind               = kind;
+    h->quant              = enc.quant;
+    h->ext                = frame_ext(enc, frame);
+    h->seq                = (uint16_t)frame.seq;
+    h->timestamp_ms       = frame.timestamp_ms;
+    h->current_fps        = frame.current_fps;
+    h->flags              = frame.flags;
+    h->calibration_offset = (int16_t)lroundf(frame.calibration_offset * 100.0f);
+    h->tmin               = pixel_to_centi(frame.stats.tmin);
+    h->tmax               = pixel_to_centi(frame.stats.tmax);
+    h->tmean              = pixel_to_centi(frame.stats.tmean);
+    h->hotspot_x          = frame.stats.hotspot_x;
+    h->hotspot_y          = frame.stats.hotspot_y;
+    h->base               = enc.base;
+    h->step               = enc.step;
+}
+
+static size_t keyframe_pixels_size(const WsV2Encoder& enc) {
+    return enc.quant == WS_QUANT_I8 ? GRID_PIXELS : GRID_PIXELS * 2;
+}
+
+static size_t write_keyframe_pixels(const WsV2Encoder& enc, uint8_t* p) {
+    if (enc.quant == WS_QUANT_I8) {
+        for (int i = 0; i < GRID_PIXELS; i++) p[i] = (uint8_t)enc.q_prev[i];
+        return GRID_PIXELS;
+    }
+    for (int i = 0; i < GRID_PIXELS; i++) {
+        p[i * 2]     = (uint8_t)(enc.q_prev[i] & 0xFF);
+        p[i * 2 + 1] = (uint8_t)(enc.q_prev[i] >> 8);
+    }
+    return GRID_PIXELS * 2;
+}
+
+static inline size_t varint_size(uint32_t v) {
+    size_t n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        n++;
+    }
+    return n;
+}
+
+size_t ws_v2_prepare(WsV2Encoder& enc, const Frame& frame) {
+    const int32_t qmax = (enc.quant == WS_QUANT_I8) ? 0xFF : 0xFFFF;
+    int16_t  centi[GRID_PIXELS];
+    uint16_t* q = enc.q_next;
+
+    for (int i = 0; i < GRID_PIXELS; i++) centi[i] = pixel_to_centi(frame.pixels[i]);
+
+    bool key = !enc.primed || enc.since_key >= WS_V2_KEYFRAME_INTERVAL;
+    size_t pixels_size = 0;
+
+    // Try to reuse the current base/step; fall back to a keyframe if any
+    // pixel left the representable range.
+    if (!key) {
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            int32_t d = (int32_t)centi[i] - enc.base;
+            if (d < 0) { key = true; break; }
+            int32_t v = (d + enc.step / 2) / enc.step;
+            if (v > qmax) { key = true; break; }
+            q[i] = (uint16_t)v;
+            pixels_size += varint_size(zigzag(v - (int32_t)enc.q_prev[i]));
+        }
+    }
+
+    enc.next_base = enc.base;
+    enc.next_step = enc.step;
+    if (key) {
+        int32_t lo = (int32_t)pixel_to_centi(frame.stats.tmin) - WS_V2_MARGIN_CENTI;
+        int32_t hi = (int32_t)pixel_to_centi(frame.stats.tmax) + WS_V2_MARGIN_CENTI;
+        if (lo < INT16_MIN) lo = INT16_MIN;
+        int32_t step = 1;
+        if (enc.quant == WS_QUANT_I8) {
+            step = (hi - lo + 254) / 255;
+            if (step < 1)   step = 1;
+            if (step > 255) step = 255;
+        }
+        enc.next_base = (int16_t)lo;
+        enc.next_step = (uint8_t)step;
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            int32_t v = ((int32_t)centi[i] - lo + step / 2) / step;
+            q[i] = (uint16_t)constrain(v, 0, qmax);
+        }
+        pixels_size = keyframe_pixels_size(enc);
+    }
+    enc.next_key = key;
+
+    return sizeof(ws_v2_header_t) + pixels_size + trailers_size(frame_ext(enc, frame), frame);
+}
+
+size_t ws_v2_write(WsV2Encoder& enc, const Frame& frame, uint8_t* out) {
+    ws_v2_header_t* h = (ws_v2_header_t*)out;
+    uint8_t* p = out + sizeof(ws_v2_header_t);
+
+    enc.base = enc.next_base;
+    enc.step = enc.next_step;
+    if (enc.next_key) {
+        memcpy(enc.q_prev, enc.q_next, sizeof(enc.q_prev));
+        write_header(enc, frame, WS_V2_KEYFRAME, h);
+        p += write_keyframe_pixels(enc, p);
+        enc.since_key = 1;
+    } else {
+        write_header(enc, frame, WS_V2_DELTA, h);
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            p = put_varint(p, zigzag((int32_t)enc.q_next[i] - (int32_t)enc.q_prev[i]));
+            enc.q_prev[i] = enc.q_next[i];
+        }
+        enc.since_key++;
+    }
+    enc.primed = true;
+
+    p += write_trailers(h->ext, frame, p);
+    return p - out;
+}
+
+size_t ws_v2_encode(WsV2Encoder& enc, const Frame& frame, uint8_t* out) {
+    ws_v2_prepare(enc, frame);
+    return ws_v2_write(enc, frame, out);
+}
+
+size_t ws_v2_resync_size(const WsV2Encoder& enc, const Frame& frame) {
+    return sizeof(ws_v2_header_t) + keyframe_pixels_size(enc) +
+           trailers_size(frame_ext(enc, frame), frame);
+}
+
+size_t ws_v2_encode_resync(const WsV2Encoder& enc, const Frame& frame, uint8_t* out) {
+    ws_v2_header_t* h = (ws_v2_header_t*)out;
+    write_header(enc, frame, WS_V2_KEYFRAME, h);
+    uint8_t* p = out + sizeof(ws_v2_header_t);
+    p += write_keyframe_pixels(enc, p);
+    p += write_trailers(h->ext, frame, p);
+    return p - out;
+}
+
+void ws_v2_stamp_enqueue(uint8_t* msg, size_t len, uint32_t capture_us, uint32_t now_us) {
+    if (len < sizeof(ws_v2_header_t) + sizeof(ws_timing_t)) return;
+    if (!(((const ws_v2_header_t*)msg)->ext & WS_V2_EXT_TIMING)) return;
+    uint16_t enqueue_us = saturate_us(now_us - capture_us);
+    memcpy(msg + len - sizeof(ws_timing_t) + offsetof(ws_timing_t, enqueue_us),
+           &enqueue_us, sizeof(enqueue_us));
+}
+
+// ── Stats-only ──────────────────────────────────────
+
+size_t ws_stats_size(const Frame& frame) {
+    return sizeof(ws_stats_packet_t) + (has_rois(frame) ? roi_trailer_size(frame) : 0);
+}
+
+size_t ws_stats_encode(const Frame& frame, uint8_t* out) {
+    ws_stats_packet_t* p = (ws_stats_packet_t*)out;
+
+    p->type         = WS_PKT_STATS;
+    p->flags        = frame.flags;
+    p->seq          = (uint16_t)frame.seq;
+    p->timestamp_ms = frame.timestamp_ms;
+    p->current_fps  = frame.current_fps;
+    p->tmin         = pixel_to_centi(frame.stats.tmin);
+    p->tmax         = pixel_to_centi(frame.stats.tmax);
+    p->tmean        = pixel_to_centi(frame.stats.tmean);
+    p->hotspot_x    = frame.stats.hotspot_x;
+    p->hotspot_y    = frame.stats.hotspot_y;
+    if (!has_rois(frame)) return sizeof(ws_stats_packet_t);
+    return sizeof(ws_stats_packet_t) + write_roi_trailer(frame, out + sizeof(ws_stats_packet_t));
+}
+
+// ── Alarm event ─────────────────────────────────────
+
+size_t ws_event_encode(const AlarmEvent& ev, uint8_t active_mask, uint8_t* out) {
+    ws_event_packet_t* p = (ws_event_packet_t*)out;
+
+    p->type         = WS_PKT_EVENT;
+    p->kind         = ev.kind;
+    p->rule         = ev.rule;
+    p->active       = active_mask;
+    p->id           = (uint16_t)ev.id;
+    p->timestamp_ms = ev.timestamp_ms;
+    p->value        = ev.value;
+    p->threshold    = (int16_t)lroundf(alarm_rule(ev.rule).threshold * 100.0f);
+    p->x            = ev.x;
+    p->y            = ev.y;
+    return sizeof(ws_event_packet_t);
+}
+
+// ── Frame record ────────────────────────────────────
+
+void ws_record_encode(const Frame& frame, ws_frame_record_t& rec) {
+    rec.timestamp_ms = frame.timestamp_ms;
+    rec.seq          = (uint16_t)frame.seq;
+    rec.current_fps  = frame.current_fps;
+    rec.flags        = frame.flags;
+    rec.tmin         = pixel_to_centi(frame.stats.tmin);
+    rec.tmax         = pixel_to_centi(frame.stats.tmax);
+    rec.tmean        = pixel_to_centi(frame.stats.tmean);
+    rec.hotspot_x    = frame.stats.hotspot_x;
+    rec.hotspot_y    = frame.stats.hotspot_y;
+#if FIXED_POINT_PIPELINE
+    memcpy(rec.pixels, frame.pixels, sizeof(rec.pixels));
+#else
+    for (int i = 0; i < GRID_PIXELS; i++) {
+        rec.pixels[i] = pixel_to_centi(frame.pixels[i]);
+    }
+#endif
+}
@@ -0,0 +1,75 @@
+#ifndef WS_CODEC_H
+#define WS_CODEC_H
+
+#include <Arduino.h>
+#include "frame.h"
+#include "ws_protocol.h"
+#include "alarm.h"
+
+// Send a keyframe at least this often so late joiners and clients that
+// missed a frame resynchronise quickly.
+#define WS_V2_KEYFRAME_INTERVAL  20
+
+// Headroom around [tmin, tmax] when choosing base/step, so small drifts
+// can still be sent as deltas instead of forcing a keyframe.
+#define WS_V2_MARGIN_CENTI       500
+
+// Per-stream v2 encoder state. One encoder feeds every client that uses
+// the same quantization, so it holds exactly what those decoders hold.
+struct WsV2Encoder {
+    uint8_t  quant;
+    uint8_t  ext;            // WS_V2_EXT_* trailers this stream may carry
+    bool     primed;
+    int16_t  base;
+    uint8_t  step;
+    uint16_t since_key;
+    uint16_t q_prev[GRID_PIXELS];
+
+    // Set by ws_v2_prepare(), committed by ws_v2_write()
+    bool     next_key;
+    int16_t  next_base;
+    uint8_t  next_step;
+    uint16_t q_next[GRID_PIXELS];
+};
+
+size_t ws_v1_encode(const Frame& frame, uint8_t* out);  // writes sizeof(ws_payload_t)
+
+// ext selects optional trailers (WS_V2_EXT_*); a trailer is only written
+// when the frame has data for it.
+void   ws_v2_encoder_init(WsV2Encoder& enc, uint8_t quant, uint8_t ext = 0);
+
+// Encoding is split in two so the caller can size the output exactly
+// and encode straight into it:
+//   len = ws_v2_prepare(enc, frame);  buf = alloc(len);  ws_v2_write(enc, frame, buf);
+// prepare picks keyframe or delta and quantizes the frame without changing
+// the stream state; write emits exactly `len` bytes and commits it. If the
+// allocation fails, skipping write leaves the stream as it was.
+size_t ws_v2_prepare(WsV2Encoder& enc, const Frame& frame);
+size_t ws_v2_write(WsV2Encoder& enc, const Frame& frame, uint8_t* out);
+
+// Encodes the next frame of the stream (keyframe or delta): both steps.
+// Returns bytes written, at most WS_V2_MAX_SIZE.
+size_t ws_v2_encode(WsV2Encoder& enc, const Frame& frame, uint8_t* out);
+
+// Re-emits the encoder's current state as a keyframe with the same seq,
+// base and step. Lets a client join mid-stream and follow later deltas.
+size_t ws_v2_resync_size(const WsV2Encoder& enc, const Frame& frame);
+size_t ws_v2_encode_resync(const WsV2Encoder& enc, const Frame& frame, uint8_t* out);
+
+// Sets enqueue_us in the timing trailer of an encoded v2 frame (the last
+// trailer, so at a fixed offset from the end). No-op without the trailer.
+void   ws_v2_stamp_enqueue(uint8_t* msg, size_t len, uint32_t capture_us, uint32_t now_us);
+
+// Stats-only packet, followed by the ROI trailer when the frame has ROIs.
+// Returns bytes written (ws_stats_size()), at most
+// sizeof(ws_stats_packet_t) + WS_ROI_TRAILER_MAX_SIZE.
+size_t ws_stats_size(const Frame& frame);
+size_t ws_stats_encode(const Frame& frame, uint8_t* out);
+
+// Alarm event packet. Returns sizeof(ws_event_packet_t).
+size_t ws_event_encode(const AlarmEvent& ev, uint8_t active_mask, uint8_t* out);
+
+// Compact record of a processed frame (one ws_frame_record_t).
+void   ws_record_encode(const Frame& frame, ws_frame_record_t& rec);
+
+#endif
@@ -0,0 +1,123 @@
+#include "ws_control.h"
+#include "config.h"
+#include "config_store.h"
+#include "temporal_filter.h"
+#include "frame_batch.h"
+#include "recorder.h"
+#include <math.h>
+
+uint8_t ws_control_apply(uint8_t param, float value, float& applied) {
+    if (param >= WS_PARAM_COUNT) return WS_ACK_BAD_PARAM;
+    if (!isfinite(value))        return WS_ACK_BAD_VALUE;
+
+    SystemConfig& cfg = config_get();
+    int  iv = (int)lroundf(value);
+    bool on = value != 0.0f;
+
+    switch (param) {
+        case WS_PARAM_NORMAL_FPS:
+            cfg.normal_fps = config_clamp_fps(iv);
+            applied = cfg.normal_fps;
+            break;
+        case WS_PARAM_IDLE_FPS:
+            cfg.idle_fps = config_clamp_fps(iv);
+            applied = cfg.idle_fps;
+            break;
+        case WS_PARAM_IDLE_TIMEOUT:
+            cfg.idle_timeout_sec = constrain(iv, 1, 300);
+            applied = cfg.idle_timeout_sec;
+            break;
+        case WS_PARAM_TEMPORAL:
+            if (cfg.temporal_enabled && !on) filter_reset();
+            cfg.temporal_enabled = on;
+            applied = on ? 1.0f : 0.0f;
+            break;
+        case WS_PARAM_ALPHA:
+            cfg.alpha = config_clamp_alpha(value);
+            applied = cfg.alpha;
+            break;
+        case WS_PARAM_FILTER_MODE:
+            cfg.filter_mode = iv == FILTER_MODE_ADAPTIVE ? FILTER_MODE_ADAPTIVE : FILTER_MODE_IIR;
+            applied = cfg.filter_mode;
+            break;
+        case WS_PARAM_THRESHOLD:
+            cfg.adaptive_threshold = config_clamp_threshold(value);
+            applied = cfg.adaptive_threshold;
+            break;
+        case WS_PARAM_OFFSET:
+            cfg.calibration_offset = config_clamp_offset(value);
+            applied = cfg.calibration_offset;
+            break;
+        case WS_PARAM_BATCH_FRAMES:
+            cfg.batch_frames = config_clamp_batch_frames(iv);
+            batch_configure(cfg.batch_frames, cfg.batch_max_ms);
+            applied = cfg.batch_frames;
+            break;
+        case WS_PARAM_BATCH_MS:
+            cfg.batch_max_ms = config_clamp_batch_ms(iv);
+            batch_configure(cfg.batch_frames, cfg.batch_max_ms);
+            applied = cfg.batch_max_ms;
+            break;
+        case WS_PARAM_RECORD:
+            cfg.record_enabled = on;
+            recorder_request(on);
+            applied = on ? 1.0f : 0.0f;
+            break;
+    }
+    return applied == value ? WS_ACK_OK : WS_ACK_CLAMPED;
+}
+
+static size_t status_reply(uint16_t seq, const WsControlLive& live, uint8_t* reply) {
+    const SystemConfig& cfg = config_get();
+    ws_status_packet_t st;
+    st.type               = WS_PKT_STATUS;
+    st.flags              = (cfg.temporal_enabled ? WS_FLAG_TEMPORAL_ENABLED : 0) |
+                            (live.idle ? WS_FLAG_IDLE_ACTIVE : 0) |
+                            (config_save_pending() ? WS_STATUS_SAVE_PENDING : 0) |
+                            (cfg.record_enabled ? WS_STATUS_RECORDING : 0);
+    st.seq                = seq;
+    st.config_generation  = config_store_stats().seq;
+    st.normal_fps         = cfg.normal_fps;
+    st.idle_fps           = cfg.idle_fps;
+    st.current_fps        = live.current_fps;
+    st.clients            = live.clients;
+    st.idle_timeout_sec   = cfg.idle_timeout_sec;
+    st.filter_mode        = cfg.filter_mode;
+    st.batch_frames       = cfg.batch_frames;
+    st.alpha              = cfg.alpha;
+    st.adaptive_threshold = cfg.adaptive_threshold;
+    st.calibration_offset = cfg.calibration_offset;
+    st.batch_max_ms       = cfg.batch_max_ms;
+    memcpy(reply, &st, sizeof(st));
+    return sizeof(st);
+}
+
+size_t ws_control_handle(const uint8_t* data, size_t len, uint32_t now_ms,
+                         const WsControlLive& live, uint8_t* reply)
+{
+    if (len < 1) return 0;
+
+    if (data[0] == WS_MSG_GET_STATUS) {
+        if (len < sizeof(ws_get_status_t)) return 0;
+        ws_get_status_t req;
+        memcpy(&req, data, sizeof(req));
+        return status_reply(req.seq, live, reply);
+    }
+
+    if (data[0] != WS_MSG_SET_PARAM || len < sizeof(ws_set_param_t)) return 0;
+
+    ws_set_param_t req;
+    memcpy(&req, data, sizeof(req));
+
+    float applied = 0.0f;
+    ws_ack_packet_t ack;
+    ack.type   = WS_PKT_ACK;
+    ack.status = ws_control_apply(req.param, req.value, applied);
+    ack.seq    = req.seq;
+    ack.param  = req.param;
+    ack.value  = applied;
+    if (ack.status <= WS_ACK_CLAMPED) config_request_save(now_ms);
+
+    memcpy(reply, &ack, sizeof(ack));
+    return sizeof(ack);
+}
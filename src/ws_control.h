@@ -0,0 +1,32 @@
+#ifndef WS_CONTROL_H
+#define WS_CONTROL_H
+
+#include <Arduino.h>
+#include "ws_protocol.h"
+
+// Binary control messages on the frame WebSocket (WS_MSG_SET_PARAM,
+// WS_MSG_GET_STATUS). A setting is clamped like POST /api/config, applied
+// before the next frame and acknowledged with the request's seq; flash is
+// written later through config_request_save(), so a slider drag costs one
+// write. Independent of the async library, like ws_clients.h.
+
+// Live state for a status reply that does not come from the config
+struct WsControlLive {
+    uint8_t current_fps;
+    uint8_t clients;
+    bool    idle;
+};
+
+#define WS_CONTROL_REPLY_MAX  sizeof(ws_status_packet_t)
+
+// Handles one client message. Writes the ack / status into `reply` (at
+// least WS_CONTROL_REPLY_MAX bytes) and returns its length; 0 if `data`
+// is not a complete control message.
+size_t ws_control_handle(const uint8_t* data, size_t len, uint32_t now_ms,
+                         const WsControlLive& live, uint8_t* reply);
+
+// Clamps and applies one setting; `applied` is the value now in effect.
+// Returns a WS_ACK_* status.
+uint8_t ws_control_apply(uint8_t param, float value, float& applied);
+
+#endif
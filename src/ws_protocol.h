@@ -2,9 +2,14 @@
 #define WS_PROTOCOL_H
 
 #include <stdint.h>
+#include "grid.h"
 
-// WebSocket binary payload — packed to avoid alignment padding
-struct __attribute__((packed)) ws_payload_t {
+// Frame-carrying structs are templated on the grid (grid.h); the _t
+// typedefs are the build's SensorGrid. Sizes in the comments are for 8x8.
+
+// ── v1: WebSocket binary payload — packed to avoid alignment padding ──
+template <class G>
+struct __attribute__((packed)) ws_payload {
     uint32_t timestamp_ms;
     uint8_t  current_fps;
     uint8_t  flags;               // bit0: temporal_enabled
@@ -16,12 +21,290 @@ struct __attribute__((packed)) ws_payload_t {
     float    tmean;
     uint8_t  hotspot_x;
     uint8_t  hotspot_y;
-    float    pixels[64];          // 8x8 grid, row-major
+    float    pixels[G::pixels];   // row-major
 };
-// Total size: 4+1+1+4+4+4+4+1+1+256 = 280 bytes
+typedef ws_payload<SensorGrid> ws_payload_t;
+// Total size: 4+1+1+4+4+4+4+1+1+4*pixels = 280 bytes
 
 #define WS_FLAG_TEMPORAL_ENABLED  0x01
 #define WS_FLAG_IDLE_ACTIVE       0x02
 #define WS_FLAG_STA_CONNECTED     0x04
 
+// ── v2: quantized keyframes + zigzag/varint deltas ──
+//
+// Every v2 frame starts with this header. Pixels are integers q such that
+// temperature_centi = base + q * step. Keyframes carry q directly (uint16
+// or uint8 LE, by quant); delta frames carry one zigzag varint per pixel of
+// q[i] - q_prev[i] and reuse the previous frame's base/step. A delta is only
+// valid if its seq directly follows the last frame the client decoded.
+struct __attribute__((packed)) ws_v2_header_t {
+    uint8_t  version;             // WS_FORMAT_V2
+    uint8_t  kind;                // WS_V2_KEYFRAME / WS_V2_DELTA
+    uint8_t  quant;               // WS_QUANT_I16 / WS_QUANT_I8
+    uint8_t  ext;                 // WS_V2_EXT_* blocks after the pixel data
+    uint16_t seq;
+    uint32_t timestamp_ms;
+    uint8_t  current_fps;
+    uint8_t  flags;               // WS_FLAG_*
+    int16_t  calibration_offset;  // centi-degrees
+    int16_t  tmin;                // centi-degrees
+    int16_t  tmax;
+    int16_t  tmean;
+    uint8_t  hotspot_x;
+    uint8_t  hotspot_y;
+    int16_t  base;                // centi-degrees
+    uint8_t  step;                // centi-degrees per count
+};
+// Total size: 4+2+4+1+1+2+2+2+2+1+1+2+1 = 25 bytes
+
+#define WS_V2_KEYFRAME  0
+#define WS_V2_DELTA     1
+
+#define WS_QUANT_I16    0
+#define WS_QUANT_I8     1
+
+// ── v2 extension trailers ──
+// Bits of ws_v2_header_t.ext. Present blocks follow the pixel data in bit
+// order; decoders that do not know a bit stop parsing there.
+#define WS_V2_EXT_ROI     0x01   // [u8 count][count x ws_roi_t]
+#define WS_V2_EXT_TIMING  0x02   // ws_timing_t
+
+// Per-ROI statistics, see roi.h
+struct __attribute__((packed)) ws_roi_t {
+    int16_t  tmin;                // centi-degrees
+    int16_t  tmax;
+    int16_t  tmean;
+    uint8_t  pixels;              // pixels in the ROI
+    uint8_t  above;               // pixels above the ROI threshold
+    uint16_t cx;                  // heat centroid, pixel units * 256
+    uint16_t cy;
+};
+// Total size: 2+2+2+1+1+2+2 = 12 bytes
+
+#define WS_ROI_MAX      4
+#define WS_ROI_TRAILER_MAX_SIZE  (1 + WS_ROI_MAX * sizeof(ws_roi_t))
+
+// Frame sequence and stage times, for loss counting and capture-to-glass
+// latency. Stage times are microseconds after capture, saturating at 65535.
+struct __attribute__((packed)) ws_timing_t {
+    uint32_t frame_seq;           // frames produced since boot (header seq is its low 16 bits)
+    uint32_t capture_ms;          // device millis() when the sensor frame was complete
+    uint16_t process_us;          // capture -> calibration, filter and stats done
+    uint16_t enqueue_us;          // capture -> handed to the client queues
+};
+// Total size: 4+4+2+2 = 12 bytes
+
+// Worst case pixel section: header + one three-byte varint per pixel
+#define WS_V2_PIXELS_MAX_SIZE  (sizeof(ws_v2_header_t) + GRID_PIXELS * 3)
+#define WS_V2_MAX_SIZE         (WS_V2_PIXELS_MAX_SIZE + WS_ROI_TRAILER_MAX_SIZE + sizeof(ws_timing_t))
+
+// A client that asked for v1 tells frames apart by length alone; no v2
+// frame may reach that length (8x8: 278 vs 280 bytes)
+static_assert(WS_V2_MAX_SIZE < sizeof(ws_payload_t), "v2 frame could be mistaken for a v1 payload");
+
+// ── Stats-only packet (WS_CHANNEL_STATS subscribers) ──
+struct __attribute__((packed)) ws_stats_packet_t {
+    uint8_t  type;                // WS_PKT_STATS
+    uint8_t  flags;               // WS_FLAG_*
+    uint16_t seq;
+    uint32_t timestamp_ms;
+    uint8_t  current_fps;
+    int16_t  tmin;                // centi-degrees
+    int16_t  tmax;
+    int16_t  tmean;
+    uint8_t  hotspot_x;
+    uint8_t  hotspot_y;
+};
+// Total size: 1+1+2+4+1+2+2+2+1+1 = 17 bytes
+// When ROIs are configured the WS_V2_EXT_ROI trailer follows directly, so
+// a packet longer than 17 bytes carries per-ROI stats.
+
+#define WS_PKT_STATS    3      // byte 0; v2 frames start with WS_FORMAT_V2
+
+// ── Compact frame record ──
+// Self-contained processed frame: int16 centi-degree pixels plus stats.
+// Used by batch messages and anything that stores frames.
+template <class G>
+struct __attribute__((packed)) ws_frame_record {
+    uint32_t timestamp_ms;
+    uint16_t seq;
+    uint8_t  current_fps;
+    uint8_t  flags;               // WS_FLAG_*
+    int16_t  tmin;                // centi-degrees
+    int16_t  tmax;
+    int16_t  tmean;
+    uint8_t  hotspot_x;
+    uint8_t  hotspot_y;
+    int16_t  pixels[G::pixels];   // centi-degrees, row-major
+};
+typedef ws_frame_record<SensorGrid> ws_frame_record_t;
+// Total size: 4+2+1+1+2+2+2+1+1+2*pixels = 144 bytes
+
+// ── Batch message (WS_CHANNEL_BATCH subscribers) ──
+// Header followed by `count` ws_frame_record_t, oldest first.
+struct __attribute__((packed)) ws_batch_header_t {
+    uint8_t  type;                // WS_PKT_BATCH
+    uint8_t  count;
+    uint16_t first_seq;
+    uint32_t sent_ms;             // device time the batch was flushed
+};
+// Total size: 1+1+2+4 = 8 bytes
+
+#define WS_PKT_BATCH    4
+
+// ── Alarm event (WS_CHANNEL_EVENTS and WS_SUB_EVENTS subscribers) ──
+// One raise or clear of an alarm rule, see alarm.h
+struct __attribute__((packed)) ws_event_packet_t {
+    uint8_t  type;                // WS_PKT_EVENT
+    uint8_t  kind;                // 1 raise / 0 clear
+    uint8_t  rule;                // index into the configured rules
+    uint8_t  active;              // bit i set if rule i is raised after this event
+    uint16_t id;                  // event id (low 16 bits)
+    uint32_t timestamp_ms;
+    int16_t  value;               // centi-degrees (rate rules: centi-°C/s)
+    int16_t  threshold;           // same unit as value
+    uint8_t  x;                   // where the source's maximum was
+    uint8_t  y;
+};
+// Total size: 1+1+1+1+2+4+2+2+1+1 = 16 bytes
+
+#define WS_PKT_EVENT    5
+
+// ── Control acknowledgement (to the sender of a WS_MSG_SET_PARAM) ──
+struct __attribute__((packed)) ws_ack_packet_t {
+    uint8_t  type;                // WS_PKT_ACK
+    uint8_t  status;              // WS_ACK_*
+    uint16_t seq;                 // copied from the request
+    uint8_t  param;               // WS_PARAM_*
+    float    value;               // value now in effect (after clamping)
+};
+// Total size: 1+1+2+1+4 = 9 bytes
+
+#define WS_PKT_ACK      6
+
+#define WS_ACK_OK            0
+#define WS_ACK_CLAMPED       1   // applied, but not the requested value
+#define WS_ACK_BAD_PARAM     2   // unknown parameter, nothing changed
+#define WS_ACK_BAD_VALUE     3   // NaN / infinite, nothing changed
+
+// ── Device status (to the sender of a WS_MSG_GET_STATUS) ──
+// The live subset of GET /api/config, without JSON.
+struct __attribute__((packed)) ws_status_packet_t {
+    uint8_t  type;                // WS_PKT_STATUS
+    uint8_t  flags;               // WS_FLAG_* | WS_STATUS_*
+    uint16_t seq;                 // copied from the request
+    uint32_t config_generation;   // bumps on every flash write of the config
+    uint8_t  normal_fps;
+    uint8_t  idle_fps;
+    uint8_t  current_fps;
+    uint8_t  clients;
+    uint16_t idle_timeout_sec;
+    uint8_t  filter_mode;
+    uint8_t  batch_frames;
+    float    alpha;
+    float    adaptive_threshold;
+    float    calibration_offset;
+    uint16_t batch_max_ms;
+};
+// Total size: 1+1+2+4+1+1+1+1+2+1+1+4+4+4+2 = 30 bytes
+
+#define WS_PKT_STATUS   7
+
+#define WS_STATUS_SAVE_PENDING  0x10  // a change is not in flash yet
+#define WS_STATUS_RECORDING     0x20
+
+// ── Pong (to the sender of a WS_MSG_PING) ──
+// The client echoes it back as ws_echo_t, which gives the device the
+// round trip on its own clock; `rtt_us` / `offset_ms` are the device's
+// estimates so far for this client.
+struct __attribute__((packed)) ws_pong_packet_t {
+    uint8_t  type;                // WS_PKT_PONG
+    uint8_t  reserved;
+    uint16_t id;                  // copied from the ping
+    double   client_ms;           // copied from the ping
+    uint32_t device_ms;           // millis() when the pong was sent
+    uint32_t device_us;           // micros(), returned in the echo
+    int32_t  offset_ms;           // client clock - device clock (0 until measured)
+    uint32_t rtt_us;              // device-measured round trip (0 until measured)
+};
+// Total size: 1+1+2+8+4+4+4+4 = 28 bytes
+
+#define WS_PKT_PONG     8
+
+// ── Client → device messages ──
+// Byte 0 of every binary message from a client is the message type.
+
+#define WS_MSG_HELLO     0x01  // [type][format][quant] — select wire format
+#define WS_MSG_SUBSCRIBE 0x02  // [type][channel][every][flags] — what to receive, every
+                               // Nth frame; flags (optional) are WS_SUB_*
+#define WS_MSG_SET_PARAM  0x03  // ws_set_param_t — change one setting, acked
+#define WS_MSG_GET_STATUS 0x04  // ws_get_status_t — reply is ws_status_packet_t
+#define WS_MSG_PING       0x05  // ws_ping_t — reply is ws_pong_packet_t
+#define WS_MSG_ECHO       0x06  // ws_echo_t — a pong returned, plus client-side telemetry
+
+#define WS_CHANNEL_FRAMES  0   // full frames in the client's wire format
+#define WS_CHANNEL_STATS   1   // ws_stats_packet_t (+ ROI trailer) only
+#define WS_CHANNEL_BATCH   2   // ws_batch_header_t + records, see frame_batch.h
+#define WS_CHANNEL_EVENTS  3   // ws_event_packet_t only
+
+#define WS_SUB_EVENTS      0x01  // also push alarm events on another channel
+
+// Settings changed through WS_MSG_SET_PARAM take effect on the next frame
+// and are saved like POST /api/config (debounced, see config.h).
+struct __attribute__((packed)) ws_set_param_t {
+    uint8_t  type;                // WS_MSG_SET_PARAM
+    uint8_t  param;               // WS_PARAM_*
+    uint16_t seq;                 // echoed in the ack
+    float    value;               // booleans: 0 / 1
+};
+// Total size: 1+1+2+4 = 8 bytes
+
+struct __attribute__((packed)) ws_get_status_t {
+    uint8_t  type;                // WS_MSG_GET_STATUS
+    uint8_t  reserved;
+    uint16_t seq;                 // echoed in the status
+};
+// Total size: 4 bytes
+
+// Client clocks are the page's performance.now() in milliseconds
+struct __attribute__((packed)) ws_ping_t {
+    uint8_t  type;                // WS_MSG_PING
+    uint8_t  reserved;
+    uint16_t id;
+    double   client_ms;           // client clock when sent
+};
+// Total size: 12 bytes
+
+struct __attribute__((packed)) ws_echo_t {
+    uint8_t  type;                // WS_MSG_ECHO
+    uint8_t  reserved;
+    uint16_t id;                  // from the pong
+    uint32_t device_ms;           // from the pong
+    uint32_t device_us;           // from the pong
+    double   client_ms;           // client clock when the pong arrived
+    uint32_t frames;              // frames this client decoded
+    uint32_t lost;                // gaps in ws_timing_t.frame_seq
+    uint16_t latency_ms;          // last capture -> displayed, client-measured
+    uint16_t reserved2;
+};
+// Total size: 1+1+2+4+4+8+4+4+2+2 = 32 bytes
+
+enum WsParam : uint8_t {
+    WS_PARAM_NORMAL_FPS = 0,
+    WS_PARAM_IDLE_FPS,
+    WS_PARAM_IDLE_TIMEOUT,        // seconds
+    WS_PARAM_TEMPORAL,            // 0 / 1
+    WS_PARAM_ALPHA,
+    WS_PARAM_FILTER_MODE,         // FILTER_MODE_*
+    WS_PARAM_THRESHOLD,           // adaptive filter, °C
+    WS_PARAM_OFFSET,              // calibration offset, °C
+    WS_PARAM_BATCH_FRAMES,
+    WS_PARAM_BATCH_MS,
+    WS_PARAM_RECORD,              // 0 / 1
+    WS_PARAM_COUNT
+};
+
+#define WS_FORMAT_V1    1
+#define WS_FORMAT_V2    2
+
 #endif
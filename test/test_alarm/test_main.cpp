@@ -0,0 +1,115 @@
+// Alarm rules: fire / no-fire cases for every rule type, on the synthetic
+// sequences and on hand-built traces at the sensor's frame rates.
+
+#include <unity.h>
+
+#include "fixtures.h"
+#include "roi.h"
+#include "alarm.h"
+
+static const int HOT = 3 * GRID_WIDTH + 4;
+
+static void expect_events(const std::vector<AlarmEvent>& ev, int raises, int clears) {
+    TEST_ASSERT_EQUAL_INT_MESSAGE(raises, count_kind(ev, ALARM_EVENT_RAISE), "raised");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(clears, count_kind(ev, ALARM_EVENT_CLEAR), "cleared");
+}
+
+static std::function<float(size_t, int)> seq_pixels(const Sequence& s) {
+    return [&s](size_t f, int i) { return s.celsius[(f % s.frames()) * GRID_PIXELS + i]; };
+}
+
+void setUp() {
+    RoiConfig left;
+    memset(&left, 0, sizeof(left));
+    left.mask = roi_rect_mask(0, 0, 2, 8);
+    left.threshold = 30.0f;
+    roi_configure(&left, 1);
+}
+
+void tearDown() {
+    roi_configure(nullptr, 0);
+    alarm_init();
+}
+
+// Sensor noise alone never fires
+static void test_static_scene_quiet() {
+    const Sequence still = make_static_scene(200);
+    expect_events(replay_alarm(still.frames(), 100, seq_pixels(still),
+        make_rule(ALARM_ABS, ALARM_SOURCE_FRAME, 30.0f, 1.0f, 0)), 0, 0);
+    expect_events(replay_alarm(still.frames(), 100, seq_pixels(still),
+        make_rule(ALARM_RATE, ALARM_SOURCE_FRAME, 1.0f, 0.5f, 0)), 0, 0);
+    expect_events(replay_alarm(still.frames(), 100, seq_pixels(still),
+        make_rule(ALARM_DELTA, ALARM_SOURCE_FRAME, 3.0f, 1.0f, 0)), 0, 0);
+}
+
+// A person crosses the left-edge ROI once per 40-frame cycle
+static void test_walk_in_roi() {
+    const Sequence walk = make_walk_in(200);
+    expect_events(replay_alarm(walk.frames(), 100, seq_pixels(walk),
+        make_rule(ALARM_ABS, 0, 30.0f, 1.0f, 0)), 5, 5);
+}
+
+// Debounce: a 200 ms spike is ignored, a 3 s one raises and clears once
+static void test_debounce() {
+    auto spikes = [](size_t f, int i) {
+        bool hot = i == HOT && ((f >= 50 && f < 52) || (f >= 100 && f < 130));
+        return hot ? 40.0f : 22.0f + noise();
+    };
+    std::vector<AlarmEvent> ev = replay_alarm(200, 100, spikes,
+        make_rule(ALARM_ABS, ALARM_SOURCE_FRAME, 30.0f, 1.0f, 500));
+    expect_events(ev, 1, 1);
+    TEST_ASSERT_GREATER_OR_EQUAL(1000u + 100 * 100 + 500, ev[0].timestamp_ms);
+    TEST_ASSERT_EQUAL(4, ev[0].x);
+    TEST_ASSERT_EQUAL(3, ev[0].y);
+}
+
+// Hysteresis: chatter around the threshold, inside the band, does not clear
+static void test_hysteresis() {
+    auto chatter = [](size_t f, int i) {
+        if (i != HOT) return 22.0f;
+        if (f < 100) return 31.0f;
+        if (f < 200) return (f & 1) ? 29.4f : 30.6f;
+        return 28.0f;
+    };
+    expect_events(replay_alarm(300, 100, chatter,
+        make_rule(ALARM_ABS, ALARM_SOURCE_FRAME, 30.0f, 1.0f, 0)), 1, 1);
+}
+
+// Rate of rise: 2 °C/s for 5 s fires, 0.1 °C/s for 100 s does not
+static void test_rate_of_rise() {
+    auto ramp = [](float rate_c_s) {
+        return [rate_c_s](size_t f, int i) {
+            float t = f < 100 ? 0.0f : (f - 100) * 0.1f;
+            float v = 22.0f + noise();
+            return i == HOT ? v + rate_c_s * t : v;
+        };
+    };
+    expect_events(replay_alarm(150, 100, ramp(2.0f),
+        make_rule(ALARM_RATE, ALARM_SOURCE_FRAME, 1.0f, 0.5f, 0)), 1, 0);
+    expect_events(replay_alarm(1100, 100, ramp(0.1f),
+        make_rule(ALARM_RATE, ALARM_SOURCE_FRAME, 1.0f, 0.5f, 0)), 0, 0);
+}
+
+// Delta over baseline at 1 FPS: a 6 °C jump fires, a 30-minute 8 °C room
+// warm-up is absorbed by the baseline
+static void test_delta_over_baseline() {
+    auto jump = [](size_t f, int i) {
+        return 22.0f + noise() + ((i == HOT && f >= 120 && f < 180) ? 6.0f : 0.0f);
+    };
+    expect_events(replay_alarm(300, 1000, jump,
+        make_rule(ALARM_DELTA, ALARM_SOURCE_FRAME, 5.0f, 1.0f, 2000)), 1, 1);
+    auto drift = [](size_t f, int) { return 22.0f + noise() + 8.0f * f / 1800.0f; };
+    expect_events(replay_alarm(1800, 1000, drift,
+        make_rule(ALARM_DELTA, ALARM_SOURCE_FRAME, 5.0f, 1.0f, 2000)), 0, 0);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_static_scene_quiet);
+    RUN_TEST(test_walk_in_roi);
+    RUN_TEST(test_debounce);
+    RUN_TEST(test_hysteresis);
+    RUN_TEST(test_rate_of_rise);
+    RUN_TEST(test_delta_over_baseline);
+    return UNITY_END();
+}
@@ -0,0 +1,57 @@
+// Chunked sensor reader on a mock I2C bus: reads follow the frame clock
+// with no trigger at all (a quiet INT line must not stall acquisition), and
+// a trigger starts a read before the next clock slot.
+
+#include <unity.h>
+
+#include "fixtures.h"
+#include "amg_reader.h"
+
+static uint8_t regs[2 * GRID_PIXELS];
+static pixel_t frame[GRID_PIXELS];
+
+void setUp() {
+    memset(regs, 0, sizeof(regs));
+    mock_regs = regs;
+    amg_reader_init(&mock_bus);
+}
+
+void tearDown() {}
+
+// One second of polling every millisecond, the sensor changing each 100 ms
+static uint32_t run_one_second() {
+    uint32_t now = 0;
+    for (; now < 1000; now++) {
+        regs[0] = (uint8_t)(now / AMG_FRAME_PERIOD_MS + 1);
+        amg_reader_poll(now);
+        amg_reader_take(frame);
+    }
+    return now;
+}
+
+static void test_clocked_without_trigger() {
+    run_one_second();
+    TEST_ASSERT_GREATER_OR_EQUAL(9, amg_reader_stats().frames);
+    TEST_ASSERT_EQUAL(0, amg_reader_stats().triggered);
+}
+
+// New data right after a frame: the trigger reads it without waiting for
+// the next slot
+static void test_trigger_reads_early() {
+    run_one_second();
+    const AmgReaderStats& st = amg_reader_stats();
+    uint32_t clocked = st.frames, last = st.last_frame_ms;
+    regs[0] = 0xEE;
+    amg_reader_trigger();
+    for (int c = 0; c < (int)sizeof(regs) / AMG_READ_CHUNK; c++) amg_reader_poll(last + 1);
+    TEST_ASSERT_EQUAL(clocked + 1, st.frames);
+    TEST_ASSERT_EQUAL(1, st.triggered);
+    TEST_ASSERT_TRUE(amg_reader_take(frame));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_clocked_without_trigger);
+    RUN_TEST(test_trigger_reads_early);
+    return UNITY_END();
+}
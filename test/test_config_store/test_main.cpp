@@ -0,0 +1,183 @@
+// Binary config store: round trip, recovery from corrupt and torn slots,
+// skipping unknown fields, and flash writes per burst of UI changes. Runs
+// against the LittleFS stand-in in a temporary directory.
+
+#include <unity.h>
+#include <string>
+#include <unistd.h>
+
+#include "fixtures.h"
+#include "config.h"
+#include "config_store.h"
+#include "roi.h"
+#include "temporal_filter.h"
+#include <LittleFS.h>
+
+static char        root[64];
+static std::string slot_a, slot_b;
+
+static bool slot_corrupt(const std::string& path, long at, long truncate_to) {
+    FILE* f = fopen(path.c_str(), "r+b");
+    if (!f) return false;
+    if (at >= 0) {
+        fseek(f, at, SEEK_SET);
+        int c = fgetc(f);
+        fseek(f, at, SEEK_SET);
+        fputc(c ^ 0x5A, f);
+    }
+    fclose(f);
+    return truncate_to < 0 || truncate(path.c_str(), truncate_to) == 0;
+}
+
+static long file_size(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return 0;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fclose(f);
+    return n;
+}
+
+void setUp() {
+    snprintf(root, sizeof(root), "/tmp/test_littlefs_XXXXXX");
+    TEST_ASSERT_NOT_NULL(mkdtemp(root));
+    setenv("HOST_FS_ROOT", root, 1);
+    LittleFS.begin();
+    slot_a = std::string(root) + CONFIG_SLOT_A;
+    slot_b = std::string(root) + CONFIG_SLOT_B;
+    config_store_erase();
+    config_init();
+}
+
+void tearDown() {
+    config_store_erase();
+    rmdir(root);
+    config_init();
+    config_apply();
+}
+
+static void test_empty_store_loads_defaults() {
+    TEST_ASSERT_FALSE(config_load());
+    TEST_ASSERT_EQUAL(5, config_get().normal_fps);
+}
+
+// Every kind of field
+static void test_round_trip() {
+    SystemConfig& cfg = config_get();
+    cfg.normal_fps         = 10;
+    cfg.alpha              = 0.42f;
+    cfg.filter_mode        = FILTER_MODE_ADAPTIVE;
+    cfg.calibration_offset = -1.5f;
+    cfg.roi_count          = 1;
+    snprintf(cfg.rois[0].name, sizeof(cfg.rois[0].name), "motor");
+    cfg.rois[0].mask       = roi_rect_mask(1, 1, 3, 2);
+    cfg.rois[0].threshold  = 45.0f;
+    cfg.alarm_count        = 1;
+    cfg.alarms[0]          = make_rule(ALARM_RATE, 0, 1.5f, 0.5f, 2000);
+    snprintf(cfg.sta_ssid, sizeof(cfg.sta_ssid), "workshop");
+    SystemConfig saved = cfg;
+    TEST_ASSERT_TRUE(config_save());
+    config_init();
+    TEST_ASSERT_TRUE(config_load());
+    TEST_ASSERT_EQUAL(10, cfg.normal_fps);
+    TEST_ASSERT_EQUAL_FLOAT(0.42f, cfg.alpha);
+    TEST_ASSERT_EQUAL(FILTER_MODE_ADAPTIVE, cfg.filter_mode);
+    TEST_ASSERT_EQUAL_FLOAT(-1.5f, cfg.calibration_offset);
+    TEST_ASSERT_EQUAL_STRING("workshop", cfg.sta_ssid);
+    TEST_ASSERT_EQUAL_MEMORY(saved.rois, cfg.rois, sizeof(cfg.rois));
+    TEST_ASSERT_EQUAL_MEMORY(saved.alarms, cfg.alarms, sizeof(cfg.alarms));
+}
+
+// Generations alternate slots; a damaged newest slot falls back to the
+// other, and a write halfway through at power loss does too
+static void test_recovery() {
+    SystemConfig& cfg = config_get();
+    cfg.normal_fps = 10;
+    config_save();                                   // generation 1, slot A
+    long record_bytes = file_size(slot_a);
+    cfg.normal_fps = 1;
+    config_save();                                   // generation 2, slot B
+    TEST_ASSERT_EQUAL(1, config_store_stats().slot);
+
+    slot_corrupt(slot_b, 40, -1);
+    config_init();
+    TEST_ASSERT_TRUE_MESSAGE(config_load(), "bit flip in newest slot recovers previous");
+    TEST_ASSERT_EQUAL(10, cfg.normal_fps);
+    TEST_ASSERT_EQUAL(1, config_store_stats().seq);
+    TEST_ASSERT_EQUAL(1, config_store_stats().bad_records);
+    config_save();                                   // generation 2 again, rewrites B
+    TEST_ASSERT_EQUAL(1, config_store_stats().slot);
+    TEST_ASSERT_EQUAL(2, config_store_stats().seq);
+
+    cfg.normal_fps = 5;
+    config_save();                                   // generation 3, slot A
+    slot_corrupt(slot_a, -1, record_bytes / 2);
+    config_init();
+    TEST_ASSERT_TRUE_MESSAGE(config_load(), "torn write recovers previous");
+    TEST_ASSERT_EQUAL(2, config_store_stats().seq);
+
+    slot_corrupt(slot_b, 0, -1);
+    config_init();
+    TEST_ASSERT_FALSE_MESSAGE(config_load(), "both slots bad loads defaults");
+    TEST_ASSERT_EQUAL(5, cfg.normal_fps);
+}
+
+// Fields from other firmware: unknown tags are skipped, known ones kept
+static void test_unknown_fields_skipped() {
+    uint8_t rec[64];
+    config_record_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "CFG1", 4);
+    h.version = CONFIG_STORE_VERSION;
+    h.seq     = 7;
+    uint8_t* p = rec + sizeof(h);
+    int32_t fps = 1;
+    *p++ = 200; *p++ = 4; *p++ = 0; memset(p, 0xEE, 4); p += 4;   // unknown
+    *p++ = 1;   *p++ = 4; *p++ = 0; memcpy(p, &fps, 4);  p += 4;   // normal_fps
+    *p++ = 5;   *p++ = 2; *p++ = 0; p += 2;                         // alpha, wrong size
+    h.length = (uint16_t)(p - rec - sizeof(h));
+    memcpy(rec, &h, sizeof(h));
+    h.crc = config_crc32(config_crc32(0, rec, sizeof(h)), rec + sizeof(h), h.length);
+    memcpy(rec, &h, sizeof(h));
+    FILE* out = fopen(slot_a.c_str(), "wb");
+    TEST_ASSERT_NOT_NULL(out);
+    fwrite(rec, 1, sizeof(h) + h.length, out);
+    fclose(out);
+    config_init();
+    TEST_ASSERT_TRUE(config_load());
+    TEST_ASSERT_EQUAL(1, config_get().normal_fps);
+    TEST_ASSERT_EQUAL_FLOAT(0.3f, config_get().alpha);
+}
+
+// A slider dragged for 2 s (a change every 50 ms) is one write
+static void test_burst_is_one_write() {
+    uint32_t before = config_store_stats().writes, written_at = 0;
+    for (uint32_t t = 0; t < 10000; t += 50) {
+        if (t < 2000) config_request_save(t);
+        if (t % 100 == 0 && config_poll(t) && !written_at) written_at = t;
+    }
+    TEST_ASSERT_EQUAL(1, config_store_stats().writes - before);
+    TEST_ASSERT_GREATER_OR_EQUAL(1950 + CONFIG_SAVE_DELAY_MS, written_at);
+}
+
+// Changes every 200 ms for 40 s still reach flash every 15 s at most
+static void test_continuous_changes_bounded() {
+    uint32_t before = config_store_stats().writes;
+    for (uint32_t t = 100000; t < 150000; t += 100) {
+        if (t < 140000 && t % 200 == 0) config_request_save(t);
+        config_poll(t);
+    }
+    TEST_ASSERT_EQUAL(3, config_store_stats().writes - before);
+    TEST_ASSERT_FALSE(config_save_pending());
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_store_loads_defaults);
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_recovery);
+    RUN_TEST(test_unknown_fields_skipped);
+    RUN_TEST(test_burst_is_one_write);
+    RUN_TEST(test_continuous_changes_bounded);
+    return UNITY_END();
+}
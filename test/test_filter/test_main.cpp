@@ -0,0 +1,100 @@
+// Q8 fixed-point filter against the float filter, on the same
+// centi-degree input, for every mode and a range of alphas.
+
+#include <unity.h>
+#include <vector>
+
+#include "fixtures.h"
+#include "temporal_filter.h"
+
+#define FIXED_FILTER_TOL_C   0.012f   // output rounding + Q8 state rounding
+#define FIXED_FILTER_BIAS_C  0.001f
+
+void setUp() {}
+void tearDown() {}
+
+// Float runs at the Q8-rounded alpha, so only the arithmetic is compared.
+// Returns the worst absolute difference; `bias` accumulates fixed - float.
+static float run_pair(const Sequence& seq, uint8_t mode, float alpha, bool settle,
+                      double& bias, size_t& samples)
+{
+    const FilterMath<int16_t>::Coeff kq = FilterMath<int16_t>::coeff(alpha, mode, 2.0f);
+    const FilterMath<float>::Coeff   kf = FilterMath<float>::coeff(kq.a / 256.0f, mode, 2.0f);
+    FilterStateT<SensorGrid, float>   sf;
+    FilterStateT<SensorGrid, int16_t> sq;
+    memset(&sf, 0, sizeof(sf));
+    memset(&sq, 0, sizeof(sq));
+    float   pf[GRID_PIXELS];
+    int16_t pq[GRID_PIXELS];
+    float   worst = 0.0f;
+    for (size_t f = 0; f < seq.frames(); f++) {
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            pq[i] = (int16_t)lroundf(seq.celsius[f * GRID_PIXELS + i] * 100.0f);
+            pf[i] = pq[i] / 100.0f;
+        }
+        int16_t target[GRID_PIXELS];
+        memcpy(target, pq, sizeof(target));
+        filter_apply_t(sf, pf, kf);
+        filter_apply_t(sq, pq, kq);
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            float err = fabsf(pq[i] / 100.0f - pf[i]);
+            if (err > worst) worst = err;
+            bias += pq[i] / 100.0 - pf[i];
+            samples++;
+        }
+        // Last frame of each 200-frame level: settled exactly
+        if (settle && f % 200 == 199) {
+            char what[64];
+            snprintf(what, sizeof(what), "mode %u alpha %.2f settles at frame %zu", mode, alpha, f);
+            TEST_ASSERT_EQUAL_MEMORY_MESSAGE(target, pq, sizeof(pq), what);
+        }
+    }
+    return worst;
+}
+
+static const float ALPHAS[] = { 0.05f, 0.3f, 0.8f };
+static const uint8_t MODES[] = { FILTER_MODE_IIR, FILTER_MODE_ADAPTIVE };
+
+static void test_fixed_tracks_float() {
+    const Sequence seqs[] = { make_static_scene(200), make_walk_in(200), make_step(STEP_FRAME + 40) };
+    double bias = 0.0;
+    size_t samples = 0;
+    for (uint8_t mode : MODES) {
+        for (float alpha : ALPHAS) {
+            for (const Sequence& seq : seqs) {
+                char what[96];
+                snprintf(what, sizeof(what), "%s mode %u alpha %.2f", seq.name.c_str(), mode, alpha);
+                float worst = run_pair(seq, mode, alpha, false, bias, samples);
+                TEST_ASSERT_FLOAT_WITHIN_MESSAGE(FIXED_FILTER_TOL_C, 0.0f, worst, what);
+            }
+        }
+    }
+    TEST_ASSERT_FLOAT_WITHIN_MESSAGE(FIXED_FILTER_BIAS_C, 0.0, bias / samples, "mean bias");
+}
+
+// Down and up steps of odd sizes, no noise: each level is reached exactly
+static void test_fixed_steps_settle() {
+    Sequence steps;
+    steps.name = "synthetic_steps";
+    const float levels[] = { 30.0f, 24.37f, 24.36f, 31.01f, 21.0f };
+    for (float c : levels) {
+        for (int f = 0; f < 200; f++) {
+            for (int i = 0; i < GRID_PIXELS; i++) steps.celsius.push_back(c + (i % GRID_WIDTH) * 0.01f);
+        }
+    }
+    double bias = 0.0;
+    size_t samples = 0;
+    for (uint8_t mode : MODES) {
+        for (float alpha : ALPHAS) {
+            float worst = run_pair(steps, mode, alpha, true, bias, samples);
+            TEST_ASSERT_FLOAT_WITHIN(FIXED_FILTER_TOL_C, 0.0f, worst);
+        }
+    }
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fixed_tracks_float);
+    RUN_TEST(test_fixed_steps_settle);
+    return UNITY_END();
+}
@@ -0,0 +1,87 @@
+// Batch ring: what batch_flush() emits for frames pushed at 1 FPS.
+
+#include <unity.h>
+#include <vector>
+
+#include "pixel_format.h"
+#include "frame.h"
+#include "frame_batch.h"
+
+static pixel_t              pixels[GRID_PIXELS];
+static Frame                fr;
+static std::vector<uint8_t> buf(BATCH_MAX_SIZE);
+static const ws_batch_header_t* h = (const ws_batch_header_t*)buf.data();
+static const ws_frame_record_t* rec =
+    (const ws_frame_record_t*)(buf.data() + sizeof(ws_batch_header_t));
+
+void setUp() {
+    for (int i = 0; i < GRID_PIXELS; i++) pixels[i] = pixel_from_c(20.0f + i * 0.25f);
+    memset(&fr, 0, sizeof(fr));
+    fr.pixels = pixels;
+    batch_init();
+}
+
+void tearDown() {
+    batch_init();
+}
+
+// Count-triggered flush, oldest first
+static void test_count_flush() {
+    batch_configure(4, 10000);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, batch_next_flush_ms(0));
+    for (uint32_t s = 0; s < 4; s++) {
+        fr.seq = 100 + s;
+        fr.timestamp_ms = 1000 + s * 1000;
+        TEST_ASSERT_FALSE_MESSAGE(batch_due(fr.timestamp_ms), "due before target count");
+        batch_push(fr);
+    }
+    TEST_ASSERT_TRUE(batch_due(4000));
+    const size_t want = sizeof(ws_batch_header_t) + 4 * sizeof(ws_frame_record_t);
+    TEST_ASSERT_EQUAL(want, batch_size());
+    TEST_ASSERT_EQUAL(want, batch_flush(buf.data(), 4000));
+    TEST_ASSERT_EQUAL(WS_PKT_BATCH, h->type);
+    TEST_ASSERT_EQUAL(4, h->count);
+    TEST_ASSERT_EQUAL(100, h->first_seq);
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL(100 + i, rec[i].seq);
+        TEST_ASSERT_EQUAL(1000u + i * 1000u, rec[i].timestamp_ms);
+    }
+    TEST_ASSERT_EQUAL(pixel_to_centi(pixels[GRID_PIXELS - 1]), rec[0].pixels[GRID_PIXELS - 1]);
+    TEST_ASSERT_EQUAL(0, batch_count());
+}
+
+// Time-triggered flush of a partial batch
+static void test_timeout_flush() {
+    batch_configure(10, 2500);
+    fr.seq = 200;
+    fr.timestamp_ms = 50000;
+    batch_push(fr);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1500, batch_next_flush_ms(51000), "deadline counts from oldest frame");
+    TEST_ASSERT_FALSE(batch_due(52499));
+    TEST_ASSERT_TRUE(batch_due(52500));
+    batch_flush(buf.data(), 52500);
+    TEST_ASSERT_EQUAL(1, h->count);
+    TEST_ASSERT_EQUAL(52500, h->sent_ms);
+}
+
+// Overflow keeps the newest BATCH_MAX_FRAMES in order
+static void test_overflow_drops_oldest() {
+    batch_configure(BATCH_MAX_FRAMES, 60000);
+    for (uint32_t s = 0; s < BATCH_MAX_FRAMES + 3; s++) {
+        fr.seq = 300 + s;
+        fr.timestamp_ms = 60000 + s;
+        batch_push(fr);
+    }
+    batch_flush(buf.data(), 60100);
+    TEST_ASSERT_EQUAL(BATCH_MAX_FRAMES, h->count);
+    TEST_ASSERT_EQUAL(303, h->first_seq);
+    for (int i = 1; i < BATCH_MAX_FRAMES; i++) TEST_ASSERT_EQUAL(rec[i - 1].seq + 1, rec[i].seq);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_count_flush);
+    RUN_TEST(test_timeout_flush);
+    RUN_TEST(test_overflow_drops_oldest);
+    return UNITY_END();
+}
@@ -0,0 +1,70 @@
+// History ring: wrap-around, time lookup across the millis() wrap and
+// rollups over a range.
+
+#include <unity.h>
+
+#include "pixel_format.h"
+#include "frame.h"
+#include "frame_history.h"
+
+// Wrap the ring 2.5 times; timestamps start just below the millis() wrap
+static const uint32_t total = HISTORY_FRAMES * 5 / 2;
+static const uint32_t t0    = 0xFFFFFFFFu - 1000;
+
+void setUp() {
+    static pixel_t pixels[GRID_PIXELS];
+    for (pixel_t& p : pixels) p = pixel_from_c(20.0f);
+    Frame fr;
+    memset(&fr, 0, sizeof(fr));
+    fr.pixels = pixels;
+
+    history_init();
+    for (uint32_t s = 0; s < total; s++) {
+        fr.seq          = s;
+        fr.timestamp_ms = t0 + s * 100;
+        fr.stats.tmin   = pixel_from_c(20.0f);
+        fr.stats.tmax   = pixel_from_c(s == total - 5 ? 40.0f : 25.0f);
+        fr.stats.tmean  = pixel_from_c(22.0f);
+        history_push(fr);
+    }
+}
+
+void tearDown() {
+    history_init();
+}
+
+static void test_wrap_keeps_newest_in_order() {
+    TEST_ASSERT_EQUAL(HISTORY_FRAMES, history_count());
+    TEST_ASSERT_EQUAL(HISTORY_FRAMES, history_end() - history_begin());
+    TEST_ASSERT_NULL(history_get(history_begin() - 1));
+    TEST_ASSERT_EQUAL((uint16_t)(total - HISTORY_FRAMES), history_get(history_begin())->seq);
+    for (uint32_t i = history_begin() + 1; i < history_end(); i++) {
+        TEST_ASSERT_EQUAL((uint16_t)(history_get(i - 1)->seq + 1), history_get(i)->seq);
+    }
+}
+
+static void test_find_since() {
+    uint32_t since = t0 + (total - 10) * 100;   // across the millis() wrap
+    TEST_ASSERT_EQUAL(9, history_end() - history_find_since(since));
+    TEST_ASSERT_EQUAL(history_begin(), history_find_since(t0));
+}
+
+static void test_stats() {
+    uint32_t idx = history_find_since(t0 + (total - 10) * 100);
+    HistoryStats st;
+    TEST_ASSERT_TRUE(history_stats(idx, st));
+    TEST_ASSERT_EQUAL(9, st.count);
+    TEST_ASSERT_EQUAL(4000, st.tmax);
+    TEST_ASSERT_EQUAL_UINT32(t0 + (total - 5) * 100, st.tmax_ms);
+    TEST_ASSERT_EQUAL(2000, st.tmin);
+    TEST_ASSERT_EQUAL(2200, st.tmean);
+    TEST_ASSERT_FALSE_MESSAGE(history_stats(history_end(), st), "stats on empty range");
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_wrap_keeps_newest_in_order);
+    RUN_TEST(test_find_since);
+    RUN_TEST(test_stats);
+    return UNITY_END();
+}
@@ -0,0 +1,70 @@
+// Cost of the stage instrumentation against the frame period.
+
+#include <unity.h>
+#include <algorithm>
+#include <vector>
+
+#include "fixtures.h"
+#include "pixel_format.h"
+#include "pipeline.h"
+#include "temporal_filter.h"
+#include "metrics.h"
+
+// Upper bound on samples recorded per produced frame: 4 sensor chunks,
+// process, payload, broadcast, alarm, UDP, a recorder write, spare
+#define METRICS_SAMPLES_PER_FRAME  12
+#define METRICS_MAX_OVERHEAD       0.01    // of the frame period at 10 FPS
+
+void setUp() {
+    metrics_init();
+}
+
+void tearDown() {
+    metrics_init();
+    filter_reset();
+}
+
+// Times pipeline_process_fused with and without an extra metrics_now() /
+// metrics_record() pair around it, and an empty MetricScope on its own;
+// the worse of the two per-sample costs times METRICS_SAMPLES_PER_FRAME
+// must stay under 1% of the frame period
+static void test_overhead_under_one_percent() {
+    const Sequence seq = make_walk_in(200);
+    const size_t n = seq.frames();
+    std::vector<pixel_t> input(n * GRID_PIXELS), work(n * GRID_PIXELS);
+    std::vector<FrameStats> stats(n);
+    for (size_t i = 0; i < n * GRID_PIXELS; i++) input[i] = pixel_from_c(seq.celsius[i]);
+    SystemConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.temporal_enabled = true;
+    cfg.alpha            = 0.3f;
+
+    double bare = 1e30, timed = 1e30;
+    for (int rep = 0; rep < 3; rep++) {          // best of 3 against scheduling noise
+        bare = std::min(bare, time_stage(n, []() { filter_reset(); },
+            [&](size_t f) {
+                pipeline_process_fused(&input[f * GRID_PIXELS], &work[f * GRID_PIXELS], stats[f], cfg);
+            }));
+        timed = std::min(timed, time_stage(n, []() { filter_reset(); },
+            [&](size_t f) {
+                uint32_t t0 = metrics_now();
+                pipeline_process_fused(&input[f * GRID_PIXELS], &work[f * GRID_PIXELS], stats[f], cfg);
+                metrics_record(METRIC_PROCESS, metrics_now() - t0);
+            }));
+    }
+    double scope = time_stage(n, []() {}, [](size_t) { MetricScope s(METRIC_HTTP); });
+    double sample = std::max(std::max(timed - bare, 0.0), scope);
+    double per_frame = sample * METRICS_SAMPLES_PER_FRAME;
+    double period_ns = 1e9 / 10;
+    char what[96];
+    snprintf(what, sizeof(what), "%.1f ns per sample, %.5f%% of a 100 ms frame",
+             sample, 100.0 * per_frame / period_ns);
+    TEST_MESSAGE(what);
+    TEST_ASSERT_TRUE_MESSAGE(per_frame <= METRICS_MAX_OVERHEAD * period_ns, what);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_overhead_under_one_percent);
+    return UNITY_END();
+}
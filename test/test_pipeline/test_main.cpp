@@ -0,0 +1,122 @@
+// Fused kernel vs. the staged path, and the templated kernel vs. the
+// firmware entry point, on the synthetic sequences.
+
+#include <unity.h>
+#include <vector>
+
+#include "fixtures.h"
+#include "pixel_format.h"
+#include "pipeline.h"
+#include "pipeline_kernel.h"
+#include "temporal_filter.h"
+#include "nuc.h"
+#include "roi.h"
+
+void setUp() {
+    filter_reset();
+    nuc_init();
+}
+
+void tearDown() {
+    nuc_init();
+    roi_configure(nullptr, 0);
+    filter_reset();
+}
+
+// Runs both paths over the sequence for every combination of filter,
+// global offset, NUC table and filter mode, with ROIs configured; the
+// output pixels, statistics and ROI results must be bit-identical.
+static void check_fused(const Sequence& seq) {
+    const size_t n = seq.frames();
+    std::vector<pixel_t> input(n * GRID_PIXELS), staged(n * GRID_PIXELS), fused(n * GRID_PIXELS);
+    std::vector<FrameStats> st_staged(n), st_fused(n);
+    std::vector<RoiResults> roi_staged(n), roi_fused(n);
+    configure_test_rois();
+    for (size_t i = 0; i < n * GRID_PIXELS; i++) input[i] = pixel_from_c(seq.celsius[i]);
+
+    for (int combo = 0; combo < 16; combo++) {
+        SystemConfig cfg;
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.temporal_enabled   = combo & 1;
+        cfg.alpha              = 0.3f;
+        cfg.calibration_offset = (combo & 2) ? -1.3f : 0.0f;
+        cfg.filter_mode        = (combo & 8) ? FILTER_MODE_ADAPTIVE : FILTER_MODE_IIR;
+        cfg.adaptive_threshold = 2.0f;
+
+        nuc_init();
+        if (combo & 4) {
+            nuc_capture_start(1, 8);
+            for (size_t f = 0; f < 8 && f < n; f++) nuc_capture_feed(&input[f * GRID_PIXELS]);
+        }
+
+        filter_reset();
+        for (size_t f = 0; f < n; f++)
+            pipeline_process(&input[f * GRID_PIXELS], &staged[f * GRID_PIXELS], st_staged[f], cfg, &roi_staged[f]);
+        filter_reset();
+        for (size_t f = 0; f < n; f++)
+            pipeline_process_fused(&input[f * GRID_PIXELS], &fused[f * GRID_PIXELS], st_fused[f], cfg, &roi_fused[f]);
+
+        for (size_t f = 0; f < n; f++) {
+            char what[96];
+            snprintf(what, sizeof(what), "%s combo %d frame %zu", seq.name.c_str(), combo, f);
+            TEST_ASSERT_EQUAL_MEMORY_MESSAGE(&staged[f * GRID_PIXELS], &fused[f * GRID_PIXELS],
+                                             GRID_PIXELS * sizeof(pixel_t), what);
+            TEST_ASSERT_EQUAL_MEMORY_MESSAGE(&st_staged[f], &st_fused[f], sizeof(FrameStats), what);
+            TEST_ASSERT_EQUAL_MEMORY_MESSAGE(&roi_staged[f], &roi_fused[f], sizeof(RoiResults), what);
+        }
+    }
+}
+
+static void test_fused_matches_staged_static() {
+    check_fused(make_static_scene(200));
+}
+
+static void test_fused_matches_staged_walk_in() {
+    check_fused(make_walk_in(200));
+}
+
+// pipeline_run_t<SensorGrid, pixel_t> is what the firmware entry points
+// instantiate; without NUC or ROIs it must match pipeline_process_fused
+// exactly
+static void test_grid_kernel_matches_entry_point() {
+    const Sequence seq = make_walk_in(200);
+    const size_t n = seq.frames();
+    std::vector<pixel_t> input(n * GRID_PIXELS), fused(n * GRID_PIXELS), templ(n * GRID_PIXELS);
+    std::vector<FrameStats> st_fused(n), st_templ(n);
+    for (size_t i = 0; i < n * GRID_PIXELS; i++) input[i] = pixel_from_c(seq.celsius[i]);
+
+    for (int temporal = 0; temporal < 2; temporal++) {
+        SystemConfig cfg;
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.temporal_enabled   = temporal;
+        cfg.alpha              = 0.3f;
+        cfg.calibration_offset = 0.5f;
+
+        filter_reset();
+        for (size_t f = 0; f < n; f++)
+            pipeline_process_fused(&input[f * GRID_PIXELS], &fused[f * GRID_PIXELS], st_fused[f], cfg);
+
+        FilterStateT<SensorGrid, pixel_t> fs;
+        fs.primed = false;
+        const filter_coeff_t k = filter_coeff(cfg.alpha, cfg.filter_mode, cfg.adaptive_threshold);
+        for (size_t f = 0; f < n; f++)
+            pipeline_run_t<SensorGrid, pixel_t>(&input[f * GRID_PIXELS], &templ[f * GRID_PIXELS], st_templ[f],
+                                                pixel_from_c(cfg.calibration_offset), fs, k, temporal);
+
+        for (size_t f = 0; f < n; f++) {
+            char what[64];
+            snprintf(what, sizeof(what), "temporal %d frame %zu", temporal, f);
+            TEST_ASSERT_EQUAL_MEMORY_MESSAGE(&fused[f * GRID_PIXELS], &templ[f * GRID_PIXELS],
+                                             GRID_PIXELS * sizeof(pixel_t), what);
+            TEST_ASSERT_EQUAL_MEMORY_MESSAGE(&st_fused[f], &st_templ[f], sizeof(FrameStats), what);
+        }
+    }
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fused_matches_staged_static);
+    RUN_TEST(test_fused_matches_staged_walk_in);
+    RUN_TEST(test_grid_kernel_matches_entry_point);
+    return UNITY_END();
+}
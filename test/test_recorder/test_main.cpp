@@ -0,0 +1,133 @@
+// Recorder against the LittleFS stand-in: segments rotate, a full download
+// decodes back to the recorded frames, and start / stop requests are
+// applied (or refused) by the record task.
+
+#include <unity.h>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "fixtures.h"
+#include "pixel_format.h"
+#include "recorder.h"
+#include <LittleFS.h>
+
+static char root[64];
+
+void setUp() {
+    snprintf(root, sizeof(root), "/tmp/test_littlefs_XXXXXX");
+    TEST_ASSERT_NOT_NULL(mkdtemp(root));
+    setenv("HOST_FS_ROOT", root, 1);
+    LittleFS.begin();
+    recorder_init();
+}
+
+void tearDown() {
+    recorder_stop();
+    Dir dir = LittleFS.openDir(REC_DIR);
+    while (dir.next()) LittleFS.remove((std::string(REC_DIR "/") + dir.fileName()).c_str());
+    rmdir((std::string(root) + REC_DIR).c_str());
+    rmdir(root);
+}
+
+static void test_round_trip() {
+    // Long enough to rotate segments
+    const Sequence seq = make_walk_in(200);
+    const size_t n = seq.frames(), total = 4000;
+    std::vector<pixel_t> frames(n * GRID_PIXELS);
+    for (size_t i = 0; i < n * GRID_PIXELS; i++) frames[i] = pixel_from_c(seq.celsius[i]);
+
+    TEST_ASSERT_TRUE(recorder_start());
+    Frame fr;
+    memset(&fr, 0, sizeof(fr));
+    for (size_t f = 0; f < total; f++) {
+        fr.seq          = (uint32_t)f;
+        fr.timestamp_ms = 1000 + (uint32_t)f * 100;
+        fr.pixels       = &frames[(f % n) * GRID_PIXELS];
+        recorder_push(fr);
+        while (recorder_poll()) {}
+    }
+    recorder_stop();
+    TEST_ASSERT_EQUAL(0, recorder_stats().dropped);
+    TEST_ASSERT_GREATER_THAN(0, recorder_stats().segments_rotated);
+
+    // Download everything still on flash, decode, compare
+    RecCursor cur;
+    std::vector<uint8_t> stream;
+    uint8_t buf[REC_PAGE_SIZE];
+    TEST_ASSERT_TRUE(recorder_seek(0, UINT32_MAX, cur));
+    for (size_t got; (got = recorder_read(cur, buf, sizeof(buf))) > 0; ) stream.insert(stream.end(), buf, buf + got);
+
+    V2Decoder dec;
+    int16_t centi[GRID_PIXELS];
+    ws_v2_header_t h;
+    memset(&h, 0, sizeof(h));
+    size_t decoded = 0, pos = 0;
+    while (pos < stream.size() && pos + 1 + stream[pos] <= stream.size()) {
+        size_t len = stream[pos];
+        TEST_ASSERT_TRUE_MESSAGE(v2_decode(dec, &stream[pos + 1], len, centi, h), "record decodes");
+        const pixel_t* src = &frames[(h.seq % n) * GRID_PIXELS];
+        for (int i = 0; i < GRID_PIXELS; i++) TEST_ASSERT_EQUAL(pixel_to_centi(src[i]), centi[i]);
+        pos += 1 + len;
+        decoded++;
+    }
+    TEST_ASSERT_GREATER_THAN(0, decoded);
+    TEST_ASSERT_EQUAL_MESSAGE((uint16_t)(total - 1), h.seq, "download ends on the newest frame");
+}
+
+// A random range starts at or before its first frame and yields data
+static void test_seek() {
+    recorder_start();
+    pixel_t pixels[GRID_PIXELS];
+    for (pixel_t& p : pixels) p = pixel_from_c(22.0f);
+    Frame fr;
+    memset(&fr, 0, sizeof(fr));
+    fr.pixels = pixels;
+    for (uint32_t f = 0; f < 2000; f++) {
+        fr.seq          = f;
+        fr.timestamp_ms = 1000 + f * 100;
+        recorder_push(fr);
+        while (recorder_poll()) {}
+    }
+    recorder_stop();
+
+    RecSegmentInfo oldest;
+    TEST_ASSERT_TRUE(recorder_segment_info(0, oldest));
+    uint8_t buf[REC_PAGE_SIZE];
+    for (int s = 0; s < 100; s++) {
+        uint32_t from = oldest.first_ms + (uint32_t)(rand() % ((1000 + 2000 * 100) - oldest.first_ms));
+        RecCursor cur;
+        TEST_ASSERT_TRUE(recorder_seek(from, from + 1000, cur));
+        TEST_ASSERT_GREATER_THAN(0, recorder_read(cur, buf, sizeof(buf)));
+    }
+}
+
+// Requests only take effect in recorder_poll_request(); a start that
+// cannot open a segment is reported and leaves the recorder off
+static void test_request() {
+    recorder_request(true);
+    TEST_ASSERT_FALSE(recorder_active());
+    TEST_ASSERT_TRUE(recorder_poll_request());
+    TEST_ASSERT_TRUE(recorder_active());
+    recorder_request(false);
+    TEST_ASSERT_TRUE(recorder_active());
+    TEST_ASSERT_TRUE(recorder_poll_request());
+    TEST_ASSERT_FALSE(recorder_active());
+    TEST_ASSERT_TRUE_MESSAGE(recorder_poll_request(), "nothing pending");
+
+    setenv("HOST_FS_ROOT", "/nonexistent/test_littlefs", 1);
+    recorder_request(true);
+    bool ok = recorder_poll_request();
+    setenv("HOST_FS_ROOT", root, 1);
+    TEST_ASSERT_FALSE(ok);
+    TEST_ASSERT_FALSE(recorder_active());
+    TEST_ASSERT_EQUAL(1, recorder_stats().start_failures);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_seek);
+    RUN_TEST(test_request);
+    return UNITY_END();
+}
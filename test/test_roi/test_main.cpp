@@ -0,0 +1,114 @@
+// ROI statistics, heat-weighted centroid, the stats-packet trailer, and
+// empty slots keeping their index.
+
+#include <unity.h>
+
+#include "fixtures.h"
+#include "pixel_format.h"
+#include "pipeline.h"
+#include "temporal_filter.h"
+#include "roi.h"
+#include "ws_codec.h"
+
+static pixel_t    raw[GRID_PIXELS], out[GRID_PIXELS];
+static FrameStats st;
+static RoiResults res;
+
+// A 2x2 blob at (5..6, 2..3) with one hotter pixel, and a warm pixel at
+// (1, 6); ROI 0 covers the blob, ROI 1 misses it
+void setUp() {
+    for (int i = 0; i < GRID_PIXELS; i++) raw[i] = pixel_from_c(20.0f);
+    raw[2 * GRID_WIDTH + 5] = raw[2 * GRID_WIDTH + 6] = raw[3 * GRID_WIDTH + 5] = pixel_from_c(30.0f);
+    raw[3 * GRID_WIDTH + 6] = pixel_from_c(40.0f);
+    raw[6 * GRID_WIDTH + 1] = pixel_from_c(22.0f);
+
+    RoiConfig r[2];
+    memset(r, 0, sizeof(r));
+    r[0].mask = roi_rect_mask(4, 1, 4, 4);  r[0].threshold = 25.0f;
+    r[1].mask = roi_rect_mask(0, 4, 4, 4);  r[1].threshold = 25.0f;
+    roi_configure(r, 2);
+
+    SystemConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    filter_reset();
+    pipeline_process_fused(raw, out, st, cfg, &res);
+}
+
+void tearDown() {
+    roi_configure(nullptr, 0);
+}
+
+// Weights above 25 °C: 5, 5, 5, 15 -> x = 170/30, y = 80/30
+static void test_centroid() {
+    TEST_ASSERT_EQUAL(2, res.count);
+    TEST_ASSERT_EQUAL(16, res.roi[0].pixels);
+    TEST_ASSERT_EQUAL(4, res.roi[0].above);
+    TEST_ASSERT_INT_WITHIN(1, 1451, res.roi[0].cx_q8);
+    TEST_ASSERT_INT_WITHIN(1, 683, res.roi[0].cy_q8);
+}
+
+static void test_min_max_mean() {
+    TEST_ASSERT_EQUAL(4000, pixel_to_centi(res.roi[0].tmax));
+    TEST_ASSERT_EQUAL(2000, pixel_to_centi(res.roi[0].tmin));
+    TEST_ASSERT_EQUAL(2313, pixel_to_centi(res.roi[0].tmean));   // 370 / 16 °C
+}
+
+static void test_hottest_pixel_fallback() {
+    TEST_ASSERT_EQUAL(0, res.roi[1].above);
+    TEST_ASSERT_EQUAL(1 << 8, res.roi[1].cx_q8);
+    TEST_ASSERT_EQUAL(6 << 8, res.roi[1].cy_q8);
+}
+
+static void test_stats_trailer() {
+    Frame fr;
+    memset(&fr, 0, sizeof(fr));
+    fr.stats  = st;
+    fr.pixels = out;
+    fr.rois   = &res;
+    uint8_t buf[sizeof(ws_stats_packet_t) + WS_ROI_TRAILER_MAX_SIZE];
+    size_t len = ws_stats_encode(fr, buf);
+    const ws_roi_t* w = (const ws_roi_t*)(buf + sizeof(ws_stats_packet_t) + 1);
+    TEST_ASSERT_EQUAL(sizeof(ws_stats_packet_t) + 1 + 2 * sizeof(ws_roi_t), len);
+    TEST_ASSERT_EQUAL(2, buf[sizeof(ws_stats_packet_t)]);
+    TEST_ASSERT_EQUAL(res.roi[0].cx_q8, w[0].cx);
+    TEST_ASSERT_EQUAL(2200, w[1].tmax);
+}
+
+// An empty mask between two ROIs keeps its slot in both paths, so result
+// i is still config ROI i
+static void test_empty_slot_keeps_index() {
+    RoiConfig r[3];
+    memset(r, 0, sizeof(r));
+    r[0].mask = roi_rect_mask(4, 1, 4, 4);    r[0].threshold = 25.0f;
+    r[1].mask = roi_rect_mask(20, 20, 2, 2);  r[1].threshold = 25.0f;   // off the grid
+    r[2].mask = roi_rect_mask(0, 4, 4, 4);    r[2].threshold = 25.0f;
+    TEST_ASSERT_EQUAL(0, r[1].mask);
+    roi_configure(r, 3);
+
+    RoiResults fused, staged;
+    filter_reset();
+    SystemConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    pipeline_process_fused(raw, out, st, cfg, &fused);
+    roi_compute(out, staged);
+
+    RoiStats empty;
+    memset(&empty, 0, sizeof(empty));
+    for (const RoiResults* rr : { &fused, &staged }) {
+        TEST_ASSERT_EQUAL(3, rr->count);
+        TEST_ASSERT_EQUAL(16, rr->roi[0].pixels);
+        TEST_ASSERT_EQUAL_MEMORY(&empty, &rr->roi[1], sizeof(empty));
+        TEST_ASSERT_EQUAL(2200, pixel_to_centi(rr->roi[2].tmax));
+        TEST_ASSERT_EQUAL(6 << 8, rr->roi[2].cy_q8);
+    }
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_centroid);
+    RUN_TEST(test_min_max_mean);
+    RUN_TEST(test_hottest_pixel_fallback);
+    RUN_TEST(test_stats_trailer);
+    RUN_TEST(test_empty_slot_keeps_index);
+    return UNITY_END();
+}
@@ -0,0 +1,140 @@
+// Cooperative scheduler driven with a fake microsecond clock and a jittery
+// loop: deadlines stay on the absolute grid, late runs count overruns, a
+// task that is not ready keeps its deadline, and sched_set_period()
+// re-phases from the last deadline.
+
+#include <unity.h>
+#include <vector>
+
+#include "scheduler.h"
+
+// Fake clock; tasks advance it by their run cost
+static uint32_t fake_us = 0;
+static uint32_t fake_clock() { return fake_us; }
+
+struct FakeTask {
+    std::vector<uint32_t> starts;   // clock at each completed run
+    uint32_t cost_us    = 0;
+    int      not_ready  = 0;        // polls to refuse before running
+    int      refusals   = 0;
+};
+static FakeTask fake_tasks[3];
+
+template <int N>
+static bool fake_task() {
+    FakeTask& t = fake_tasks[N];
+    if (t.not_ready > 0) {
+        t.not_ready--;
+        t.refusals++;
+        return false;
+    }
+    t.starts.push_back(fake_us);
+    fake_us += t.cost_us;
+    return true;
+}
+
+static void reset(uint32_t start_us) {
+    fake_us = start_us;
+    for (FakeTask& t : fake_tasks) t = FakeTask();
+    sched_init(fake_clock);
+}
+
+// Loop passes 0..2 ms apart, as the rest of loop() would take
+static void run_until(uint32_t end_us) {
+    while ((int32_t)(fake_us - end_us) < 0) {
+        sched_run();
+        fake_us += 100 + rand() % 1900;
+    }
+}
+
+static const uint32_t period = 100000;
+
+void setUp() {
+    reset(0);
+}
+
+void tearDown() {}
+
+// 10 s at 100 ms, started near the clock wrap
+static void test_absolute_grid() {
+    const uint32_t t0 = 0xFFFFFFFFu - 4000000u;
+    reset(t0);
+    int id = sched_add("grid", fake_task<0>, period, 0);
+    fake_tasks[0].cost_us = 300;
+    run_until(t0 + 10 * 1000000u);
+    const std::vector<uint32_t>& st = fake_tasks[0].starts;
+    TEST_ASSERT_TRUE(st.size() == 100 || st.size() == 101);
+    uint32_t worst_late = 0;
+    for (size_t k = 0; k < st.size(); k++) {
+        int32_t late = (int32_t)(st[k] - (t0 + (uint32_t)k * period));
+        TEST_ASSERT_GREATER_OR_EQUAL(0, late);
+        TEST_ASSERT_LESS_OR_EQUAL(2000, late);
+        if ((uint32_t)late > worst_late) worst_late = late;
+    }
+    TEST_ASSERT_EQUAL(0, sched_task_stats(id).overruns);
+    TEST_ASSERT_EQUAL(worst_late, sched_task_stats(id).max_jitter_us);
+}
+
+// A 250 ms run on a 100 ms period skips two deadlines each time
+static void test_overruns_stay_in_phase() {
+    int id = sched_add("slow", fake_task<0>, period, 0);
+    fake_tasks[0].cost_us = 250000;
+    run_until(1000000);
+    const SchedTaskStats& slow = sched_task_stats(id);
+    TEST_ASSERT_EQUAL(4, slow.runs);
+    TEST_ASSERT_EQUAL(2 * slow.runs, slow.overruns);
+    for (uint32_t s : fake_tasks[0].starts) TEST_ASSERT_LESS_THAN(2500, s % period);
+}
+
+// Refuses for 5 passes after its first deadline, then runs on the next
+// pass; the deadline after that is still on the grid
+static void test_not_ready_keeps_deadline() {
+    int id = sched_add("wait", fake_task<1>, period, 1);
+    sched_add("tick", fake_task<2>, 0, 0);
+    fake_tasks[1].not_ready = 5;
+    run_until(3 * period + 1);
+    const std::vector<uint32_t>& w = fake_tasks[1].starts;
+    TEST_ASSERT_EQUAL(5, fake_tasks[1].refusals);
+    TEST_ASSERT_EQUAL(3, w.size());
+    TEST_ASSERT_GREATER_THAN(0, w[0]);
+    TEST_ASSERT_UINT32_WITHIN(2000, period + 1000, w[1]);
+    TEST_ASSERT_UINT32_WITHIN(2000, 2 * period + 1000, w[2]);
+    TEST_ASSERT_EQUAL(3, sched_task_stats(id).runs);
+    TEST_ASSERT_EQUAL(0, sched_task_stats(id).overruns);
+    TEST_ASSERT_GREATER_THAN_MESSAGE(100, fake_tasks[2].starts.size(), "every-pass task runs on each pass");
+}
+
+// 1 s -> 100 ms right after a run takes effect one 100 ms period after
+// that run; 100 ms -> 1 s waits a full second from the last deadline; a
+// shortened period whose deadline has passed runs at once
+static void test_set_period_rephases() {
+    int id = sched_add("frame", fake_task<0>, 1000000, 0);
+    run_until(50000);                                  // ran at ~0
+    sched_set_period(id, period);
+    run_until(1000000);
+    const std::vector<uint32_t>& f = fake_tasks[0].starts;
+    TEST_ASSERT_EQUAL(10, f.size());
+    TEST_ASSERT_UINT32_WITHIN(1000, period + 1000, f[1]);
+    sched_set_period(id, 1000000);                     // last deadline 900 ms
+    run_until(2000000);
+    TEST_ASSERT_EQUAL(11, f.size());
+    TEST_ASSERT_UINT32_WITHIN(1000, 1901000, f[10]);
+    run_until(2500000);                                // next deadline 2.9 s
+    sched_set_period(id, period);                      // 2.0 s already past
+    uint32_t at = fake_us;
+    sched_run();
+    TEST_ASSERT_EQUAL(12, f.size());
+    TEST_ASSERT_EQUAL(at, f[11]);
+    TEST_ASSERT_EQUAL(0, sched_task_stats(id).overruns);
+    sched_set_period(id, period);                      // unchanged: no-op
+    TEST_ASSERT_EQUAL(period, sched_task_period(id));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_absolute_grid);
+    RUN_TEST(test_overruns_stay_in_phase);
+    RUN_TEST(test_not_ready_keeps_deadline);
+    RUN_TEST(test_set_period_rephases);
+    return UNITY_END();
+}
@@ -0,0 +1,188 @@
+// Snapshot images decoded back (BMP and PNG, CRCs and Adler-32 included)
+// and checked against an independent colour mapping; the per-frame render
+// cache.
+
+#include <unity.h>
+#include <algorithm>
+#include <vector>
+
+#include "config_store.h"
+#include "snapshot.h"
+
+static std::vector<uint8_t> snapshot_file(const SnapshotStream& st, size_t chunk) {
+    std::vector<uint8_t> out(st.length + 16);
+    size_t len = 0, n;
+    while ((n = snapshot_read(st, len, out.data() + len, std::min(chunk, out.size() - len))) > 0) len += n;
+    out.resize(len);
+    return out;
+}
+
+static uint32_t get_le32(const uint8_t* p) { return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24; }
+static uint32_t get_be32(const uint8_t* p) { return (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3]; }
+
+// Index image (top row first) from an 8-bit BMP; empty if malformed
+static std::vector<uint8_t> decode_bmp(const std::vector<uint8_t>& f, int& side) {
+    std::vector<uint8_t> img;
+    if (f.size() < 1078 || f[0] != 'B' || f[1] != 'M' || get_le32(&f[2]) != f.size()) return img;
+    side = (int)get_le32(&f[18]);
+    uint32_t off = get_le32(&f[10]);
+    if (f[28] != 8 || off + (size_t)side * side != f.size()) return img;
+    img.resize(side * side);
+    for (int y = 0; y < side; y++) memcpy(&img[y * side], &f[off + (side - 1 - y) * side], side);
+    return img;
+}
+
+// Index image from a palette PNG with stored deflate blocks; checks every
+// chunk CRC and the Adler-32. Empty if malformed.
+static std::vector<uint8_t> decode_png(const std::vector<uint8_t>& f, int& side, const uint8_t*& plte) {
+    static const uint8_t sig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    std::vector<uint8_t> img, z;
+    if (f.size() < 8 || memcmp(f.data(), sig, 8)) return img;
+    bool end = false;
+    for (size_t p = 8; p + 12 <= f.size() && !end; ) {
+        uint32_t len = get_be32(&f[p]);
+        if (p + 12 + len > f.size()) return img;
+        if (config_crc32(0, &f[p + 4], len + 4) != get_be32(&f[p + 8 + len])) return img;
+        const uint8_t* d = &f[p + 8];
+        if (!memcmp(&f[p + 4], "IHDR", 4)) {
+            side = (int)get_be32(d);
+            if (get_be32(d + 4) != (uint32_t)side || d[8] != 8 || d[9] != 3) return img;
+        }
+        if (!memcmp(&f[p + 4], "PLTE", 4)) plte = d;
+        if (!memcmp(&f[p + 4], "IDAT", 4)) z.insert(z.end(), d, d + len);
+        if (!memcmp(&f[p + 4], "IEND", 4)) end = true;
+        p += 12 + len;
+    }
+    if (!end || z.size() < 11 || (z[0] * 256 + z[1]) % 31) return img;
+
+    std::vector<uint8_t> raw;
+    size_t q = 2;
+    for (bool last = false; !last; ) {
+        if (q + 5 > z.size() || (z[q] & 0x06)) return img;   // stored blocks only
+        last = z[q] & 1;
+        uint16_t blen = z[q + 1] | z[q + 2] << 8, nlen = z[q + 3] | z[q + 4] << 8;
+        if ((uint16_t)~blen != nlen || q + 5 + blen > z.size()) return img;
+        raw.insert(raw.end(), &z[q + 5], &z[q + 5 + blen]);
+        q += 5 + blen;
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t c : raw) { a = (a + c) % 65521; b = (b + a) % 65521; }
+    if (q + 4 > z.size() || get_be32(&z[q]) != ((b << 16) | a)) return img;
+    if (raw.size() != (size_t)side * (side + 1)) return img;
+
+    img.resize(side * side);
+    for (int y = 0; y < side; y++) {
+        if (raw[y * (side + 1)] != 0) return {};
+        memcpy(&img[y * side], &raw[y * (side + 1) + 1], side);
+    }
+    return img;
+}
+
+static ws_frame_record_t rec;
+
+// Left-to-right ramp 20..27 C plus a hot pixel
+void setUp() {
+    snapshot_init();
+    memset(&rec, 0, sizeof(rec));
+    rec.seq = 1;
+    rec.timestamp_ms = 1000;
+    for (int i = 0; i < GRID_PIXELS; i++) rec.pixels[i] = 2000 + (i % GRID_WIDTH) * 100;
+    rec.pixels[9] = 3000;
+    rec.tmin = 2000;
+    rec.tmax = 3000;
+}
+
+void tearDown() {}
+
+// Matches buildIronbow() in app.js
+static void test_palette() {
+    uint8_t c[3];
+    snapshot_palette(0, c);
+    TEST_ASSERT_TRUE(c[0] == 0 && c[1] == 0 && c[2] == 0);
+    snapshot_palette(128, c);
+    TEST_ASSERT_TRUE(c[0] == 221 && c[1] == 41 && c[2] == 0);
+    snapshot_palette(255, c);
+    TEST_ASSERT_TRUE(c[0] == 255 && c[1] == 255 && c[2] == 255);
+}
+
+static void test_bmp_and_png_decode() {
+    SnapshotParams nearest = { 1, false, true, 0, 0 };
+    SnapshotStream bmp, png;
+    snapshot_begin(rec, SNAPSHOT_BMP, nearest, bmp);
+    snapshot_begin(rec, SNAPSHOT_PNG, nearest, png);
+    int side_bmp = 0, side_png = 0;
+    const uint8_t* plte = nullptr;
+    std::vector<uint8_t> bf = snapshot_file(bmp, 64), pf = snapshot_file(png, 64);
+    std::vector<uint8_t> bi = decode_bmp(bf, side_bmp), pi = decode_png(pf, side_png, plte);
+    TEST_ASSERT_EQUAL_MESSAGE(bmp.length, bf.size(), "declared BMP length");
+    TEST_ASSERT_EQUAL_MESSAGE(png.length, pf.size(), "declared PNG length");
+    TEST_ASSERT_EQUAL(GRID_WIDTH, side_bmp);
+    TEST_ASSERT_EQUAL_MESSAGE(GRID_PIXELS, bi.size(), "BMP decodes");
+    TEST_ASSERT_EQUAL(GRID_WIDTH, side_png);
+    TEST_ASSERT_EQUAL_MESSAGE(GRID_PIXELS, pi.size(), "PNG decodes (CRC, Adler-32)");
+    TEST_ASSERT_TRUE_MESSAGE(bi == pi, "BMP and PNG pixels agree");
+    for (int i = 0; i < GRID_PIXELS; i++) {
+        TEST_ASSERT_EQUAL_MESSAGE(((rec.pixels[i] - 2000) * 255 + 500) / 1000, bi[i], "colour mapping");
+    }
+    uint8_t c[3];
+    snapshot_palette(bi[9], c);
+    TEST_ASSERT_NOT_NULL(plte);
+    TEST_ASSERT_EQUAL_MEMORY(c, plte + 3 * bi[9], 3);
+    TEST_ASSERT_EQUAL_MESSAGE(c[0], bf[54 + 4 * bi[9] + 2], "palette in BMP");
+
+    // Chunk size does not change the bytes
+    TEST_ASSERT_TRUE(snapshot_file(png, 7) == pf);
+    TEST_ASSERT_TRUE(snapshot_file(png, 1460) == pf);
+    TEST_ASSERT_TRUE(snapshot_file(bmp, 1) == bf);
+}
+
+// Bilinear upscale at the largest scale: corners are source pixels, rows
+// of a ramp never step back
+static void test_bilinear_ramp() {
+    SnapshotParams big = { (uint8_t)SNAPSHOT_MAX_SCALE, true, false, 2000, 2700 };
+    SnapshotStream up;
+    snapshot_begin(rec, SNAPSHOT_PNG, big, up);
+    int side = 0;
+    const uint8_t* plte = nullptr;
+    std::vector<uint8_t> ui = decode_png(snapshot_file(up, 1460), side, plte);
+    const int n = GRID_WIDTH * SNAPSHOT_MAX_SCALE;
+    TEST_ASSERT_EQUAL(n, side);
+    TEST_ASSERT_EQUAL(n * n, ui.size());
+    TEST_ASSERT_EQUAL(0, ui[0]);
+    TEST_ASSERT_EQUAL(255, ui[(n - 1) * n + n - 1]);
+    for (int y = n / 2; y < n; y++) {
+        for (int x = 1; x < n; x++) TEST_ASSERT_GREATER_OR_EQUAL(ui[y * n + x - 1], ui[y * n + x]);
+    }
+}
+
+// N pollers in one frame interval: one render; a new frame replaces the
+// cache while a response is half sent without changing its bytes
+static void test_render_cache() {
+    uint32_t renders = snapshot_stats().renders;
+    SnapshotStream polls[10];
+    for (SnapshotStream& s : polls) snapshot_begin(rec, SNAPSHOT_BMP, SnapshotParams{ 4, true, true, 0, 0 }, s);
+    TEST_ASSERT_EQUAL_MESSAGE(renders + 1, snapshot_stats().renders, "one render per frame and parameters");
+
+    std::vector<uint8_t> whole = snapshot_file(polls[0], 1460);
+    std::vector<uint8_t> split(polls[0].length);
+    size_t half = snapshot_read(polls[0], 0, split.data(), polls[0].length / 2);
+    ws_frame_record_t next = rec;
+    next.seq = 2;
+    next.timestamp_ms = 1100;
+    next.pixels[9] = 2000;
+    SnapshotStream other;
+    snapshot_begin(next, SNAPSHOT_BMP, SnapshotParams{ 4, true, true, 0, 0 }, other);
+    uint32_t stale = snapshot_stats().stale_pixels;
+    snapshot_read(polls[0], half, split.data() + half, polls[0].length - half);
+    TEST_ASSERT_TRUE_MESSAGE(split == whole, "response consistent across cache swap");
+    TEST_ASSERT_GREATER_THAN(stale, snapshot_stats().stale_pixels);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_palette);
+    RUN_TEST(test_bmp_and_png_decode);
+    RUN_TEST(test_bilinear_ramp);
+    RUN_TEST(test_render_cache);
+    return UNITY_END();
+}
@@ -0,0 +1,81 @@
+// Trend rollups: 30 h of 1 FPS stats against a brute-force aggregation.
+
+#include <unity.h>
+#include <algorithm>
+#include <vector>
+
+#include "pixel_format.h"
+#include "stats.h"
+#include "trend.h"
+
+static const uint32_t seconds = 30 * 3600;
+static std::vector<int16_t> mins(seconds), maxs(seconds), means(seconds);
+
+// A 10-minute gap exercises missing periods
+static bool in_gap(uint32_t s) { return s >= 5000 && s < 5600; }
+
+void setUp() {
+    trend_init();
+    for (uint32_t s = 0; s < seconds; s++) {
+        if (in_gap(s)) continue;
+        FrameStats st;
+        memset(&st, 0, sizeof(st));
+        mins[s]  = (int16_t)(2000 + (s * 7) % 300);
+        maxs[s]  = (int16_t)(mins[s] + 500 + (s * 13) % 700);
+        means[s] = (int16_t)((mins[s] + maxs[s]) / 2);
+        st.tmin  = pixel_from_c(mins[s] / 100.0f);
+        st.tmax  = pixel_from_c(maxs[s] / 100.0f);
+        st.tmean = pixel_from_c(means[s] / 100.0f);
+        trend_add(s * 1000 + 500, st);
+    }
+}
+
+void tearDown() {
+    trend_init();
+}
+
+static void check_level(TrendLevel level) {
+    uint32_t period = trend_period_s(level);
+    int first;
+    int n = trend_query(level, 0, first);
+    // The gap is shorter than an hour and older than the minute ring
+    TEST_ASSERT_EQUAL(std::min(trend_capacity(level), (int)(seconds / period)), n);
+
+    for (int k = 0; k < n; k++) {
+        const TrendBucket& b = trend_get(level, first + k);
+        int16_t mn = INT16_MAX, mx = INT16_MIN;
+        int32_t sum = 0;
+        uint16_t count = 0;
+        for (uint32_t s = b.start_s; s < b.start_s + period && s < seconds; s++) {
+            if (in_gap(s)) continue;
+            if (mins[s] < mn) mn = mins[s];
+            if (maxs[s] > mx) mx = maxs[s];
+            sum += means[s];
+            count++;
+        }
+        if (k > 0) TEST_ASSERT_GREATER_THAN(trend_get(level, first + k - 1).start_s, b.start_s);
+        char what[64];
+        snprintf(what, sizeof(what), "%s bucket %u", trend_level_name(level), b.start_s);
+        TEST_ASSERT_EQUAL_MESSAGE(mn, b.tmin, what);
+        TEST_ASSERT_EQUAL_MESSAGE(mx, b.tmax, what);
+        TEST_ASSERT_EQUAL_MESSAGE(count, b.count, what);
+        TEST_ASSERT_EQUAL_MESSAGE(sum, b.mean_sum, what);
+    }
+}
+
+static void test_levels_match_brute_force() {
+    for (int l = 0; l < TREND_LEVEL_COUNT; l++) check_level((TrendLevel)l);
+}
+
+// Last 24 h at hour resolution
+static void test_query_since() {
+    int first;
+    TEST_ASSERT_EQUAL(24, trend_query(TREND_HOUR, seconds - 24 * 3600, first));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_levels_match_brute_force);
+    RUN_TEST(test_query_since);
+    return UNITY_END();
+}
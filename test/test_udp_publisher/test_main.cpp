@@ -0,0 +1,128 @@
+// UDP publisher: datagram layout, decimation and link handling, and loss
+// accounting against a loopback receiver.
+
+#include <unity.h>
+#include <vector>
+#include <unistd.h>
+
+#include "fixtures.h"
+#include "pixel_format.h"
+#include "stats.h"
+#include "ws_codec.h"
+#include "udp_publisher.h"
+
+static const uint8_t loopback[4] = { 127, 0, 0, 1 };
+static Sequence                seq = make_walk_in(200);
+static std::vector<pixel_t>    pixels;
+static std::vector<FrameStats> stats;
+static UdpReceiver             rx;
+static uint16_t                port;
+
+static Frame frame_at(size_t f) {
+    const size_t n = seq.frames();
+    Frame fr;
+    memset(&fr, 0, sizeof(fr));
+    fr.seq          = (uint32_t)f;
+    fr.timestamp_ms = (uint32_t)f * 100;
+    fr.stats        = stats[f % n];
+    fr.pixels       = &pixels[(f % n) * GRID_PIXELS];
+    return fr;
+}
+
+void setUp() {
+    const size_t n = seq.frames();
+    pixels.resize(n * GRID_PIXELS);
+    stats.resize(n);
+    for (size_t i = 0; i < n * GRID_PIXELS; i++) pixels[i] = pixel_from_c(seq.celsius[i]);
+    for (size_t f = 0; f < n; f++) stats_compute(&pixels[f * GRID_PIXELS], stats[f]);
+    rx = UdpReceiver();
+    if (!udp_loopback_open(rx, port)) TEST_IGNORE_MESSAGE("no loopback socket");
+    udp_publisher_init(&host_udp);
+}
+
+void tearDown() {
+    udp_publisher_configure(false, loopback, port, 1);
+    udp_loopback_close(rx);
+    udp_drop_every = 0;
+}
+
+// Header then the same record the batch channel carries
+static void test_datagram_layout() {
+    uint8_t dg[UDP_DATAGRAM_SIZE];
+    udp_frame_header_t h;
+    ws_frame_record_t rec, want;
+    size_t len = udp_datagram_build(frame_at(3), 77, 1234, dg);
+    memcpy(&h, dg, sizeof(h));
+    memcpy(&rec, dg + sizeof(h), sizeof(rec));
+    ws_record_encode(frame_at(3), want);
+    TEST_ASSERT_EQUAL(UDP_DATAGRAM_SIZE, len);
+    TEST_ASSERT_EQUAL_MEMORY(UDP_MAGIC, h.magic, 2);
+    TEST_ASSERT_EQUAL(77, h.seq);
+    TEST_ASSERT_EQUAL(1234, h.sent_ms);
+    TEST_ASSERT_EQUAL(GRID_WIDTH, h.grid_w);
+    TEST_ASSERT_EQUAL(GRID_HEIGHT, h.grid_h);
+    TEST_ASSERT_EQUAL(sizeof(rec), h.record_size);
+    TEST_ASSERT_EQUAL_MEMORY(&want, &rec, sizeof(rec));
+}
+
+// Disabled, decimated, and without a link
+static void test_decimation_and_link() {
+    udp_publisher_configure(false, loopback, port, 1);
+    TEST_ASSERT_FALSE_MESSAGE(udp_publish(frame_at(0), 0, true), "disabled publisher sends nothing");
+    udp_publisher_configure(true, loopback, port, 3);
+    int sent = 0;
+    for (int f = 0; f < 9; f++) sent += udp_publish(frame_at(f), 0, true);
+    TEST_ASSERT_EQUAL_MESSAGE(3, sent, "every 3rd frame");
+    udp_publisher_configure(true, loopback, port, 1);
+    uint32_t seq_before = udp_publisher_stats().seq;
+    TEST_ASSERT_FALSE(udp_publish(frame_at(0), 0, false));
+    TEST_ASSERT_EQUAL(1, udp_publisher_stats().no_link);
+    TEST_ASSERT_EQUAL_MESSAGE(seq_before, udp_publisher_stats().seq, "no seq without a link");
+    usleep(10000);
+    rx.drain();
+    TEST_ASSERT_EQUAL(3, rx.received);
+    TEST_ASSERT_EQUAL(0, rx.lost);
+    TEST_ASSERT_EQUAL(0, rx.bad);
+}
+
+static void run(uint32_t frames) {
+    for (uint32_t f = 0; f < frames; f++) {
+        udp_publish(frame_at(f), f, true);
+        if (f % 64 == 63) rx.drain();
+    }
+    usleep(20000);
+    rx.drain();
+}
+
+static void test_every_seq_accounted_for() {
+    udp_publisher_configure(true, loopback, port, 1);
+    const uint32_t frames = 5000;
+    run(frames);
+    TEST_ASSERT_EQUAL(frames, rx.received + rx.lost);
+    TEST_ASSERT_EQUAL(0, rx.bad);
+    TEST_ASSERT_EQUAL(0, rx.late);
+}
+
+// Refused sends keep their seq, so receivers measure them as loss (the run
+// ends on a delivered datagram: loss at the very end is invisible)
+static void test_refused_sends_are_loss() {
+    udp_publisher_configure(true, loopback, port, 1);
+    const uint32_t frames = 5000;
+    udp_drop_every = 20;
+    udp_send_calls = 0;
+    uint32_t errors_before = udp_publisher_stats().send_errors;
+    run(frames + 1);
+    uint32_t errors = udp_publisher_stats().send_errors - errors_before;
+    TEST_ASSERT_EQUAL(frames / 20, errors);
+    TEST_ASSERT_EQUAL(errors, rx.lost);
+    TEST_ASSERT_EQUAL(frames + 1 - errors, rx.received);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_datagram_layout);
+    RUN_TEST(test_decimation_and_link);
+    RUN_TEST(test_every_seq_accounted_for);
+    RUN_TEST(test_refused_sends_are_loss);
+    return UNITY_END();
+}
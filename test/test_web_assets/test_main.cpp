@@ -0,0 +1,102 @@
+// Static web assets on a fixture manifest: reply headers, ETag / 304 and
+// what a browser fetches on cold, warm and post-update page loads.
+
+#include <unity.h>
+#include <map>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fixtures.h"
+#include "web_assets.h"
+
+static char root[64];
+
+static void write_manifest(const char* text) {
+    ::mkdir((std::string(root) + WEB_ASSET_DIR).c_str(), 0755);
+    FILE* f = fopen((std::string(root) + WEB_ASSET_MANIFEST).c_str(), "w");
+    TEST_ASSERT_NOT_NULL(f);
+    fputs(text, f);
+    fclose(f);
+}
+
+void setUp() {
+    snprintf(root, sizeof(root), "/tmp/test_littlefs_XXXXXX");
+    TEST_ASSERT_NOT_NULL(mkdtemp(root));
+    setenv("HOST_FS_ROOT", root, 1);
+    write_manifest(
+        "app.0123abcd.js 00112233aabbccdd gi 7000 26000\n"
+        "index.html 445566778899eeff g 1400 5400\n"
+        "favicon.89ab4567.png 0f0e0d0c0b0a0908 i 300 300\n"
+        "not a valid line\n");
+}
+
+void tearDown() {
+    unlink((std::string(root) + WEB_ASSET_MANIFEST).c_str());
+    rmdir((std::string(root) + WEB_ASSET_DIR).c_str());
+    rmdir(root);
+}
+
+static void test_manifest_parsed() {
+    TEST_ASSERT_EQUAL(3, web_assets_load());
+}
+
+static void test_reply_headers() {
+    web_assets_load();
+    WebAssetReply r;
+    TEST_ASSERT_EQUAL(200, web_asset_reply("/", nullptr, r));
+    TEST_ASSERT_TRUE(r.asset == web_asset_find("/index.html"));
+    TEST_ASSERT_EQUAL_STRING("text/html", r.content_type);
+    TEST_ASSERT_EQUAL_STRING("gzip", r.content_encoding);
+    TEST_ASSERT_EQUAL_STRING(WEB_CACHE_REVALIDATE, r.cache_control);
+    TEST_ASSERT_EQUAL_STRING("/www/index.html.gz", r.path);
+    TEST_ASSERT_EQUAL_STRING("\"445566778899eeff\"", r.asset->etag);
+
+    TEST_ASSERT_EQUAL(200, web_asset_reply("/app.0123abcd.js", "", r));
+    TEST_ASSERT_EQUAL_STRING("application/javascript", r.content_type);
+    TEST_ASSERT_EQUAL_STRING(WEB_CACHE_IMMUTABLE, r.cache_control);
+
+    TEST_ASSERT_EQUAL(200, web_asset_reply("/favicon.89ab4567.png", nullptr, r));
+    TEST_ASSERT_NULL(r.content_encoding);
+    TEST_ASSERT_EQUAL_STRING("/www/favicon.89ab4567.png", r.path);
+}
+
+static void test_etag_matching() {
+    web_assets_load();
+    WebAssetReply r;
+    const char* matching[] = { "\"445566778899eeff\"", "W/\"445566778899eeff\"",
+                               "\"0000000000000000\", \"445566778899eeff\"", "*" };
+    for (const char* inm : matching) {
+        TEST_ASSERT_EQUAL_MESSAGE(304, web_asset_reply("/index.html", inm, r), inm);
+    }
+    TEST_ASSERT_EQUAL_MESSAGE(200, web_asset_reply("/index.html", "\"445566778899eefe\"", r), "stale ETag");
+    TEST_ASSERT_EQUAL(404, web_asset_reply("/app.js", nullptr, r));
+    TEST_ASSERT_EQUAL(404, web_asset_reply("/manifest.txt", nullptr, r));
+}
+
+static void test_page_loads() {
+    web_assets_load();
+    std::map<std::string, std::string> cache;
+    PageLoad cold = page_load(cache), warm = page_load(cache);
+    TEST_ASSERT_EQUAL_MESSAGE(3, cold.requests, "cold load fetches everything");
+    TEST_ASSERT_EQUAL(8700, cold.bytes);
+    TEST_ASSERT_EQUAL_MESSAGE(1, warm.requests, "warm load revalidates index only");
+    TEST_ASSERT_EQUAL(1, warm.not_modified);
+    TEST_ASSERT_EQUAL(0, warm.bytes);
+
+    // A new build changes index.html and the hashed names it points at
+    write_manifest(
+        "app.4567cdef.js 8899aabbccddeeff gi 7100 26100\n"
+        "index.html 1122334455667788 g 1400 5400\n");
+    web_assets_load();
+    TEST_ASSERT_EQUAL_MESSAGE(1400 + 7100, page_load(cache).bytes, "new build fetches changed files");
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_manifest_parsed);
+    RUN_TEST(test_reply_headers);
+    RUN_TEST(test_etag_matching);
+    RUN_TEST(test_page_loads);
+    return UNITY_END();
+}
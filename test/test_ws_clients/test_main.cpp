@@ -0,0 +1,179 @@
+// Per-client send policy with a slow consumer, and the ping / pong / echo
+// link telemetry.
+
+#include <unity.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "fixtures.h"
+#include "pixel_format.h"
+#include "stats.h"
+#include "ws_codec.h"
+#include "ws_clients.h"
+
+void setUp() {
+    ws_clients_init();
+}
+
+void tearDown() {
+    ws_clients_init();
+}
+
+// Stand-in for one AsyncTCP client queue: messages sent this tick are
+// delivered (decoded) when the client drains them
+struct QueueSocket {
+    std::deque<std::vector<uint8_t>> queue;
+    V2Decoder dec;
+    size_t    received = 0, undecodable = 0, keys = 0, max_depth = 0;
+    uint16_t  last_seq = 0;
+
+    void send(const uint8_t* p, size_t len) {
+        queue.emplace_back(p, p + len);
+        max_depth = std::max(max_depth, queue.size());
+    }
+    void drain() {
+        int16_t centi[GRID_PIXELS];
+        ws_v2_header_t h;
+        for (; !queue.empty(); queue.pop_front()) {
+            const std::vector<uint8_t>& m = queue.front();
+            if (v2_decode(dec, m.data(), m.size(), centi, h)) {
+                received++;
+                last_seq = h.seq;
+                if (h.kind == WS_V2_KEYFRAME) keys++;
+            } else {
+                undecodable++;
+            }
+        }
+    }
+};
+
+// Two v2 clients on one shared encoder, fanned out as webserver_broadcast()
+// does. The slow one stops draining for a while: once its queue reaches the
+// watermark it must skip frames, resume with a resync keyframe and decode
+// every frame it gets, while the fast one receives every frame on time.
+static void test_slow_consumer() {
+    const Sequence seq = make_walk_in(200);
+    const size_t n = seq.frames();
+    std::vector<pixel_t> pixels(n * GRID_PIXELS);
+    for (size_t i = 0; i < n * GRID_PIXELS; i++) pixels[i] = pixel_from_c(seq.celsius[i]);
+
+    WsClientSlot* slot[2] = { ws_clients_add(1), ws_clients_add(2) };
+    for (WsClientSlot* c : slot) {
+        c->format   = WS_FORMAT_V2;
+        c->quant    = WS_QUANT_I16;
+        c->need_key = true;
+    }
+    QueueSocket sock[2];
+    WsV2Encoder enc;
+    ws_v2_encoder_init(enc, WS_QUANT_I16);
+
+    const size_t stall_from = 25, stall_to = 60;     // slow client drains nothing
+    size_t fast_late = 0, skipped = 0, resyncs = 0;
+    uint8_t buf[WS_V2_MAX_SIZE], key[WS_V2_MAX_SIZE];
+    for (size_t f = 0; f < n; f++) {
+        Frame fr;
+        memset(&fr, 0, sizeof(fr));
+        fr.seq    = (uint32_t)f;
+        fr.pixels = &pixels[f * GRID_PIXELS];
+        stats_compute(fr.pixels, fr.stats);
+        size_t len = ws_v2_encode(enc, fr, buf);
+        bool is_key = ((const ws_v2_header_t*)buf)->kind == WS_V2_KEYFRAME;
+        size_t key_len = 0;
+
+        for (int i = 0; i < 2; i++) {
+            if (!ws_client_due(*slot[i])) continue;
+            switch (ws_client_policy(*slot[i], sock[i].queue.size(), is_key)) {
+                case WS_SEND_SKIP:
+                    if (i == 1) skipped++;
+                    break;
+                case WS_SEND_RESYNC:
+                    if (!key_len) key_len = ws_v2_encode_resync(enc, fr, key);
+                    sock[i].send(key, key_len);
+                    if (i == 1 && f > stall_from) resyncs++;
+                    break;
+                case WS_SEND_FRAME:
+                    sock[i].send(buf, len);
+                    break;
+            }
+        }
+
+        sock[0].drain();
+        if (f < stall_from || f >= stall_to) sock[1].drain();
+        if (sock[0].received != f + 1 || sock[0].last_seq != (uint16_t)f) fast_late++;
+    }
+    sock[1].drain();
+
+    TEST_ASSERT_EQUAL_MESSAGE(0, fast_late, "fast client gets every frame in the tick it was produced");
+    TEST_ASSERT_EQUAL(1, sock[0].max_depth);
+    TEST_ASSERT_EQUAL(0, slot[0]->dropped);
+    TEST_ASSERT_EQUAL_MESSAGE(WS_CLIENT_QUEUE_WATERMARK, sock[1].max_depth, "slow queue stops at the watermark");
+    // The first frames of the stall fill the queue; the frame produced as
+    // it starts draining again still finds it full
+    TEST_ASSERT_EQUAL(stall_to - stall_from - WS_CLIENT_QUEUE_WATERMARK + 1, skipped);
+    TEST_ASSERT_EQUAL(skipped, slot[1]->dropped);
+    TEST_ASSERT_EQUAL(skipped, ws_clients_total_dropped());
+    TEST_ASSERT_EQUAL_MESSAGE(1, resyncs, "slow client resumes with one resync keyframe");
+    TEST_ASSERT_EQUAL(0, sock[0].undecodable);
+    TEST_ASSERT_EQUAL(0, sock[1].undecodable);
+    TEST_ASSERT_EQUAL(n - skipped, sock[1].received);
+    TEST_ASSERT_EQUAL((uint16_t)(n - 1), sock[1].last_seq);
+}
+
+// The client clock is ahead by `offset` ms, each direction takes `path_us`
+// plus 20 ms of queueing on every other sample
+static void test_ping_echo() {
+    WsClientSlot* c = ws_clients_add(1);
+    const double   offset  = 123456.75;
+    const uint32_t path_us = 3000;
+    uint32_t dev_us = 4294000000u;         // wraps during the exchange
+    uint32_t dev_ms = 1000;
+    uint8_t  pong_buf[sizeof(ws_pong_packet_t)];
+    for (int i = 0; i < 16; i++) {
+        uint32_t extra = (i % 2) ? 20000 : 0;
+        ws_ping_t ping = { WS_MSG_PING, 0, (uint16_t)i, dev_ms - path_us / 1000.0 + offset };
+        size_t n = ws_client_ping(*c, (const uint8_t*)&ping, sizeof(ping), dev_ms, dev_us, pong_buf);
+        ws_pong_packet_t pong;
+        memcpy(&pong, pong_buf, sizeof(pong));
+        TEST_ASSERT_EQUAL(sizeof(pong), n);
+        TEST_ASSERT_EQUAL(WS_PKT_PONG, pong.type);
+        TEST_ASSERT_EQUAL(i, pong.id);
+        TEST_ASSERT_TRUE(pong.client_ms == ping.client_ms);
+
+        uint32_t down = path_us + extra;
+        ws_echo_t echo;
+        memset(&echo, 0, sizeof(echo));
+        echo.type       = WS_MSG_ECHO;
+        echo.id         = pong.id;
+        echo.device_ms  = pong.device_ms;
+        echo.device_us  = pong.device_us;
+        echo.client_ms  = pong.device_ms + down / 1000.0 + offset;
+        echo.frames     = 100 + i;
+        echo.lost       = 2;
+        echo.latency_ms = 41;
+        dev_us += down + path_us;
+        ws_client_echo(*c, (const uint8_t*)&echo, sizeof(echo), dev_us);
+        dev_us += 1000000;
+        dev_ms += 1000;
+    }
+    TEST_ASSERT_EQUAL(16, c->pings);
+    TEST_ASSERT_EQUAL_MESSAGE(2 * path_us, c->rtt_min_us, "round trip measured on the device clock");
+    TEST_ASSERT_EQUAL(2 * path_us + 20000, c->rtt_us);
+    TEST_ASSERT_EQUAL_MESSAGE((int32_t)lround(offset), c->clock_offset_ms, "offset from the fastest samples only");
+    TEST_ASSERT_GREATER_THAN(c->rtt_min_us, c->rtt_avg_us);
+    TEST_ASSERT_LESS_THAN(c->rtt_min_us + 20000, c->rtt_avg_us);
+    TEST_ASSERT_EQUAL(115, c->client_frames);
+    TEST_ASSERT_EQUAL(2, c->client_lost);
+    TEST_ASSERT_EQUAL(41, c->latency_ms);
+
+    uint8_t short_ping[] = { WS_MSG_PING, 0, 1, 0 };
+    TEST_ASSERT_EQUAL(0, ws_client_ping(*c, short_ping, sizeof(short_ping), 0, 0, pong_buf));
+    TEST_ASSERT_FALSE(ws_client_echo(*c, short_ping, sizeof(short_ping), 0));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_slow_consumer);
+    RUN_TEST(test_ping_echo);
+    return UNITY_END();
+}
@@ -0,0 +1,191 @@
+// v2 frame encoding: decode round trip in both quantizations, sizes known
+// before encoding, and the timing trailer.
+
+#include <unity.h>
+#include <vector>
+
+#include "fixtures.h"
+#include "pixel_format.h"
+#include "stats.h"
+#include "roi.h"
+#include "ws_codec.h"
+
+void setUp() {}
+void tearDown() {}
+
+// Encodes the sequence as a v2 stream, decodes it back and bounds the
+// per-pixel error: int16 is lossless, int8 within half a quantization step
+static void check_round_trip(const Sequence& seq, uint8_t quant) {
+    const size_t n = seq.frames();
+    std::vector<pixel_t> pixels(n * GRID_PIXELS);
+    for (size_t i = 0; i < n * GRID_PIXELS; i++) pixels[i] = pixel_from_c(seq.celsius[i]);
+
+    WsV2Encoder enc;
+    ws_v2_encoder_init(enc, quant);
+    V2Decoder dec;
+    uint8_t buf[WS_V2_MAX_SIZE];
+    int16_t centi[GRID_PIXELS];
+    ws_v2_header_t h;
+    size_t keys = 0;
+    for (size_t f = 0; f < n; f++) {
+        Frame fr;
+        memset(&fr, 0, sizeof(fr));
+        fr.seq    = (uint32_t)f;
+        fr.pixels = &pixels[f * GRID_PIXELS];
+        stats_compute(fr.pixels, fr.stats);
+        size_t len = ws_v2_encode(enc, fr, buf);
+        char what[96];
+        snprintf(what, sizeof(what), "%s quant %u frame %zu", seq.name.c_str(), quant, f);
+        TEST_ASSERT_TRUE_MESSAGE(v2_decode(dec, buf, len, centi, h), what);
+        TEST_ASSERT_EQUAL_MESSAGE((uint16_t)f, h.seq, what);
+        if (h.kind == WS_V2_KEYFRAME) keys++;
+        int bound = quant == WS_QUANT_I16 ? 0 : h.step / 2;
+        for (int i = 0; i < GRID_PIXELS; i++) {
+            TEST_ASSERT_INT_WITHIN_MESSAGE(bound, pixel_to_centi(fr.pixels[i]), centi[i], what);
+        }
+    }
+    TEST_ASSERT_GREATER_OR_EQUAL(n / WS_V2_KEYFRAME_INTERVAL, keys);
+    TEST_ASSERT_LESS_THAN(n, keys);
+}
+
+static void test_round_trip_i16() {
+    check_round_trip(make_static_scene(200), WS_QUANT_I16);
+    check_round_trip(make_walk_in(200), WS_QUANT_I16);
+}
+
+static void test_round_trip_i8() {
+    check_round_trip(make_static_scene(200), WS_QUANT_I8);
+    check_round_trip(make_walk_in(200), WS_QUANT_I8);
+}
+
+// Encodings are written straight into a message buffer allocated from the
+// size reported beforehand, so every size must be exact, and a prepared
+// frame that is never written must leave the stream as it was
+static void test_sizes_known_before_encoding() {
+    const Sequence seq = make_walk_in(200);
+    RoiResults rois;
+    memset(&rois, 0, sizeof(rois));
+    rois.count = 3;
+
+    pixel_t pixels[GRID_PIXELS];
+    uint8_t buf[WS_V2_MAX_SIZE];
+    for (uint8_t q = WS_QUANT_I16; q <= WS_QUANT_I8; q++) {
+        WsV2Encoder enc;
+        ws_v2_encoder_init(enc, q, WS_V2_EXT_ROI | WS_V2_EXT_TIMING);
+        for (size_t f = 0; f < seq.frames(); f++) {
+            for (int i = 0; i < GRID_PIXELS; i++) pixels[i] = pixel_from_c(seq.celsius[f * GRID_PIXELS + i]);
+            Frame fr;
+            memset(&fr, 0, sizeof(fr));
+            fr.seq    = (uint32_t)f;
+            fr.pixels = pixels;
+            fr.rois   = (f % 3) ? &rois : nullptr;
+            stats_compute(fr.pixels, fr.stats);
+
+            WsV2Encoder before = enc;
+            size_t want = ws_v2_prepare(enc, fr);
+            if (f % 7 == 6) {
+                // Allocation failed: nothing may have been committed
+                TEST_ASSERT_EQUAL(before.primed, enc.primed);
+                TEST_ASSERT_EQUAL(before.base, enc.base);
+                TEST_ASSERT_EQUAL(before.step, enc.step);
+                TEST_ASSERT_EQUAL(before.since_key, enc.since_key);
+                TEST_ASSERT_EQUAL_MEMORY(before.q_prev, enc.q_prev, sizeof(enc.q_prev));
+                continue;
+            }
+            TEST_ASSERT_EQUAL(want, ws_v2_write(enc, fr, buf));
+            TEST_ASSERT_LESS_OR_EQUAL(WS_V2_MAX_SIZE, want);
+            size_t key_want = ws_v2_resync_size(enc, fr);
+            TEST_ASSERT_EQUAL(key_want, ws_v2_encode_resync(enc, fr, buf));
+            size_t st_want = ws_stats_size(fr);
+            TEST_ASSERT_EQUAL(st_want, ws_stats_encode(fr, buf));
+        }
+    }
+}
+
+// ── Timing trailer ──────────────────────────────────
+
+static ws_timing_t trailer(const uint8_t* msg, size_t len) {
+    ws_timing_t t;
+    memcpy(&t, msg + len - sizeof(t), sizeof(t));
+    return t;
+}
+
+// After the ROI trailer, on keyframes, deltas and resyncs; the enqueue stamp
+static void test_timing_trailer() {
+    const Sequence seq = make_walk_in(2);
+    pixel_t pixels[2 * GRID_PIXELS];
+    for (int i = 0; i < 2 * GRID_PIXELS; i++) pixels[i] = pixel_from_c(seq.celsius[i]);
+    RoiResults rois;
+    memset(&rois, 0, sizeof(rois));
+    rois.count = 2;
+    rois.roi[1].tmax  = pixel_from_c(31.5f);
+    rois.roi[1].above = 3;
+
+    Frame fr;
+    memset(&fr, 0, sizeof(fr));
+    fr.seq          = 70000;               // beyond the header's 16 bits
+    fr.timestamp_ms = 500000;
+    fr.capture_us   = 4000000000u;         // micros() about to wrap
+    fr.processed_us = fr.capture_us + 2300;
+    fr.rois         = &rois;
+    fr.pixels       = pixels;
+    stats_compute(fr.pixels, fr.stats);
+
+    WsV2Encoder enc;
+    ws_v2_encoder_init(enc, WS_QUANT_I16, WS_V2_EXT_ROI | WS_V2_EXT_TIMING);
+    uint8_t buf[WS_V2_MAX_SIZE], key[WS_V2_MAX_SIZE];
+
+    size_t len = ws_v2_encode(enc, fr, buf);
+    ws_v2_header_t h;
+    memcpy(&h, buf, sizeof(h));
+    const size_t roi_at = sizeof(ws_v2_header_t) + 2 * GRID_PIXELS;
+    TEST_ASSERT_EQUAL(WS_V2_EXT_ROI | WS_V2_EXT_TIMING, h.ext);
+    TEST_ASSERT_EQUAL(roi_at + 1 + 2 * sizeof(ws_roi_t) + sizeof(ws_timing_t), len);
+    TEST_ASSERT_EQUAL(2, buf[roi_at]);
+    ws_timing_t t = trailer(buf, len);
+    TEST_ASSERT_EQUAL_UINT32(70000, t.frame_seq);
+    TEST_ASSERT_EQUAL_UINT32(499998, t.capture_ms);
+    TEST_ASSERT_EQUAL(2300, t.process_us);
+    TEST_ASSERT_EQUAL(2300, t.enqueue_us);
+
+    ws_v2_stamp_enqueue(buf, len, fr.capture_us, fr.capture_us + 2750);
+    t = trailer(buf, len);
+    TEST_ASSERT_EQUAL(2750, t.enqueue_us);
+    TEST_ASSERT_EQUAL(2300, t.process_us);
+    ws_v2_stamp_enqueue(buf, len, fr.capture_us, fr.capture_us + 900000);
+    TEST_ASSERT_EQUAL_MESSAGE(0xFFFF, trailer(buf, len).enqueue_us, "enqueue stamp saturates");
+
+    // Next frame: a delta without ROIs still carries the trailer
+    fr.seq++;
+    fr.timestamp_ms += 100;
+    fr.rois   = nullptr;
+    fr.pixels = &pixels[GRID_PIXELS];
+    stats_compute(fr.pixels, fr.stats);
+    len = ws_v2_encode(enc, fr, buf);
+    memcpy(&h, buf, sizeof(h));
+    TEST_ASSERT_EQUAL(WS_V2_DELTA, h.kind);
+    TEST_ASSERT_EQUAL(WS_V2_EXT_TIMING, h.ext);
+    TEST_ASSERT_EQUAL_UINT32(70001, trailer(buf, len).frame_seq);
+    size_t key_len = ws_v2_encode_resync(enc, fr, key);
+    TEST_ASSERT_EQUAL(sizeof(ws_v2_header_t) + 2 * GRID_PIXELS + sizeof(ws_timing_t), key_len);
+    TEST_ASSERT_EQUAL_UINT32(70001, trailer(key, key_len).frame_seq);
+
+    // Without the ext bit nothing changes and stamping is a no-op
+    WsV2Encoder plain;
+    ws_v2_encoder_init(plain, WS_QUANT_I16);
+    len = ws_v2_encode(plain, fr, buf);
+    uint8_t before[WS_V2_MAX_SIZE];
+    memcpy(before, buf, len);
+    ws_v2_stamp_enqueue(buf, len, 0, 1000);
+    TEST_ASSERT_EQUAL(sizeof(ws_v2_header_t) + 2 * GRID_PIXELS, len);
+    TEST_ASSERT_EQUAL_MEMORY(before, buf, len);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_i16);
+    RUN_TEST(test_round_trip_i8);
+    RUN_TEST(test_sizes_known_before_encoding);
+    RUN_TEST(test_timing_trailer);
+    return UNITY_END();
+}
@@ -0,0 +1,154 @@
+// WebSocket control messages through an in-memory socket: set-param acks
+// (seq, clamping, rejects), the status reply and deferred persistence.
+
+#include <unity.h>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "config.h"
+#include "config_store.h"
+#include "ws_control.h"
+#include <LittleFS.h>
+
+// In-memory stand-in for one WebSocket: whole binary messages in each
+// direction, as the async library delivers them to onWsEvent
+struct FakeSocket {
+    std::vector<std::vector<uint8_t>> to_device, to_client;
+
+    void client_send(const void* p, size_t n) {
+        to_device.emplace_back((const uint8_t*)p, (const uint8_t*)p + n);
+    }
+    // What webserver.cpp does for one WS_EVT_DATA
+    void device_poll(uint32_t now_ms, const WsControlLive& live) {
+        for (const std::vector<uint8_t>& m : to_device) {
+            uint8_t reply[WS_CONTROL_REPLY_MAX];
+            size_t n = ws_control_handle(m.data(), m.size(), now_ms, live, reply);
+            if (n) to_client.emplace_back(reply, reply + n);
+        }
+        to_device.clear();
+    }
+    bool client_recv(std::vector<uint8_t>& m) {
+        if (to_client.empty()) return false;
+        m = to_client.front();
+        to_client.erase(to_client.begin());
+        return true;
+    }
+};
+
+static char                 root[64];
+static FakeSocket           sock;
+static const WsControlLive  live = { 5, 1, false };
+static uint16_t             seq;
+
+static bool set(uint8_t param, float value, uint32_t now_ms, ws_ack_packet_t& ack) {
+    std::vector<uint8_t> m;
+    ws_set_param_t req = { WS_MSG_SET_PARAM, param, ++seq, value };
+    sock.client_send(&req, sizeof(req));
+    sock.device_poll(now_ms, live);
+    memset(&ack, 0, sizeof(ack));
+    if (!sock.client_recv(m) || m.size() != sizeof(ack) || m[0] != WS_PKT_ACK) return false;
+    memcpy(&ack, m.data(), sizeof(ack));
+    return ack.seq == seq && ack.param == param;
+}
+
+static bool status(ws_status_packet_t& st) {
+    std::vector<uint8_t> m;
+    ws_get_status_t req = { WS_MSG_GET_STATUS, 0, ++seq };
+    sock.client_send(&req, sizeof(req));
+    sock.device_poll(0, live);
+    if (!sock.client_recv(m) || m.size() != sizeof(st) || m[0] != WS_PKT_STATUS) return false;
+    memcpy(&st, m.data(), sizeof(st));
+    return st.seq == seq;
+}
+
+void setUp() {
+    snprintf(root, sizeof(root), "/tmp/test_littlefs_XXXXXX");
+    TEST_ASSERT_NOT_NULL(mkdtemp(root));
+    setenv("HOST_FS_ROOT", root, 1);
+    LittleFS.begin();
+    config_store_erase();
+    config_init();
+    sock = FakeSocket();
+    seq  = 0;
+}
+
+void tearDown() {
+    config_poll(1000000);                            // flush a pending save
+    config_store_erase();
+    rmdir(root);
+    config_init();
+    config_apply();
+}
+
+static void test_set_param_acks() {
+    SystemConfig& cfg = config_get();
+    ws_ack_packet_t ack;
+    TEST_ASSERT_TRUE(set(WS_PARAM_ALPHA, 0.5f, 0, ack));
+    TEST_ASSERT_EQUAL(WS_ACK_OK, ack.status);
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, cfg.alpha);
+
+    TEST_ASSERT_TRUE(set(WS_PARAM_ALPHA, 5.0f, 0, ack));
+    TEST_ASSERT_EQUAL_MESSAGE(WS_ACK_CLAMPED, ack.status, "out-of-range alpha clamped");
+    TEST_ASSERT_EQUAL_FLOAT(0.8f, ack.value);
+    TEST_ASSERT_EQUAL_FLOAT(0.8f, cfg.alpha);
+
+    TEST_ASSERT_TRUE(set(WS_PARAM_NORMAL_FPS, 7, 0, ack));
+    TEST_ASSERT_EQUAL_MESSAGE(WS_ACK_CLAMPED, ack.status, "fps snapped to a supported rate");
+    TEST_ASSERT_EQUAL(10, cfg.normal_fps);
+
+    TEST_ASSERT_TRUE(set(WS_PARAM_OFFSET, -1.25f, 0, ack));
+    TEST_ASSERT_EQUAL(WS_ACK_OK, ack.status);
+    TEST_ASSERT_EQUAL_FLOAT(-1.25f, cfg.calibration_offset);
+}
+
+static void test_rejects() {
+    ws_ack_packet_t ack;
+    TEST_ASSERT_TRUE(set(WS_PARAM_ALPHA, 0.8f, 0, ack));
+    TEST_ASSERT_TRUE(set(WS_PARAM_COUNT, 1, 0, ack));
+    TEST_ASSERT_EQUAL_MESSAGE(WS_ACK_BAD_PARAM, ack.status, "unknown parameter rejected");
+    TEST_ASSERT_TRUE(set(WS_PARAM_ALPHA, NAN, 0, ack));
+    TEST_ASSERT_EQUAL_MESSAGE(WS_ACK_BAD_VALUE, ack.status, "NaN rejected");
+    TEST_ASSERT_EQUAL_FLOAT(0.8f, config_get().alpha);
+
+    // Truncated and foreign messages get no reply
+    const uint8_t short_set[] = { WS_MSG_SET_PARAM, WS_PARAM_ALPHA, 1, 0, 0 };
+    const uint8_t hello[]     = { WS_MSG_HELLO, WS_FORMAT_V2, WS_QUANT_I16 };
+    sock.client_send(short_set, sizeof(short_set));
+    sock.client_send(hello, sizeof(hello));
+    sock.device_poll(0, live);
+    TEST_ASSERT_TRUE(sock.to_client.empty());
+}
+
+// Nothing reaches flash while the slider moves; one write after it stops
+static void test_drag_is_one_write() {
+    SystemConfig& cfg = config_get();
+    ws_ack_packet_t ack;
+    ws_status_packet_t st;
+    TEST_ASSERT_TRUE(set(WS_PARAM_NORMAL_FPS, 10, 0, ack));
+    uint32_t before = config_store_stats().writes;
+    for (uint32_t t = 0; t < 2000; t += 20) {
+        set(WS_PARAM_ALPHA, 0.05f + t * 0.0003f, t, ack);
+        config_poll(t);
+    }
+    TEST_ASSERT_EQUAL_MESSAGE(before, config_store_stats().writes, "no flash write during a drag");
+    TEST_ASSERT_TRUE(status(st));
+    TEST_ASSERT_TRUE(st.flags & WS_STATUS_SAVE_PENDING);
+    TEST_ASSERT_EQUAL_FLOAT(cfg.alpha, st.alpha);
+    TEST_ASSERT_EQUAL(10, st.normal_fps);
+    TEST_ASSERT_EQUAL(5, st.current_fps);
+
+    for (uint32_t t = 2000; t < 2000 + CONFIG_SAVE_DELAY_MS + 100; t += 100) config_poll(t);
+    TEST_ASSERT_EQUAL(before + 1, config_store_stats().writes);
+    TEST_ASSERT_TRUE(status(st));
+    TEST_ASSERT_FALSE(st.flags & WS_STATUS_SAVE_PENDING);
+    TEST_ASSERT_EQUAL(config_store_stats().seq, st.config_generation);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_set_param_acks);
+    RUN_TEST(test_rejects);
+    RUN_TEST(test_drag_is_one_write);
+    return UNITY_END();
+}
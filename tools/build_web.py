@@ -0,0 +1,111 @@
+"""Builds the LittleFS web image from data/www.
+
+Every file except index.html gets the first 8 hex digits of its SHA-256 in
+its name (app.js -> app.3f2a9c1d.js) and references to it in the HTML, CSS
+and JS are rewritten. Text files are stored gzipped. manifest.txt lists one
+asset per line for src/web_assets.cpp:
+
+    <name> <etag> <flags> <stored bytes> <original bytes>
+
+flags: g = stored as <name>.gz, i = content-hashed (cache forever).
+
+Runs as a PlatformIO pre: script, only for buildfs / uploadfs (which then
+use the output directory as the data dir), or by hand:
+
+    python3 tools/build_web.py [src_dir] [out_dir]
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import shutil
+import sys
+
+ENTRY = "index.html"                      # fixed name, revalidated each load
+GZIP_EXT = (".html", ".js", ".css", ".json", ".svg", ".txt")
+REWRITE_EXT = (".html", ".js", ".css")
+HASH_LEN = 8
+
+
+def content_hash(data, n):
+    return hashlib.sha256(data).hexdigest()[:n]
+
+
+def hashed_name(name, data):
+    base, ext = os.path.splitext(name)
+    return "%s.%s%s" % (base, content_hash(data, HASH_LEN), ext)
+
+
+def rewrite(text, renames):
+    # Only whole names inside quotes / url(), optionally with a leading "/"
+    for old, new in renames.items():
+        text = re.sub(r"""(["'(]/?)%s(?=["')?#])""" % re.escape(old),
+                      lambda m: m.group(1) + new, text)
+    return text
+
+
+def build(src, out):
+    names = sorted(n for n in os.listdir(src)
+                   if os.path.isfile(os.path.join(src, n)) and not n.startswith("."))
+    files = {}
+    for n in names:
+        with open(os.path.join(src, n), "rb") as f:
+            files[n] = f.read()
+
+    # Leaves first: CSS/JS referenced by others get their final hash before
+    # the files that point at them are rewritten
+    renames = {}
+    for n in sorted(names, key=lambda n: (n == ENTRY, n.endswith(".html"))):
+        data = files[n]
+        if n.endswith(REWRITE_EXT) and renames:
+            data = rewrite(data.decode("utf-8"), renames).encode("utf-8")
+            files[n] = data
+        if n != ENTRY:
+            renames[n] = hashed_name(n, data)
+
+    if os.path.isdir(out):
+        shutil.rmtree(out)
+    os.makedirs(out)
+
+    manifest = []
+    total_raw = total_stored = 0
+    for n in names:
+        data = files[n]
+        name = renames.get(n, n)
+        flags = "i" if n in renames else ""
+        stored, path = data, os.path.join(out, name)
+        if n.endswith(GZIP_EXT):
+            # mtime=0 keeps the output (and its ETag) reproducible
+            stored = gzip.compress(data, compresslevel=9, mtime=0)
+            path += ".gz"
+            flags = "g" + flags
+        with open(path, "wb") as f:
+            f.write(stored)
+        etag = content_hash(stored, 16)
+        manifest.append("%s %s %s %d %d" % (name, etag, flags or "-", len(stored), len(data)))
+        total_raw += len(data)
+        total_stored += len(stored)
+
+    with open(os.path.join(out, "manifest.txt"), "w") as f:
+        f.write("\n".join(manifest) + "\n")
+
+    print("[build_web] %d files, %d -> %d bytes" % (len(names), total_raw, total_stored))
+    for line in manifest:
+        print("[build_web]   " + line)
+
+
+if __name__ == "__main__":
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    build(sys.argv[1] if len(sys.argv) > 1 else os.path.join(root, "data", "www"),
+          sys.argv[2] if len(sys.argv) > 2 else os.path.join(root, ".pio", "webdata", "www"))
+else:
+    Import("env")  # noqa: F821 (PlatformIO / SCons)
+    # Only the filesystem targets use the image; firmware builds and
+    # uploads skip it
+    FS_TARGETS = {"buildfs", "uploadfs", "uploadfsota"}
+    if FS_TARGETS & set(COMMAND_LINE_TARGETS):  # noqa: F821
+        project = env.subst("$PROJECT_DIR")
+        webdata = os.path.join(env.subst("$PROJECT_WORKSPACE_DIR"), "webdata")
+        build(os.path.join(project, "data", "www"), os.path.join(webdata, "www"))
+        env.Replace(PROJECT_DATA_DIR=webdata)
@@ -0,0 +1,128 @@
+"""Receives the camera's UDP frame stream and reports rate and loss.
+
+The device publishes one datagram per frame when udp_enabled is set (see
+src/udp_publisher.h): a 16-byte header followed by one frame record.
+
+    header  <2s magic "TC"> <u8 version> <u8 type> <u32 seq> <u32 sent_ms>
+            <u8 grid_w> <u8 grid_h> <u16 record_size>
+    record  <u32 timestamp_ms> <u16 seq> <u8 fps> <u8 flags>
+            <i16 tmin> <i16 tmax> <i16 tmean> <u8 hotspot_x> <u8 hotspot_y>
+            <i16 pixels[grid_w * grid_h]>      (centi-degrees)
+
+Gaps in the header seq are counted as lost; a datagram older than the newest
+one is counted as late (it was already counted as lost). Usage:
+
+    python3 tools/udp_receiver.py [--group 239.255.42.42] [--port 5008]
+                                  [--interval 5] [--frames]
+"""
+
+import argparse
+import socket
+import struct
+import time
+
+HEADER = struct.Struct("<2sBBIIBBH")
+RECORD = struct.Struct("<IHBBhhhBB")
+MAGIC = b"TC"
+VERSION = 1
+RESTART_GAP = 1000                        # seq jumping back this far is a reboot
+
+
+def open_socket(group, port):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1 << 20)
+    sock.bind(("", port))
+    first = int(group.split(".")[0])
+    if 224 <= first <= 239:
+        mreq = struct.pack("4s4s", socket.inet_aton(group), socket.inet_aton("0.0.0.0"))
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, mreq)
+    return sock
+
+
+class Stats:
+    def __init__(self):
+        self.received = self.lost = self.late = self.bad = self.bytes = 0
+        self.next_seq = None
+
+    def add(self, seq, size):
+        self.received += 1
+        self.bytes += size
+        if self.next_seq is not None:
+            if seq < self.next_seq:
+                if self.next_seq - seq > RESTART_GAP:   # device rebooted
+                    self.next_seq = seq + 1
+                else:
+                    self.late += 1
+                return
+            self.lost += seq - self.next_seq
+        self.next_seq = seq + 1
+
+    def line(self, elapsed):
+        total = self.received + self.lost
+        loss = 100.0 * self.lost / total if total else 0.0
+        return "%6.1f frames/s  %7.1f kB/s  received %d  lost %d (%.2f%%)  late %d  bad %d" % (
+            self.received / elapsed, self.bytes / elapsed / 1e3,
+            self.received, self.lost, loss, self.late, self.bad)
+
+
+def decode(data):
+    """Returns (header tuple, record tuple, pixels in C) or None if malformed."""
+    if len(data) < HEADER.size:
+        return None
+    magic, version, _type, seq, sent_ms, w, h, record_size = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION or len(data) != HEADER.size + record_size:
+        return None
+    if record_size != RECORD.size + 2 * w * h:
+        return None
+    rec = RECORD.unpack_from(data, HEADER.size)
+    pixels = struct.unpack_from("<%dh" % (w * h), data, HEADER.size + RECORD.size)
+    return (seq, sent_ms, w, h), rec, [p / 100.0 for p in pixels]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--group", default="239.255.42.42", help="multicast group (or any for broadcast)")
+    ap.add_argument("--port", type=int, default=5008)
+    ap.add_argument("--interval", type=float, default=5.0, help="seconds between reports")
+    ap.add_argument("--frames", action="store_true", help="print each frame's statistics")
+    args = ap.parse_args()
+
+    sock = open_socket(args.group, args.port)
+    sock.settimeout(0.5)
+    print("Listening on %s:%d" % (args.group, args.port))
+
+    total, window = Stats(), Stats()
+    start = last = time.monotonic()
+    try:
+        while True:
+            try:
+                data = sock.recv(2048)
+            except socket.timeout:
+                data = None
+            if data is not None:
+                frame = decode(data)
+                if frame is None:
+                    total.bad += 1
+                    window.bad += 1
+                else:
+                    (seq, _sent, w, h), rec, _pixels = frame
+                    total.add(seq, len(data))
+                    window.add(seq, len(data))
+                    if args.frames:
+                        print("seq %u  %dx%d  fps %u  min %.2f  max %.2f  mean %.2f  hotspot (%u,%u)" % (
+                            seq, w, h, rec[2], rec[4] / 100.0, rec[5] / 100.0, rec[6] / 100.0,
+                            rec[7], rec[8]))
+            now = time.monotonic()
+            if now - last >= args.interval:
+                print(window.line(now - last))
+                window = Stats()
+                window.next_seq = total.next_seq
+                last = now
+    except KeyboardInterrupt:
+        pass
+    print("total: " + total.line(max(time.monotonic() - start, 1e-6)))
+
+
+if __name__ == "__main__":
+    main()